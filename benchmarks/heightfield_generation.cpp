@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Utils/HeightField.h"
+
+// Compares the previous terrain synthesis (nested vectors, one shared
+// mt19937, serial 9-tap smoothing) with HeightField (flat buffer, hashed
+// noise, row bands across threads, separable smoothing) for hilly terrain
+// from 256^2 to 8192^2 samples. No GL context needed.
+//
+// Usage: HeightFieldBenchmark [maxLegacyResolution]
+
+namespace {
+    const int RESOLUTIONS[] = {256, 512, 1024, 2048, 4096, 8192};
+
+    // The Landscape synthesis this replaced, as the baseline
+    std::vector<std::vector<float>> LegacyGenerate(int resolution, uint32_t seed) {
+        std::vector<std::vector<float>> heightMap(resolution, std::vector<float>(resolution));
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+
+        for (int z = 0; z < resolution; ++z) {
+            for (int x = 0; x < resolution; ++x) {
+                float largeScale = std::sin(x * 0.1f) * std::cos(z * 0.1f) * 0.5f;
+                float mediumScale = std::sin(x * 0.3f) * std::cos(z * 0.3f) * 0.3f;
+                float smallScale = dis(gen) * 0.2f;
+                heightMap[z][x] = std::max(0.0f, largeScale + mediumScale + smallScale);
+            }
+        }
+
+        std::vector<std::vector<float>> smoothed = heightMap;
+        for (int z = 1; z < resolution - 1; ++z) {
+            for (int x = 1; x < resolution - 1; ++x) {
+                float sum = 0.0f;
+                for (int dz = -1; dz <= 1; ++dz) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        sum += heightMap[z + dz][x + dx];
+                    }
+                }
+                smoothed[z][x] = sum / 9.0f;
+            }
+        }
+        return smoothed;
+    }
+
+    template <typename Fn>
+    double TimeMilliseconds(Fn&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int maxLegacyResolution = argc > 1 ? std::atoi(argv[1]) : 8192;
+
+    std::cout << "Height field generation benchmark (hilly, generate + smooth)" << std::endl;
+    std::cout << std::setw(12) << "resolution" << std::setw(14) << "legacy" << std::setw(14) << "HeightField"
+              << std::setw(10) << "speedup" << std::endl;
+
+    volatile float sink = 0.0f;
+    for (int resolution : RESOLUTIONS) {
+        HeightField field;
+        double current = TimeMilliseconds([&]() {
+            field.Resize(resolution, resolution);
+            field.Generate(HeightField::Shape::HILLS, 1234u);
+            field.Smooth();
+        });
+        sink = sink + field.Get(resolution / 2, resolution / 2);
+
+        std::cout << std::setw(12) << resolution << std::fixed << std::setprecision(1);
+        if (resolution <= maxLegacyResolution) {
+            double legacy = TimeMilliseconds([&]() {
+                std::vector<std::vector<float>> grid = LegacyGenerate(resolution, 1234u);
+                sink = sink + grid[resolution / 2][resolution / 2];
+            });
+            std::cout << std::setw(11) << legacy << " ms" << std::setw(11) << current << " ms" << std::setw(9)
+                      << std::setprecision(2) << legacy / current << "x" << std::endl;
+        } else {
+            std::cout << std::setw(14) << "skipped" << std::setw(11) << current << " ms" << std::setw(10) << "-"
+                      << std::endl;
+        }
+    }
+    return 0;
+}
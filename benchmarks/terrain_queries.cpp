@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Components/Landscape.h"
+
+// Compares per-point Landscape::GetHeightAt / GetTerrainNormal calls (one
+// per post or pile of a panel layout) with the batch GetHeightsAt over the
+// same random positions, and checks that both give the same results. No GL
+// context needed: chunks are never built.
+//
+// Usage: TerrainQueryBenchmark [queryCount] [resolution]
+
+namespace {
+    const int REPEATS = 5;
+
+    template <typename Fn>
+    double BestMilliseconds(Fn&& fn) {
+        double best = 0.0;
+        for (int i = 0; i < REPEATS; ++i) {
+            auto start = std::chrono::high_resolution_clock::now();
+            fn();
+            auto end = std::chrono::high_resolution_clock::now();
+            double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+            best = i == 0 ? elapsed : std::min(best, elapsed);
+        }
+        return best;
+    }
+
+    void PrintRow(const char* name, double milliseconds, double baseline, size_t count) {
+        std::cout << std::setw(24) << name << std::fixed << std::setprecision(2) << std::setw(10) << milliseconds
+                  << " ms" << std::setw(10) << std::setprecision(1) << count / milliseconds / 1000.0 << " M/s"
+                  << std::setw(9) << std::setprecision(2) << baseline / milliseconds << "x" << std::endl;
+    }
+
+    // Returns false if the batch results differ from the single queries
+    bool Run(const Landscape& landscape, const char* label, const std::vector<glm::vec2>& positions) {
+        const size_t count = positions.size();
+        std::vector<float> scalarHeights(count), heights(count);
+        std::vector<glm::vec3> scalarNormals(count), normals(count);
+
+        double scalarHeight = BestMilliseconds([&]() {
+            for (size_t i = 0; i < count; ++i) {
+                scalarHeights[i] = landscape.GetHeightAt(glm::vec3(positions[i].x, 0.0f, positions[i].y));
+            }
+        });
+        double scalarBoth = BestMilliseconds([&]() {
+            for (size_t i = 0; i < count; ++i) {
+                glm::vec3 position(positions[i].x, 0.0f, positions[i].y);
+                scalarHeights[i] = landscape.GetHeightAt(position);
+                scalarNormals[i] = landscape.GetTerrainNormal(position);
+            }
+        });
+        double batchHeight = BestMilliseconds([&]() {
+            landscape.GetHeightsAt(positions.data(), count, heights.data());
+        });
+        double batchBoth = BestMilliseconds([&]() {
+            landscape.GetHeightsAt(positions.data(), count, heights.data(), normals.data());
+        });
+
+        float heightError = 0.0f, normalError = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            heightError = std::max(heightError, std::abs(heights[i] - scalarHeights[i]));
+            normalError = std::max(normalError, glm::length(normals[i] - scalarNormals[i]));
+        }
+
+        std::cout << label << ", " << count << " queries" << std::endl;
+        PrintRow("GetHeightAt", scalarHeight, scalarHeight, count);
+        PrintRow("GetHeightsAt", batchHeight, scalarHeight, count);
+        PrintRow("+ GetTerrainNormal", scalarBoth, scalarBoth, count);
+        PrintRow("GetHeightsAt + normals", batchBoth, scalarBoth, count);
+        std::cout << std::setw(24) << "max difference" << "  height " << heightError << ", normal " << normalError
+                  << std::endl;
+        return heightError == 0.0f && normalError == 0.0f;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 1000000;
+    int resolution = argc > 2 ? std::atoi(argv[2]) : 4097;
+    const glm::vec2 size(4000.0f, 4000.0f);
+
+    // Generated without the on-disk cache, so runs do not leave files behind
+    Landscape landscape(Landscape::TerrainType::HILLY, size, resolution);
+    landscape.SetCacheDirectory("");
+    landscape.GenerateGeometry();
+    std::cout << "Terrain query benchmark on " << resolution << "^2 samples (best of " << REPEATS << ")" << std::endl;
+    std::cout << std::setw(24) << "query" << std::setw(13) << "time" << std::setw(14) << "rate" << std::setw(10)
+              << "speedup" << std::endl;
+
+    // Posts of a panel layout: rows across the site, 2 m apart
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    std::vector<glm::vec2> positions;
+    positions.reserve(count);
+    for (int row = 0; row < side && positions.size() < count; ++row) {
+        for (int post = 0; post < side && positions.size() < count; ++post) {
+            positions.emplace_back(post * 2.0f - side, row * 2.0f - side);
+        }
+    }
+    bool identical = Run(landscape, "Layout", positions);
+
+    // Scattered points, where every query is likely a cache miss
+    std::mt19937 generator(1234u);
+    std::uniform_real_distribution<float> x(-size.x * 0.5f, size.x * 0.5f);
+    std::uniform_real_distribution<float> z(-size.y * 0.5f, size.y * 0.5f);
+    for (glm::vec2& position : positions) {
+        position = glm::vec2(x(generator), z(generator));
+    }
+    identical = Run(landscape, "Scattered", positions) && identical;
+    return identical ? 0 : 1;
+}
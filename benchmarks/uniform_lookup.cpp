@@ -0,0 +1,139 @@
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include "Engine/HeadlessContext.h"
+#include "Engine/Shader.h"
+
+// Compares uniform setters taking a std::string name (temporary built per
+// call, hashed into the per-program cache) with interned UniformId handles
+// (array index). Runs on a headless EGL context.
+//
+// Usage: UniformLookupBenchmark [iterations]
+
+namespace {
+    const char* VERTEX_SOURCE = R"(#version 430 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+void main() {
+    gl_Position = projection * view * model * vec4(aPos * (1.0 + time), 1.0);
+}
+)";
+
+    const char* FRAGMENT_SOURCE = R"(#version 430 core
+out vec4 FragColor;
+uniform vec3 color;
+uniform int mode;
+void main() {
+    FragColor = vec4(mode == 0 ? color : vec3(1.0), 1.0);
+}
+)";
+
+    const UniformId MODEL("model");
+    const UniformId VIEW("view");
+    const UniformId PROJECTION("projection");
+    const UniformId TIME("time");
+    const UniformId COLOR("color");
+    const UniformId MODE("mode");
+
+    template <typename Fn>
+    double TimeNanosecondsPerCall(int iterations, int callsPerIteration, Fn&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            fn(i);
+        }
+        glFinish();
+        auto end = std::chrono::high_resolution_clock::now();
+        double total = std::chrono::duration<double, std::nano>(end - start).count();
+        return total / (static_cast<double>(iterations) * callsPerIteration);
+    }
+
+    void Report(const char* label, double stringNs, double idNs) {
+        std::cout << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << stringNs << " ns" << std::setw(10) << idNs << " ns"
+                  << std::setw(9) << std::setprecision(2) << stringNs / idNs << "x" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    if (iterations <= 0) {
+        std::cerr << "Iterations must be positive" << std::endl;
+        return 1;
+    }
+
+    HeadlessContext context;
+    if (!context.Initialize()) {
+        return 1;
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if (glewStatus == GLEW_ERROR_NO_GLX_DISPLAY) {
+        glewStatus = GLEW_OK;
+    }
+#endif
+    if (glewStatus != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW" << std::endl;
+        return 1;
+    }
+
+    // Measure the lookup itself, not the binary cache
+    ShaderCache::Instance().SetEnabled(false);
+    Shader shader;
+    if (!shader.LoadFromSources(VERTEX_SOURCE, FRAGMENT_SOURCE)) {
+        return 1;
+    }
+    shader.Use();
+
+    std::cout << "Uniform lookup benchmark: " << context.GetDescription() << ", " << glGetString(GL_RENDERER)
+              << ", " << iterations << " iterations" << std::endl;
+    std::cout << std::left << std::setw(22) << "" << std::right << std::setw(13) << "string"
+              << std::setw(13) << "UniformId" << std::setw(10) << "speedup" << std::endl;
+
+    // Location lookup only (no GL call on the cached path)
+    volatile GLint sink = 0;
+    double stringLookup = TimeNanosecondsPerCall(iterations, 6, [&](int) {
+        sink = sink + shader.GetUniformLocation("model") + shader.GetUniformLocation("view") +
+               shader.GetUniformLocation("projection") + shader.GetUniformLocation("time") +
+               shader.GetUniformLocation("color") + shader.GetUniformLocation("mode");
+    });
+    double idLookup = TimeNanosecondsPerCall(iterations, 6, [&](int) {
+        sink = sink + shader.GetUniformLocation(MODEL) + shader.GetUniformLocation(VIEW) +
+               shader.GetUniformLocation(PROJECTION) + shader.GetUniformLocation(TIME) +
+               shader.GetUniformLocation(COLOR) + shader.GetUniformLocation(MODE);
+    });
+    Report("Location lookup", stringLookup, idLookup);
+
+    // Full setters as a per-draw call site would issue them
+    glm::mat4 matrix(1.0f);
+    glm::vec3 color(0.5f);
+    double stringSet = TimeNanosecondsPerCall(iterations, 6, [&](int i) {
+        shader.SetMat4("model", matrix);
+        shader.SetMat4("view", matrix);
+        shader.SetMat4("projection", matrix);
+        shader.SetFloat("time", static_cast<float>(i));
+        shader.SetVec3("color", color);
+        shader.SetInt("mode", i & 1);
+    });
+    double idSet = TimeNanosecondsPerCall(iterations, 6, [&](int i) {
+        shader.SetMat4(MODEL, matrix);
+        shader.SetMat4(VIEW, matrix);
+        shader.SetMat4(PROJECTION, matrix);
+        shader.SetFloat(TIME, static_cast<float>(i));
+        shader.SetVec3(COLOR, color);
+        shader.SetInt(MODE, i & 1);
+    });
+    Report("Set uniform", stringSet, idSet);
+
+    shader.Unuse();
+    return 0;
+}
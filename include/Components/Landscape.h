@@ -3,14 +3,39 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "../Engine/Material.h"
 #include "../Engine/Model.h"
 #include "../Engine/Texture.h"
-
+#include "../Utils/HeightField.h"
+#include "../Utils/HeightFieldFile.h"
+#include "../Utils/TerrainPyramid.h"
+
+class Scene;
+class TerrainTileCache;
+
+// Terrain is drawn as a quadtree of fixed-size patches (chunked LOD with
+// geomipmapping): every node is a PATCH_SIZE x PATCH_SIZE quad grid that
+// samples the height map at a stride of 2^level, so a node covers
+// PATCH_SIZE << level samples. Nodes are split by distance to the camera,
+// which keeps the triangle count roughly constant however large the height
+// map is. Neighbours of different levels are stitched with skirts. Each
+// chunk is a separate static model, culled on its own and drawn through the
+// renderer's geometry arena.
+//
+// The height map is either held in memory or streamed: OpenTiles switches
+// to an on-disk tile pyramid whose tiles are the quadtree nodes, read by
+// background threads as the camera approaches and evicted under a memory
+// budget.
 class Landscape {
 public:
+    static constexpr int PATCH_SIZE = TerrainPyramid::PATCH_SIZE;
+    static constexpr uint32_t DEFAULT_SEED = 1;
     enum class TerrainType {
         FLAT,
         HILLY,
@@ -19,8 +44,12 @@ public:
         URBAN
     };
 
+    // Nothing is generated here, so the seed and cache directory can be set
+    // first: call GenerateGeometry, LoadHeightMap or OpenTiles (UpdateChunks
+    // generates on first use otherwise). Until then heights read as the
+    // height offset.
     Landscape();
-    Landscape(TerrainType type, const glm::vec2& size, int resolution);
+    Landscape(TerrainType type, const glm::vec2& size, int resolution, uint32_t seed = DEFAULT_SEED);
     ~Landscape();
 
     // Terrain properties
@@ -29,13 +58,51 @@ public:
     void SetResolution(int resolution);
     void SetHeightScale(float scale);
     void SetHeightOffset(float offset);
+    // Generation is deterministic: the same type, seed and resolution always
+    // give the same terrain
+    void SetSeed(uint32_t seed);
+    // Generated terrain is cached here as .hfld files keyed by type, seed and
+    // resolution, and memory-mapped on the next run. Defaults to
+    // "terrain_cache"; an empty path disables the cache.
+    void SetCacheDirectory(const std::string& directory);
 
     // Height map
-    void LoadHeightMap(const std::string& filePath);
+    // Loads a .hfld height field, taking its resolution, size and height
+    // scale, or the first channel of a square image
+    bool LoadHeightMap(const std::string& filePath);
+    bool SaveHeightMap(const std::string& filePath,
+                       HeightFieldFile::SampleFormat format = HeightFieldFile::SampleFormat::FLOAT32) const;
     void GenerateHeightMap();
+
+    // Out-of-core terrain from a tile pyramid (Utils/TerrainPyramid.h);
+    // resolution, size and height scale come from the file. Only the header,
+    // the node bounds and the root tile are read here, so opening costs the
+    // same for any dataset size. Heights are sampled from the finest
+    // resident tile until the finer ones arrive.
+    bool OpenTiles(const std::string& filePath);
+    // Writes the in-memory height map as a pyramid for OpenTiles
+    bool SaveTiles(const std::string& filePath) const;
+    void SetTileMemoryBudget(size_t bytes);
+    bool IsStreaming() const { return tileCache != nullptr; }
+    // Blocks until requested tiles have been read (headless runs)
+    void WaitForTiles();
+    // Edits only mark the samples they touch: the next UpdateChunks refits
+    // the cached chunks over them in place, uploading just the vertex rows
+    // that changed, so chunk models keep their identity in the scene. Height
+    // scale, offset and size changes refit every cached chunk the same way.
+    // Ignored while streaming.
     void SetHeightAt(int x, int z, float height);
+    // Grading: levels the extent (world units) centred on center to center.y
+    // and eases back into the existing ground over blend units around it
+    void FlattenRegion(const glm::vec3& center, const glm::vec2& extent, float blend = 0.0f);
     float GetHeightAt(int x, int z) const;
     float GetHeightAt(const glm::vec3& position) const;
+    // Batch form of GetHeightAt / GetTerrainNormal for layouts with many
+    // posts: count XZ world positions in, count heights and (optionally)
+    // unit normals out, identical to the single queries. Positions are
+    // interpolated in blocks so the arithmetic vectorises, and large batches
+    // are split across threads. Streamed terrain is sampled one by one.
+    void GetHeightsAt(const glm::vec2* positions, size_t count, float* heights, glm::vec3* normals = nullptr) const;
 
     // Texturing
     void SetBaseTexture(const std::string& texturePath);
@@ -56,13 +123,25 @@ public:
     // Rendering
     void GenerateGeometry();
     void Render(const glm::mat4& viewProjection);
-    std::shared_ptr<Model> GetModel() const { return model; }
+
+    // Chunked LOD: selects the quadtree nodes for this camera and adds or
+    // removes their chunk models in the scene. Call once per frame. Chunk
+    // builds are budgeted per call; returns false while refinement is still
+    // held back by the budget.
+    bool UpdateChunks(const glm::vec3& cameraPosition, Scene& scene);
+    // Removes every chunk this landscape added to the scene
+    void RemoveChunks(Scene& scene);
+    // A node is split while the camera is closer than factor x its size
+    void SetLODDistance(float factor);
+    int GetChunkCount() const { return static_cast<int>(selectedChunks.size()); }
+    size_t GetTriangleCount() const;
 
     // Getters
     TerrainType GetType() const { return type; }
     glm::vec2 GetSize() const { return size; }
     int GetResolution() const { return resolution; }
     float GetHeightScale() const { return heightScale; }
+    uint32_t GetSeed() const { return seed; }
     glm::mat4 GetTransform() const;
 
     // Collision
@@ -75,11 +154,40 @@ private:
     int resolution;
     float heightScale;
     float heightOffset;
+    uint32_t seed;
+    std::string cacheDirectory;
+    Material material;
 
-    // Height data
-    std::vector<float> heightMap;
+    // Height data, resolution x resolution: unscaled heights and world-space
+    // normals. Both are empty while streaming.
+    HeightField heightField;
     std::vector<glm::vec3> normals;
 
+    // Streaming
+    std::shared_ptr<TerrainPyramid> tilePyramid;
+    std::unique_ptr<TerrainTileCache> tileCache;
+    size_t tileMemoryBudget;
+
+    // Quadtree chunks, keyed by (level, x, z)
+    struct Chunk {
+        std::shared_ptr<Model> model;
+        uint64_t lastUsed;
+        bool inScene;
+    };
+    std::unordered_map<uint64_t, Chunk> chunks;
+    std::vector<uint64_t> selectedChunks;
+    // Unscaled (min, max) height per node, one grid per level
+    std::vector<std::vector<glm::vec2>> nodeBounds;
+    int rootLevel;
+    float lodDistance;
+    uint64_t updateCount;
+    bool chunksDirty;
+    bool refinementDeferred;
+    // Samples edited since the last UpdateChunks, inclusive; empty when
+    // dirtyMin.x > dirtyMax.x
+    glm::ivec2 dirtyMin;
+    glm::ivec2 dirtyMax;
+
     // Textures
     std::shared_ptr<Texture> baseTexture;
     std::shared_ptr<Texture> detailTexture;
@@ -107,12 +215,36 @@ private:
     };
     std::vector<Water> waterBodies;
 
-    std::shared_ptr<Model> model;
-
-    void GenerateTerrainGeometry();
     void GenerateVegetationGeometry();
     void GenerateWaterGeometry();
     void CalculateNormals();
+    glm::vec3 CalculateNormal(int x, int z) const;
     void ApplyTextures();
+    void SetupMaterial();
     glm::vec3 InterpolateHeight(const glm::vec3& position) const;
+    std::string GetCachePath() const;
+    uint64_t GetSourceKey() const;
+    bool LoadCache(const std::string& cachePath);
+
+    // Chunked LOD
+    static uint64_t GetChunkKey(int level, int x, int z);
+    void BuildNodeBounds();
+    void SelectNodes(int level, int x, int z, const glm::vec3& cameraPosition, int& buildBudget);
+    bool ShouldSplit(int level, int x, int z, const glm::vec3& cameraPosition, float distanceScale = 1.0f) const;
+    bool IsNodeInside(int level, int x, int z) const;
+    Chunk& AcquireChunk(int level, int x, int z);
+    std::shared_ptr<Model> BuildChunk(int level, int x, int z) const;
+    // Chunk vertices from the node's tile: grid rows [firstRow, lastRow], and
+    // the skirts, which read the border rows and the node bounds
+    void WriteChunkRows(int level, int x, int z, const float* tile, int firstRow, int lastRow, Vertex* vertices) const;
+    void WriteChunkSkirts(int level, int x, int z, Vertex* vertices) const;
+    void MarkDirty(const glm::ivec2& first, const glm::ivec2& last);
+    void ClearDirty();
+    // Updates the node bounds and the cached chunks over the dirty samples
+    void RefitChunks(Scene& scene);
+    glm::vec2 GetCellSize() const;
+    void CloseTiles();
+    // Bilinear height (unscaled) at fractional sample coordinates from the
+    // finest resident tile; requests the finest tile when it is missing
+    float SampleTiles(float gx, float gz, glm::vec3* normal) const;
 };
@@ -36,13 +36,24 @@ public:
     void SetTemperature(float temperature);
     void SetDirtLevel(float dirtLevel);
 
-    // Array management
+    // Array management. An array shares one panel mesh and is drawn with a
+    // single instanced call; per-panel state is indexed by row * cols + col.
     void CreateArray(int rows, int cols, float spacing);
+    int GetPanelCount() const { return static_cast<int>(instances.size()); }
+    void SetPanelState(int index, float efficiency, float temperature, float dirtLevel);
+    void SetPanelSelected(int index, bool selected);
+    // Overrides one panel's array-space transform until the next tilt,
+    // azimuth or layout change; only that panel's matrix is re-uploaded.
+    void SetPanelTransform(int index, const glm::mat4& transform);
+    glm::vec4 GetPanelState(int index) const;
     void SetArraySpacing(float spacing);
     void SetArrayOrientation(const glm::vec3& direction);
 
-    // Energy simulation
+    // Energy simulation. Time of day (0-1, 0.5 = solar noon) is driven by the
+    // caller's simulation clock rather than wall time.
     void Update(float deltaTime);
+    void SetTimeOfDay(float timeOfDay);
+    float GetTimeOfDay() const { return timeOfDay; }
     void UpdateEnergyOutput(float timeOfDay, float solarIntensity, float temperature);
     float GetCurrentPower() const { return currentPowerOutput; }
     float GetCurrentPowerOutput() const { return currentPowerOutput; }
@@ -82,6 +93,7 @@ private:
     float powerOutput;
     float temperature;
     float dirtLevel;
+    float timeOfDay;
     float currentPowerOutput;
     float dailyEnergyOutput;
 
@@ -92,11 +104,20 @@ private:
     glm::vec3 arrayDirection;
 
     std::shared_ptr<Model> model;
-    std::vector<glm::mat4> panelTransforms;
+    
+    // Instancing: transform + (efficiency, temperature, dirt, selected) per panel.
+    // Only the dirty index range is re-uploaded.
+    std::vector<InstanceData> instances;
+    GLuint instanceVBO;
+    size_t instanceDirtyBegin;
+    size_t instanceDirtyEnd;
 
     void GeneratePanelGeometry();
     void GenerateArrayGeometry();
     void CalculatePanelTransforms();
+    void UpdateInstanceBounds();
+    void MarkInstanceDirty(size_t begin, size_t end);
+    void UploadInstanceData();
     void UpdateEfficiency();
     float CalculateSolarAngle(float timeOfDay);
 };
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Precomputed atmospheric scattering for an observer near the ground
+// (Rayleigh, Mie and ozone; single scattering). Two lookup tables are built
+// once on a worker thread, or read back from a disk cache:
+//
+//   transmittance  T(height, cos zenith) to the top of the atmosphere
+//   sky            sky radiance over (relative sun azimuth, view elevation,
+//                  sun elevation), for a sun of unit illuminance
+//
+// The sky LUT covers every sun elevation, so a new time of day only changes
+// the sun direction the sky shader looks up with; nothing is regenerated.
+class Atmosphere {
+public:
+    static constexpr int TRANSMITTANCE_WIDTH = 256;   // cos zenith
+    static constexpr int TRANSMITTANCE_HEIGHT = 64;   // height
+    static constexpr int SKY_WIDTH = 32;   // Relative azimuth, 0..pi
+    static constexpr int SKY_HEIGHT = 64;   // View elevation, denser at the horizon
+    static constexpr int SKY_DEPTH = 32;   // Sun elevation
+    // Sun elevations below this are night (radians)
+    static constexpr float MIN_SUN_ELEVATION = -0.35f;
+
+    static Atmosphere& Instance();
+
+    // Defaults to "sky_cache/atmosphere.bin"; an empty path disables the cache
+    void SetCachePath(const std::string& path);
+
+    // Starts building (or loading) the tables on a worker thread; no GL calls
+    void Prepare();
+    // Blocks until the tables are built (headless runs)
+    void Wait();
+    // GL thread: uploads the tables once they are built. True when the
+    // textures can be sampled.
+    bool Upload();
+    GLuint GetTransmittanceTexture() const { return transmittanceTexture; }
+    GLuint GetSkyTexture() const { return skyTexture; }
+
+    // Deletes the textures; the context must still be current
+    void Shutdown();
+
+private:
+    Atmosphere();
+    ~Atmosphere();
+    Atmosphere(const Atmosphere&) = delete;
+    Atmosphere& operator=(const Atmosphere&) = delete;
+
+    void Build();
+    void ComputeTransmittance();
+    void ComputeSky();
+    // Bilinear lookup into the transmittance table; 0 below the horizon
+    void SampleTransmittance(float height, float cosZenith, float result[3]) const;
+    bool LoadCache();
+    void StoreCache() const;
+    static uint64_t GetCacheKey();
+
+    std::string cachePath;
+    std::thread worker;
+    std::mutex workerMutex;
+    std::atomic<bool> built;
+
+    // RGB float, x fastest
+    std::vector<float> transmittance;
+    std::vector<float> sky;
+
+    GLuint transmittanceTexture;
+    GLuint skyTexture;
+};
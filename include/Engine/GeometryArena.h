@@ -0,0 +1,79 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <memory>
+#include <vector>
+
+struct Vertex;
+
+// Suballocates vertices and indices of static meshes out of a few large
+// buffers so they can share one VAO and be drawn with a single
+// glMultiDrawElementsIndirect per page.
+//
+// Each page also carries a per-instance draw ID attribute (location 8,
+// 0..MAX_DRAWS-1). Indirect commands set baseInstance to their draw index,
+// so the shader receives the index of its per-draw data without needing
+// gl_BaseInstance (GL 4.6).
+class GeometryArena {
+public:
+    static constexpr GLuint DRAW_ID_LOCATION = 8;
+    static constexpr GLuint MAX_DRAWS = 65536;
+
+    struct Allocation {
+        int page;
+        GLuint baseVertex;
+        GLuint vertexCount;
+        GLuint firstIndex;
+        GLuint indexCount;
+
+        Allocation() : page(-1), baseVertex(0), vertexCount(0), firstIndex(0), indexCount(0) {}
+        bool IsValid() const { return page >= 0; }
+    };
+
+    GeometryArena(GLuint verticesPerPage = 1 << 20, GLuint indicesPerPage = 3 << 20);
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    // Returns an invalid allocation if the mesh is larger than a page
+    Allocation Allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    void Free(const Allocation& allocation);
+    // Overwrites count of an allocation's vertices, starting at firstVertex
+    void Update(const Allocation& allocation, GLuint firstVertex, GLuint count, const Vertex* vertices);
+
+    void BindPage(int page) const;
+    GLuint GetPageVAO(int page) const { return pages[page]->vao; }
+    int GetPageCount() const { return static_cast<int>(pages.size()); }
+    size_t GetUsedBytes() const { return usedBytes; }
+
+private:
+    // First-fit free list over one buffer, in elements
+    struct FreeList {
+        struct Range {
+            GLuint offset;
+            GLuint count;
+        };
+        std::vector<Range> ranges;
+
+        bool Allocate(GLuint count, GLuint& offset);
+        void Free(GLuint offset, GLuint count);
+    };
+
+    struct Page {
+        GLuint vao;
+        GLuint vbo;
+        GLuint ebo;
+        FreeList freeVertices;
+        FreeList freeIndices;
+    };
+
+    GLuint verticesPerPage;
+    GLuint indicesPerPage;
+    GLuint drawIdBuffer;
+    std::vector<std::unique_ptr<Page>> pages;
+    size_t usedBytes;
+
+    Page& CreatePage();
+    void DeletePage(Page& page);
+};
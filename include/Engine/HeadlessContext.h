@@ -0,0 +1,30 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <string>
+
+// OpenGL 4.3 core context without a window system, for rendering on
+// display-less machines (e.g. Mesa llvmpipe). Prefers a surfaceless context
+// and falls back to a 1x1 pbuffer; all rendering goes to FBOs either way.
+class HeadlessContext {
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    bool Initialize();
+    void Destroy();
+
+    bool IsValid() const { return context != EGL_NO_CONTEXT; }
+    std::string GetDescription() const { return description; }
+
+private:
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;
+    std::string description;
+
+    EGLDisplay OpenDisplay();
+};
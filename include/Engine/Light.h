@@ -6,6 +6,16 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <memory>
 
+// std140 mirror of LightData in shaders/fragment/main.frag (LightBlock).
+// Five vec4s per light, so the array stride is 80 bytes with no padding.
+struct GPULight {
+    glm::vec4 positionType;     // xyz = position, w = type
+    glm::vec4 direction;        // xyz = direction, w unused
+    glm::vec4 colorIntensity;   // rgb = color, a = intensity
+    glm::vec4 attenuation;      // x = constant, y = linear, z = quadratic, w unused
+    glm::vec4 spot;             // x = cos(cutOff), y = cos(outerCutOff), zw unused
+};
+
 class Light {
 public:
     enum class LightType {
@@ -22,6 +32,8 @@ public:
     void SetDirection(const glm::vec3& direction);
     void SetColor(const glm::vec3& color);
     void SetIntensity(float intensity);
+    // Phong factors; the PBR shaders do not read them, so they are not
+    // part of GPULight and changing them triggers no upload
     void SetAmbient(float ambient);
     void SetDiffuse(float diffuse);
     void SetSpecular(float specular);
@@ -51,6 +63,11 @@ public:
     float GetSpecular() const { return specular; }
     bool IsShadowEnabled() const { return shadowsEnabled; }
 
+    // GPU light table
+    void WriteGPUData(GPULight& data) const;
+    bool IsDirty() const { return dirty; }
+    void ClearDirty() { dirty = false; }
+
     // Update
     void Update();
     
@@ -87,6 +104,10 @@ private:
     float shadowNearPlane;
     float shadowFarPlane;
 
+    // Set by every setter of a GPULight field; the renderer re-uploads this
+    // light's entry and clears the flag
+    bool dirty;
+
     void SetupShadowMap();
     void UpdateShadowMap();
 };
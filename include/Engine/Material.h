@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <memory>
+
+#include "Texture.h"
+
+struct Material {
+    glm::vec3 albedo;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float shininess;
+    float metallic;
+    float roughness;
+    float ao;
+    float opacity;
+    
+    // Shader variant selection (see Renderer::SelectVariant)
+    bool unlit;
+    bool receiveShadows;
+    
+    std::shared_ptr<Texture> diffuseMap;
+    std::shared_ptr<Texture> normalMap;
+    std::shared_ptr<Texture> specularMap;
+    std::shared_ptr<Texture> roughnessMap;
+    std::shared_ptr<Texture> metallicMap;
+    std::shared_ptr<Texture> aoMap;
+    
+    // Maps the main shader samples, indexed by texture unit: albedo
+    // (diffuseMap), normal, metallic, roughness, ao
+    static constexpr int TEXTURE_UNIT_COUNT = 5;
+    const Texture* GetTextureForUnit(int unit) const {
+        switch (unit) {
+            case 0: return diffuseMap.get();
+            case 1: return normalMap.get();
+            case 2: return metallicMap.get();
+            case 3: return roughnessMap.get();
+            case 4: return aoMap.get();
+            default: return nullptr;
+        }
+    }
+    bool HasTextures() const {
+        for (int unit = 0; unit < TEXTURE_UNIT_COUNT; ++unit) {
+            if (GetTextureForUnit(unit)) return true;
+        }
+        return false;
+    }
+    
+    Material() : albedo(0.7f), ambient(0.1f), diffuse(0.7f), specular(0.5f), 
+                 shininess(32.0f), metallic(0.0f), roughness(0.5f), ao(1.0f), opacity(1.0f),
+                 unlit(false), receiveShadows(true) {}
+};
@@ -5,6 +5,8 @@
 #include <vector>
 #include <memory>
 
+#include "GeometryArena.h"
+
 struct Vertex {
     glm::vec3 position;
     glm::vec3 normal;
@@ -19,6 +21,14 @@ struct Vertex {
         : position(pos), normal(norm), texCoords(tex), tangent(0.0f), bitangent(0.0f) {}
 };
 
+// Per-instance vertex data consumed by Mesh::DrawInstanced (attribute locations 3-7).
+// The meaning of state is up to the component, e.g. SolarPanel stores
+// efficiency, temperature, dirt level and selection.
+struct InstanceData {
+    glm::mat4 transform;
+    glm::vec4 state;
+};
+
 class Mesh {
 public:
     Mesh();
@@ -34,14 +44,28 @@ public:
 
     // Rendering
     void Render();
-    void RenderInstanced(int instanceCount);
+    void DrawInstanced(unsigned int instanceCount) const;
+    // Assumes Bind() was called. drawId selects the DrawBlock entry: through
+    // the base instance for arena meshes, the generic attribute otherwise.
+    void DrawBound(GLuint drawId, unsigned int instanceCount = 0) const;
     void RenderWireframe();
     
     // Buffer management
     void UpdateVertexBuffer();
+    // Replaces vertices [first, first + count) and uploads only that range,
+    // in the mesh's own buffer or its arena page; refits the bounding box.
+    // Models using the mesh need Model::InvalidateBounds afterwards.
+    void UpdateVertexBuffer(size_t first, size_t count, const Vertex* data);
     void UpdateIndexBuffer();
-    void Bind();
-    void Unbind();
+    void SetInstanceBuffer(GLuint instanceBuffer);
+    void Bind() const;
+    void Unbind() const;
+    
+    // Static meshes can move their geometry into a shared arena page; the
+    // mesh's own VAO/VBO/EBO are released and it is drawn by the indirect path
+    bool MoveToArena(GeometryArena& arena);
+    bool IsInArena() const { return arenaAllocation.IsValid(); }
+    const GeometryArena::Allocation& GetArenaAllocation() const { return arenaAllocation; }
 
     // Getters
     const std::vector<Vertex>& GetVertices() const { return vertices; }
@@ -49,6 +73,9 @@ public:
     unsigned int GetVertexCount() const { return vertices.size(); }
     unsigned int GetIndexCount() const { return indices.size(); }
     GLuint GetVAO() const { return VAO; }
+    // The VAO Bind() actually binds: the arena page's for arena meshes,
+    // whose own VAO is released. Never 0.
+    GLuint GetBindKey() const;
     GLuint GetVBO() const { return VBO; }
     GLuint GetEBO() const { return EBO; }
 
@@ -71,6 +98,10 @@ private:
     GLuint VAO, VBO, EBO;
     bool buffersInitialized;
     
+    // Shared arena storage (see MoveToArena)
+    GeometryArena* arena;
+    GeometryArena::Allocation arenaAllocation;
+    
     // Bounding box
     glm::vec3 boundingBoxMin;
     glm::vec3 boundingBoxMax;
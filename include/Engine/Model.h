@@ -9,28 +9,9 @@
 #include <string>
 
 #include "Mesh.h"
+#include "Material.h"
 #include "Texture.h"
 
-struct Material {
-    glm::vec3 ambient;
-    glm::vec3 diffuse;
-    glm::vec3 specular;
-    float shininess;
-    float metallic;
-    float roughness;
-    float opacity;
-    
-    std::shared_ptr<Texture> diffuseMap;
-    std::shared_ptr<Texture> normalMap;
-    std::shared_ptr<Texture> specularMap;
-    std::shared_ptr<Texture> roughnessMap;
-    std::shared_ptr<Texture> metallicMap;
-    std::shared_ptr<Texture> aoMap;
-    
-    Material() : ambient(0.1f), diffuse(0.7f), specular(0.5f), 
-                 shininess(32.0f), metallic(0.0f), roughness(0.5f), opacity(1.0f) {}
-};
-
 class Model {
 public:
     Model();
@@ -66,16 +47,33 @@ public:
     glm::mat4 GetTransform() const;
     glm::mat4 GetModelMatrix() const;
     
-    // Bounding box
-    glm::vec3 GetBoundingBoxMin() const { return boundingBoxMin; }
-    glm::vec3 GetBoundingBoxMax() const { return boundingBoxMax; }
-    float GetBoundingRadius() const { return boundingRadius; }
+    // World-space bounds, cached and only recomputed after the transform or mesh list changes
+    glm::vec3 GetBoundingBoxMin() const;
+    glm::vec3 GetBoundingBoxMax() const;
+    glm::vec3 GetBoundingSphereCenter() const;
+    float GetBoundingSphereRadius() const;
+    // Call after a mesh's vertices were edited in place
+    void InvalidateBounds() { boundsDirty = true; }
     
     // Model properties
     const std::vector<std::shared_ptr<Mesh>>& GetMeshes() const { return meshes; }
+    const Material& GetMaterial() const;
     const std::vector<Material>& GetMaterials() const { return materials; }
     bool IsVisible() const { return visible; }
     void SetVisible(bool visible) { this->visible = visible; }
+    
+    // Static models do not move, and their geometry changes only through
+    // in-place edits reported with Scene::MarkStaticGeometryChanged (which
+    // rebuilds caches such as the static shadow layer). The renderer packs
+    // them into its geometry arena and draws them indirectly.
+    void SetStatic(bool isStatic) { this->isStatic = isStatic; }
+    bool IsStatic() const { return isStatic; }
+
+    // Instancing: meshes are drawn instanceCount times using per-instance data
+    // already attached to their VAOs (see Mesh::SetInstanceBuffer)
+    void SetInstanceCount(unsigned int count) { instanceCount = count; }
+    unsigned int GetInstanceCount() const { return instanceCount; }
+    void SetInstanceBounds(const glm::vec3& localMin, const glm::vec3& localMax);
 
     // LOD support
     void SetLODLevel(int level);
@@ -84,6 +82,7 @@ public:
 
 private:
     std::vector<std::shared_ptr<Mesh>> meshes;
+    Material material;
     std::vector<Material> materials;
     
     // Transform
@@ -93,10 +92,18 @@ private:
     glm::mat4 transform;
     bool transformDirty;
     
-    // Bounding box
-    glm::vec3 boundingBoxMin;
-    glm::vec3 boundingBoxMax;
-    float boundingRadius;
+    // World-space bounds cache, filled lazily by UpdateBounds()
+    mutable glm::vec3 boundingBoxMin;
+    mutable glm::vec3 boundingBoxMax;
+    mutable glm::vec3 boundingSphereCenter;
+    mutable float boundingRadius;
+    mutable bool boundsDirty;
+    
+    // Instancing
+    unsigned int instanceCount;
+    bool hasInstanceBounds;
+    glm::vec3 instanceBoundsMin;
+    glm::vec3 instanceBoundsMax;
     
     // Animation
     float animationSpeed;
@@ -114,8 +121,9 @@ private:
     
     // Visibility
     bool visible;
+    bool isStatic;
     
-    void CalculateBoundingBox();
+    void UpdateBounds() const;
     void UpdateTransform();
     void LoadMaterials(const std::string& filePath);
 };
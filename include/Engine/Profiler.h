@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Engine/TraceRecorder.h"
+#include <GL/glew.h>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Frame profiler: scoped CPU timers, GL_TIME_ELAPSED query rings for GPU
+// passes, named counters and rolling min/avg/p99 statistics. Scoped timers
+// also emit TraceRecorder zones, so profiled sections show up in captures.
+//
+// GPU results are read back QUERY_RING_SIZE - 1 frames late and only once
+// available, so timing never stalls the pipeline. GL_TIME_ELAPSED queries
+// cannot nest, so GPU sections must be sequential (one per pass). Section
+// names must be string literals: sections are looked up by pointer.
+class Profiler {
+public:
+    static constexpr int QUERY_RING_SIZE = 4;
+    static constexpr int HISTORY_SIZE = 240;
+
+    struct Stats {
+        float minMs;
+        float avgMs;
+        float p99Ms;
+    };
+
+    struct SectionReport {
+        std::string name;
+        Stats cpu;
+        Stats gpu;
+        bool hasGpu;
+    };
+
+    struct FrameReport {
+        Stats frame;
+        float fps;
+        std::vector<SectionReport> sections;
+        std::vector<std::pair<std::string, long long>> counters;
+    };
+
+    static Profiler& Instance();
+
+    void SetEnabled(bool enabled) { this->enabled = enabled; }
+    bool IsEnabled() const { return enabled; }
+
+    void BeginFrame();
+    void EndFrame();
+
+    // Prefer ScopedCpuTimer / ScopedGpuTimer (PROFILE_CPU / PROFILE_GPU)
+    int BeginCpu(const char* name);
+    void EndCpu(int section);
+    int BeginGpu(const char* name);
+    void EndGpu(int section);
+
+    void SetCounter(const char* name, long long value);
+
+    FrameReport GetReport() const;
+    std::string FormatReport() const;
+
+    // Releases GL query objects; call before the context is destroyed
+    void Shutdown();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Fixed-size ring of samples in milliseconds
+    struct History {
+        float samples[HISTORY_SIZE];
+        int count;
+        int next;
+
+        History() : count(0), next(0) {}
+        void Add(float ms);
+        Stats Compute() const;
+    };
+
+    struct Section {
+        std::string name;
+        Clock::time_point cpuStart;
+        float cpuFrameMs;   // Accumulated this frame (a section may run several times)
+        History cpu;
+
+        GLuint queries[QUERY_RING_SIZE];
+        bool queryPending[QUERY_RING_SIZE];
+        bool gpuUsedThisFrame;
+        bool hasGpu;
+        History gpu;
+    };
+
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    int FindOrCreateSection(const char* name);
+    void CollectGpuResults();
+
+    bool enabled;
+    bool inFrame;
+    unsigned long long frameIndex;
+    Clock::time_point frameStart;
+    History frameTimes;
+    std::vector<Section> sections;
+    // Looked up by pointer on every timer; the name map only merges equal
+    // literals that the linker did not pool, once per pointer
+    std::unordered_map<const char*, int> sectionByPointer;
+    std::unordered_map<std::string, int> sectionIndex;
+    std::vector<std::pair<std::string, long long>> counters;
+};
+
+class ScopedCpuTimer {
+public:
+    explicit ScopedCpuTimer(const char* name) : zone(name), section(Profiler::Instance().BeginCpu(name)) {}
+    ~ScopedCpuTimer() { Profiler::Instance().EndCpu(section); }
+
+private:
+    TraceZone zone;
+    int section;
+};
+
+// Times both the CPU submission and the GPU execution of a pass
+class ScopedGpuTimer {
+public:
+    explicit ScopedGpuTimer(const char* name)
+        : zone(name), cpuSection(Profiler::Instance().BeginCpu(name)), gpuSection(Profiler::Instance().BeginGpu(name)) {}
+    ~ScopedGpuTimer() {
+        Profiler::Instance().EndGpu(gpuSection);
+        Profiler::Instance().EndCpu(cpuSection);
+    }
+
+private:
+    TraceZone zone;
+    int cpuSection;
+    int gpuSection;
+};
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+#define PROFILE_CPU(name) ScopedCpuTimer PROFILER_CONCAT(cpuTimer_, __LINE__)(name)
+#define PROFILE_GPU(name) ScopedGpuTimer PROFILER_CONCAT(gpuTimer_, __LINE__)(name)
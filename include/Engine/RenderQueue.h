@@ -0,0 +1,118 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "Material.h"
+
+class Shader;
+class Model;
+class Mesh;
+class UniformRing;
+
+// Per-draw data (std430), indexed by the draw ID; mirrors DrawData in the shaders
+struct GPUDrawData {
+    glm::mat4 model;
+    glm::vec4 albedoMetallic;   // rgb = albedo, a = metallic
+    glm::vec4 roughnessAo;      // x = roughness, y = ao
+};
+
+// Collects the draws of one pass as 64-bit sort keys and submits them in key
+// order, so draws sharing a program or VAO run back to back and the redundant
+// binds between them can be skipped. Materials live in the per-draw data, but
+// stay grouped in the key for texture binds.
+//
+// Key layout (most significant first):
+//   pass (4) | shader (8) | material (16) | mesh (16) | depth (20)
+class RenderQueue {
+public:
+    // Shader storage binding of the DrawBlock array
+    static constexpr GLuint DRAW_DATA_BINDING = 1;
+
+    enum class Pass : uint8_t {
+        SHADOW = 0,
+        MAIN = 1
+    };
+
+    struct DrawItem {
+        uint64_t key;
+        const Model* model;
+        const Mesh* mesh;
+    };
+
+    struct Stats {
+        int items;
+        int programBinds;
+        int programBindsSkipped;
+        int vaoBinds;
+        int vaoBindsSkipped;
+        int materialBinds;
+        int materialBindsSkipped;
+    };
+
+    // Called once after a program is bound, before its first draw
+    using ShaderSetup = std::function<void(Shader&)>;
+    // Called before the first draw of each run of items sharing a material
+    using MaterialSetup = std::function<void(const Material&)>;
+
+    RenderQueue();
+
+    void Clear();
+    void ResetStats();
+
+    // Adds one item per mesh of the model. depth is the view distance used to
+    // order draws front to back within a state bucket.
+    void Add(Pass pass, uint8_t shaderIndex, const Model& model, float depth, float maxDepth);
+    void Sort();
+
+    // shaders is indexed by the shader index given to Add. Per-draw data for
+    // the whole queue is written into the ring and bound as DrawBlock once;
+    // each draw only selects its entry by draw ID. materialSetup binds the
+    // material's textures (main pass only).
+    void Submit(Shader* const* shaders, const ShaderSetup& setup, UniformRing& ring,
+                const MaterialSetup& materialSetup = nullptr);
+
+    static void WriteDrawData(const Model& model, GPUDrawData& data);
+
+    const std::vector<DrawItem>& GetItems() const { return items; }
+    const Stats& GetStats() const { return stats; }
+    int GetDrawCount() const { return static_cast<int>(items.size()); }
+
+private:
+    static constexpr int PASS_SHIFT = 60;
+    static constexpr int SHADER_SHIFT = 52;
+    static constexpr int MATERIAL_SHIFT = 36;
+    static constexpr int MESH_SHIFT = 20;
+    static constexpr uint64_t DEPTH_MASK = (1u << 20) - 1;
+    // Material id of everything past the first 64K - 1 distinct materials.
+    // Those draws cannot be grouped by the key and bind their material each.
+    static constexpr uint16_t UNBATCHED_MATERIAL = 0xFFFF;
+
+    // The material values the shaders actually consume
+    struct MaterialKey {
+        glm::vec3 albedo;
+        float metallic;
+        float roughness;
+        float ao;
+        const Texture* textures[Material::TEXTURE_UNIT_COUNT];
+
+        bool operator==(const MaterialKey& other) const;
+    };
+
+    struct MaterialKeyHash {
+        size_t operator()(const MaterialKey& key) const;
+    };
+
+    std::vector<DrawItem> items;
+    std::vector<DrawItem> sortScratch;
+    std::unordered_map<MaterialKey, uint16_t, MaterialKeyHash> materialIds;
+    std::vector<GLuint> drawIds;
+    Stats stats;
+
+    uint16_t InternMaterial(const Material& material);
+    void RadixSort();
+};
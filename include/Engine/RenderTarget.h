@@ -0,0 +1,35 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+// Offscreen framebuffer with an RGBA8 color texture and a depth renderbuffer,
+// at any resolution. Used by the headless renderer to produce image files.
+class RenderTarget {
+public:
+    RenderTarget();
+    ~RenderTarget();
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    bool Create(int width, int height);
+    void Destroy();
+
+    // Reads back tightly packed RGB rows, top row first
+    void ReadPixels(std::vector<unsigned char>& rgb) const;
+    bool WritePPM(const std::string& filePath) const;
+
+    GLuint GetFramebuffer() const { return framebuffer; }
+    GLuint GetColorTexture() const { return colorTexture; }
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+private:
+    GLuint framebuffer;
+    GLuint colorTexture;
+    GLuint depthBuffer;
+    int width, height;
+    mutable std::vector<unsigned char> readBuffer;
+};
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <GL/glew.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -9,32 +8,79 @@
 #include <memory>
 
 #include "Shader.h"
+#include "ShaderVariants.h"
 #include "Camera.h"
 #include "Light.h"
 #include "Scene.h"
+#include "RenderQueue.h"
+#include "GeometryArena.h"
+#include "UniformRing.h"
+#include "Texture.h"
+#include "Material.h"
 
 class Renderer {
 public:
+    // Size of the LightBlock light table in shaders/fragment/main.frag
+    static constexpr int MAX_LIGHTS = 64;
+    static constexpr GLuint LIGHT_BLOCK_BINDING = 0;
+    static constexpr GLuint DRAW_DATA_BINDING = RenderQueue::DRAW_DATA_BINDING;
+    static constexpr GLuint FRAME_BLOCK_BINDING = 2;
+    // Minimum size of each frame's region in the streaming ring; ReserveFrameData
+    // sizes it for the scene, and it grows on overflow
+    static constexpr GLsizeiptr FRAME_RING_SIZE = 1 << 20;
+    
+    // Matches MAX_CASCADES in shaders/fragment/main.frag
+    static constexpr int MAX_SHADOW_CASCADES = 4;
+    static constexpr GLint SHADOW_MAP_UNIT = 8;
+
     Renderer(int width, int height);
     ~Renderer();
 
     void Initialize();
+    // Sizes the streaming ring for a frame of scene with every model in view
+    // and in every cascade, so the first frames do not spill. Call once the
+    // scene is loaded.
+    void ReserveFrameData(const Scene& scene);
+    // Rebuilds shaders when their source files change on disk (drained by
+    // FileUtils::UpdateFileWatchers)
+    void EnableHotReload();
     void Render(const Scene& scene, const Camera& camera);
     void SetViewport(int width, int height);
+    // Framebuffer the frame is rendered into (0 = default/window)
+    void SetRenderTarget(GLuint framebuffer);
     void EnableFeature(GLenum feature);
     void DisableFeature(GLenum feature);
     
+    // Cascaded shadow maps for the first directional light
+    void SetShadowCascades(int count);
+    void SetShadowMapResolution(int resolution);
+    void SetShadowDistance(float distance);
+    int GetShadowCascades() const { return cascadeCount; }
+    int GetShadowMapResolution() const { return shadowMapResolution; }
+    // Sun movement below this angle reuses the cached static shadow layer
+    void SetShadowCacheThreshold(float degrees);
+    int GetShadowCacheRebuilds() const { return shadowCacheRebuilds; }
+    
     // Performance monitoring
     void BeginFrame();
     void EndFrame();
     float GetFPS() const { return fps; }
     int GetDrawCalls() const { return drawCalls; }
+    int GetVisibleModels() const { return mainCullStats.visible; }
+    int GetCulledModels() const { return mainCullStats.culled; }
+    // Distinct models casting into at least one cascade, and those in none
+    int GetShadowVisibleModels() const { return shadowCullStats.visible; }
+    int GetShadowCulledModels() const { return shadowCullStats.culled; }
+    const RenderQueue::Stats& GetQueueStats() const { return renderQueue.GetStats(); }
+    int GetIndirectDraws() const { return indirectDraws; }
+    int GetIndirectSubmits() const { return indirectSubmits; }
 
 private:
     int width, height;
     float fps;
     int drawCalls;
     double lastFrameTime;
+    int framesSinceFpsUpdate;
     
     // Rendering state
     bool depthTestEnabled;
@@ -42,21 +88,143 @@ private:
     bool blendingEnabled;
     
     // Shaders
-    std::unique_ptr<Shader> mainShader;
-    std::unique_ptr<Shader> shadowShader;
+    ShaderVariants mainVariants;
+    ShaderVariants shadowVariants;
     std::unique_ptr<Shader> skyboxShader;
     
+    // Material maps. Units 0..TEXTURE_UNIT_COUNT-1 always hold something:
+    // a material's own map, or a neutral default (white, or a flat normal
+    // on the normal unit) while a map is missing or still streaming in.
+    std::unique_ptr<Texture> defaultTexture;
+    std::unique_ptr<Texture> defaultNormalMap;
+    GLuint boundMaterialTextures[Material::TEXTURE_UNIT_COUNT];
+    void SetupDefaultTextures();
+    void BindMaterialTextures(const Material* material);
+    
     // Framebuffers
     GLuint shadowMapFBO;
-    GLuint shadowMap;
+    GLuint shadowMap;   // GL_TEXTURE_2D_ARRAY, one layer per cascade
+    GLuint staticShadowMap;   // Static casters only, copied into shadowMap each frame
+    
+    // Shadow cascades, split along the camera frustum up to shadowDistance
+    struct ShadowCascade {
+        glm::mat4 lightSpaceMatrix;
+        float splitDepth;   // View-space distance where this cascade ends
+        glm::vec4 planes[6];
+        
+        // Static caster layer cache
+        bool staticValid;
+        glm::mat4 staticMatrix;
+    };
+    ShadowCascade cascades[MAX_SHADOW_CASCADES];
+    int cascadeCount;
+    int shadowMapResolution;
+    float shadowDistance;
+    float cascadeSplitLambda;
+    bool shadowsRendered;
+    glm::vec3 shadowLightDirection;   // Only follows the light past shadowCacheCosThreshold
+    float shadowCacheCosThreshold;
+    uint64_t shadowStaticVersion;
+    int shadowCacheRebuilds;
+    std::vector<const Model*> staticCasters;
+    std::vector<const Model*> dynamicCasters;
+    std::vector<const Model*> uniqueShadowCasters;
+    std::vector<std::pair<glm::vec3, glm::vec3>> staticChanges;
+    
+    // Light table (std140 UBO). Only re-uploaded when the scene's light
+    // list, the ambient term or a light's dirty flag changes.
+    GLuint lightUBO;
+    std::vector<const Light*> uploadedLights;
+    glm::vec3 uploadedAmbient;
     
     void SetupShadowMapping();
-    void RenderShadowMap(const Scene& scene, const Light& light);
+    void SetupLightBuffer();
+    void UpdateLightBuffer(const Scene& scene);
+    void RenderShadowMap(const Scene& scene, const Light& light, const Camera& camera);
+    void RenderShadowCasters(const std::vector<const Model*>& casters, const glm::mat4& lightSpaceMatrix);
+    void UpdateCascades(const Camera& camera, const glm::vec3& lightDirection);
+    void CreateShadowTexture(GLuint& texture);
     void RenderScene(const Scene& scene, const Camera& camera, const Light& light);
     void RenderSkybox(const Scene& scene, const Camera& camera);
     
+    // Camera and shadow data shared by every main-pass program (std140);
+    // mirrors FrameBlock in the shaders
+    struct GPUFrameData {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::vec4 viewPos;
+        glm::vec4 shadowLightDirection;
+        glm::vec4 cascadeSplits;
+        glm::ivec4 cascadeCount;
+        glm::mat4 lightSpaceMatrices[MAX_SHADOW_CASCADES];
+    };
+    
+    // Per-frame and per-draw data is written linearly into this ring and
+    // bound by range, instead of going through glUniform* per draw
+    UniformRing frameRing;
+    void UploadFrameData(const Camera& camera);
+    
+    // Draw submission. Every variant in use gets a slot, and the slot is
+    // the shader index in the sort key.
+    RenderQueue renderQueue;
+    std::vector<Shader*> shaderSlots;
+    uint32_t lightBucketBits;   // ShaderVariants light bucket for this frame
+    bool shaderStartupReported;
+    
+    uint32_t SelectVariant(const Model& model, bool shadowPass) const;
+    Shader* SelectShader(const Model& model, bool shadowPass);
+    int GetShaderSlot(Shader* shader);   // -1 when out of slots
+    
+    // Static geometry: packed into the arena and drawn with one
+    // glMultiDrawElementsIndirect per arena page
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLuint baseVertex;
+        GLuint baseInstance;
+    };
+    
+    struct IndirectBatch {
+        Shader* shader;
+        int page;
+        GLsizei first;
+        GLsizei count;
+    };
+    
+    std::unique_ptr<GeometryArena> geometryArena;
+    UniformRing::Allocation indirectCommandAllocation;   // Commands and draw data live in frameRing
+    UniformRing::Allocation indirectDataAllocation;
+    GLsizeiptr indirectDataSize;
+    std::vector<DrawElementsIndirectCommand> indirectCommands;
+    std::vector<std::pair<uint64_t, DrawElementsIndirectCommand>> keyedCommands;   // (slot, page) key
+    std::vector<GPUDrawData> drawData;
+    std::vector<IndirectBatch> indirectBatches;
+    std::vector<const Model*> dynamicModels;
+    int indirectDraws;
+    int indirectSubmits;
+    
+    void SetupIndirectBuffers();
+    void BuildIndirectDraws(const std::vector<const Model*>& models, std::vector<const Model*>& remaining,
+                            bool shadowPass);
+    void SubmitIndirectDraws(const RenderQueue::ShaderSetup& setup);
+    
     // Frustum culling
-    bool IsInFrustum(const glm::vec3& position, float radius);
+    struct CullStats {
+        int visible;
+        int culled;
+    };
+    CullStats mainCullStats;
+    CullStats shadowCullStats;
+    std::vector<const Model*> visibleModels;
+    std::vector<const Model*> shadowCasters;
+    
+    static bool IsInFrustum(const glm::vec4 planes[6], const glm::vec3& min, const glm::vec3& max, bool testNearPlane);
+    static void ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+    void CullModels(const Scene& scene, const glm::vec4 planes[6], bool testNearPlane,
+                    std::vector<const Model*>& visible, CullStats& stats);
     void UpdateFrustum(const Camera& camera);
     glm::vec4 frustumPlanes[6];
+    
+    GLuint targetFramebuffer;
 };
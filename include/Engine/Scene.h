@@ -6,6 +6,7 @@
 #include <memory>
 #include <unordered_map>
 #include <array>
+#include <cstdint>
 
 #include "Model.h"
 #include "Light.h"
@@ -22,10 +23,22 @@ public:
     void AddLight(std::shared_ptr<Light> light);
     void RemoveLight(std::shared_ptr<Light> light);
     void SetSkybox(std::shared_ptr<Skybox> skybox);
+    
+    // Bumped whenever static geometry is added, removed or edited, so caches
+    // built from static models (e.g. the static shadow layer) know to rebuild.
+    // The world bounds of recent changes are kept, so a cache covering part
+    // of the world can skip changes elsewhere; a change without bounds
+    // invalidates everything.
+    void MarkStaticGeometryChanged();
+    void MarkStaticGeometryChanged(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+    uint64_t GetStaticVersion() const { return staticVersion; }
+    // Bounds of every change after sinceVersion. False when one had no
+    // bounds or the history no longer reaches back that far.
+    bool GetStaticChanges(uint64_t sinceVersion, std::vector<std::pair<glm::vec3, glm::vec3>>& bounds) const;
 
     // Scene queries
-    std::vector<std::shared_ptr<Model>> GetModels() const { return models; }
-    std::vector<std::shared_ptr<Light>> GetLights() const { return lights; }
+    const std::vector<std::shared_ptr<Model>>& GetModels() const { return models; }
+    const std::vector<std::shared_ptr<Light>>& GetLights() const { return lights; }
     std::shared_ptr<Skybox> GetSkybox() const { return skybox; }
 
     // Spatial queries
@@ -47,6 +60,21 @@ private:
     std::vector<std::shared_ptr<Light>> lights;
     std::shared_ptr<Skybox> skybox;
     glm::vec3 ambientLight;
+    uint64_t staticVersion;
+
+    // Ring of the last STATIC_CHANGE_HISTORY changes, indexed by version
+    struct StaticChange {
+        uint64_t version;
+        bool bounded;
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+    };
+    static const size_t STATIC_CHANGE_HISTORY = 1024;
+    std::vector<StaticChange> staticChanges;
+    void RecordStaticChange(bool bounded, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+    // Position of each model in models, so removal does not search
+    std::unordered_map<const Model*, size_t> modelIndices;
 
     // Spatial partitioning for optimization
     struct OctreeNode {
@@ -58,7 +86,10 @@ private:
     };
 
     std::unique_ptr<OctreeNode> octree;
+    // Leaf holding each model, for removal without a rebuild
+    std::unordered_map<const Model*, OctreeNode*> octreeLeaves;
     void BuildOctree();
     void InsertModelInOctree(std::shared_ptr<Model> model, OctreeNode* node);
+    void SplitOctreeNode(OctreeNode* node);
     std::vector<std::shared_ptr<Model>> QueryOctree(const glm::vec3& position, float radius, OctreeNode* node) const;
 };
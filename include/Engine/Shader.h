@@ -3,10 +3,27 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "ShaderCache.h"
+
+// Interned uniform name. Construct once (typically as a file-scope constant)
+// and pass to the Shader setters: each program resolves every interned name
+// after linking, so a set is an array index rather than a string hash.
+class UniformId {
+public:
+    explicit UniformId(const char* name);
+
+    uint32_t GetIndex() const { return index; }
+    const std::string& GetName() const;
+
+private:
+    uint32_t index;
+};
+
 class Shader {
 public:
     Shader();
@@ -14,6 +31,14 @@ public:
 
     bool LoadFromFiles(const std::string& vertexPath, const std::string& fragmentPath);
     bool LoadFromFiles(const std::string& vertexPath, const std::string& geometryPath, const std::string& fragmentPath);
+    // Each define ("NAME" or "NAME value") is injected after #version
+    bool LoadFromSources(const std::string& vertexCode, const std::string& fragmentCode,
+                         const std::vector<std::string>& defines = {});
+    // Rebuilds from the files given to LoadFromFiles; on failure the
+    // previous program stays in use
+    bool Reload();
+    std::vector<std::string> GetSourcePaths() const;
+    
     void Use();
     void Unuse();
     
@@ -31,16 +56,37 @@ public:
     void SetMat4Array(const std::string& name, const std::vector<glm::mat4>& values);
     void SetVec3Array(const std::string& name, const std::vector<glm::vec3>& values);
     
+    // Uniform setters by interned name (hot paths)
+    void SetBool(const UniformId& id, bool value);
+    void SetInt(const UniformId& id, int value);
+    void SetFloat(const UniformId& id, float value);
+    void SetVec2(const UniformId& id, const glm::vec2& value);
+    void SetVec3(const UniformId& id, const glm::vec3& value);
+    void SetVec4(const UniformId& id, const glm::vec4& value);
+    void SetMat3(const UniformId& id, const glm::mat3& value);
+    void SetMat4(const UniformId& id, const glm::mat4& value);
+    
+    // -1 if the program has no such active uniform
+    GLint GetUniformLocation(const std::string& name);
+    GLint GetUniformLocation(const UniformId& id);
+    
     GLuint GetID() const { return programID; }
     bool IsValid() const { return programID != 0; }
 
 private:
     GLuint programID;
+    ShaderCache::StageSources sourceFiles;   // Stage and path, empty if built from sources
     std::unordered_map<std::string, GLint> uniformCache;
+    // Indexed by UniformId; names interned after the link resolve on first use
+    std::vector<GLint> uniformLocations;
     
+    // Loads the program from the binary cache, or compiles, links and caches it
+    bool BuildProgram(const ShaderCache::StageSources& sources, const std::vector<std::string>& defines);
+    void AdoptProgram(GLuint program);
+    static std::string InjectDefines(const std::string& source, const std::vector<std::string>& defines);
     bool CompileShader(GLuint& shaderID, GLenum shaderType, const std::string& source);
-    bool LinkProgram();
-    GLint GetUniformLocation(const std::string& name);
+    bool LinkProgram(GLuint program);
+    void ResolveUniforms();
     std::string ReadFile(const std::string& filePath);
-    void CheckCompileErrors(GLuint shader, const std::string& type);
+    bool CheckCompileErrors(GLuint shader, const std::string& type);
 };
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary/glProgramBinary).
+//
+// Entries are keyed by a hash of every stage's source, the injected defines
+// and the GL vendor/renderer/version strings, so a driver update or an edited
+// shader simply misses. A binary the driver rejects is deleted and the
+// program is compiled from source again.
+class ShaderCache {
+public:
+    // Stage type and its full source text
+    using StageSources = std::vector<std::pair<GLenum, std::string>>;
+
+    static ShaderCache& Instance();
+
+    // Defaults to "shader_cache" in the working directory
+    void SetDirectory(const std::string& directory);
+    void SetEnabled(bool enabled) { this->enabled = enabled; }
+    bool IsEnabled() const;
+
+    uint64_t MakeKey(const StageSources& stages, const std::string& defines);
+
+    // Loads a cached binary into program; false on a miss or rejection
+    bool Load(uint64_t key, GLuint program);
+    // Stores the binary of a linked program created with
+    // GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    void Store(uint64_t key, GLuint program);
+
+    // Startup statistics
+    void RecordCompile() { compiles++; }
+    int GetHits() const { return hits; }
+    int GetCompiles() const { return compiles; }
+    int GetRejected() const { return rejected; }
+
+private:
+    ShaderCache();
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    std::string GetEntryPath(uint64_t key) const;
+
+    std::string directory;
+    bool enabled;
+    int binaryFormats;   // -1 until queried from the context
+    std::string driverId;
+    int hits;
+    int compiles;
+    int rejected;
+};
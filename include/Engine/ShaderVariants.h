@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+// Permutations of one vertex/fragment source pair, selected by a feature mask
+// and built on first use by injecting the matching #defines. The sources are
+// read once; each variant goes through the program binary cache.
+class ShaderVariants {
+public:
+    enum Feature : uint32_t {
+        INSTANCING = 1u << 0,    // Per-instance transform and state attributes
+        SHADOWS = 1u << 1,       // Cascaded shadow lookup
+        NORMAL_MAP = 1u << 2,    // Tangent-space normal map
+        UNLIT = 1u << 3          // Albedo only, no lighting
+    };
+
+    // Light loop bounds a variant can be compiled with (LIGHT_COUNT)
+    static constexpr int LIGHT_BUCKETS[] = { 0, 1, 4, 16, 64 };
+    static constexpr int LIGHT_BUCKET_COUNT = 5;
+    static constexpr int LIGHT_BUCKET_SHIFT = 8;
+
+    // Smallest bucket holding lightCount, as mask bits
+    static uint32_t LightBucketBits(int lightCount);
+
+    ShaderVariants();
+
+    bool LoadFromFiles(const std::string& vertexPath, const std::string& fragmentPath);
+    // Re-reads the sources and rebuilds every built variant in place (Shader
+    // pointers stay valid). A variant that fails keeps its previous program.
+    bool Reload();
+    std::vector<std::string> GetSourcePaths() const { return { vertexPath, fragmentPath }; }
+
+    // Called once on every newly built variant (e.g. to set sampler units)
+    void SetInitializer(std::function<void(Shader&)> initializer) { this->initializer = std::move(initializer); }
+
+    // Builds the variant on first request; nullptr if it fails to compile
+    Shader* Get(uint32_t features);
+
+    int GetVariantCount() const { return static_cast<int>(variants.size()); }
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::string name;
+    std::function<void(Shader&)> initializer;
+    std::unordered_map<uint32_t, std::unique_ptr<Shader>> variants;
+
+    static std::vector<std::string> GetDefines(uint32_t features);
+    void Initialize(Shader& shader);
+};
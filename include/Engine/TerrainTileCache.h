@@ -0,0 +1,99 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Utils/TerrainPyramid.h"
+
+// Keeps tiles of an on-disk terrain pyramid in memory under a byte budget.
+// Worker threads read requested tiles; Update (main thread, once per frame)
+// adopts finished reads, drops requests that were not repeated, and evicts
+// the least recently used tiles beyond the budget. Tiles used in the last
+// frame are never evicted, and the root tile is read up front and kept, so
+// every position always has some height.
+class TerrainTileCache {
+public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 << 20;
+
+    struct Stats {
+        int resident;
+        int pending;   // Queued or being read
+        size_t residentBytes;
+    };
+
+    // 0 workers picks from the core count
+    explicit TerrainTileCache(std::shared_ptr<const TerrainPyramid> pyramid, int workerCount = 0);
+    ~TerrainTileCache();
+
+    TerrainTileCache(const TerrainTileCache&) = delete;
+    TerrainTileCache& operator=(const TerrainTileCache&) = delete;
+
+    void SetMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+
+    // Main thread. The tile's samples (see TerrainPyramid), or null when it
+    // is not resident; marks the tile as used this frame.
+    const float* Find(int level, int x, int z);
+    // Main thread. Queues a read unless the tile is resident or on its way;
+    // a queued read is dropped if it is not requested again next frame.
+    void Request(int level, int x, int z);
+
+    // Main thread, once per frame
+    void Update();
+    // Blocks until every queued read has finished and adopts the results
+    void Flush();
+
+    Stats GetStats() const;
+
+private:
+    struct Tile {
+        std::vector<float> samples;
+        uint64_t lastUsed;
+    };
+
+    struct Job {
+        int level;
+        int x;
+        int z;
+        uint64_t frame;   // Last requested
+    };
+
+    struct Result {
+        uint64_t key;
+        std::vector<float> samples;   // Empty when the read failed
+    };
+
+    static uint64_t GetKey(int level, int x, int z);
+    void WorkerLoop();
+    void AdoptResults();
+    void Evict();
+
+    std::shared_ptr<const TerrainPyramid> pyramid;
+    size_t memoryBudget;
+    uint64_t rootKey;
+
+    // Main thread only
+    std::unordered_map<uint64_t, Tile> tiles;
+    std::unordered_set<uint64_t> failed;
+    size_t residentBytes;
+    uint64_t frame;
+
+    std::vector<std::thread> workers;
+    bool stopping;
+    mutable std::mutex jobMutex;
+    std::condition_variable jobCondition;
+    std::condition_variable idleCondition;
+    std::deque<uint64_t> jobOrder;
+    std::unordered_map<uint64_t, Job> queued;
+    std::unordered_set<uint64_t> reading;   // Until the result is adopted
+    int activeReads;
+
+    std::mutex resultMutex;
+    std::vector<Result> results;
+};
@@ -4,6 +4,9 @@
 #include <glm/glm.hpp>
 #include <string>
 #include <memory>
+#include <vector>
+
+struct Image;
 
 enum class TextureType {
     DIFFUSE,
@@ -21,6 +24,7 @@ enum class TextureType {
 enum class TextureFormat {
     RGB,
     RGBA,
+    SRGB_ALPHA,   // 8-bit sRGB color with linear alpha (albedo maps)
     DEPTH,
     DEPTH_STENCIL,
     R,
@@ -28,7 +32,16 @@ enum class TextureFormat {
     RGB16F,
     RGBA16F,
     RGB32F,
-    RGBA32F
+    RGBA32F,
+    // Block-compressed, loaded from KTX2/DDS (see TextureContainer)
+    BC1,
+    BC1_SRGB,
+    BC3,
+    BC3_SRGB,
+    BC4,
+    BC5,
+    BC7,
+    BC7_SRGB
 };
 
 enum class TextureFilter {
@@ -55,11 +68,23 @@ public:
     ~Texture();
 
     // Texture loading and creation
+    // While file watching is active (see FileUtils::WatchFile) the file is
+    // watched and reloaded into the same texture object when it changes
     bool LoadFromFile(const std::string& filePath);
+    bool Reload();
+    const std::string& GetFilePath() const { return filePath; }
+    // channels is 1 (R), 2 (RG), 3 (RGB) or 4 (RGBA); diffuse maps are sRGB
     bool LoadFromMemory(const unsigned char* data, int width, int height, int channels);
     void Create(int width, int height, TextureFormat format);
     void CreateCubemap(const std::vector<std::string>& facePaths);
     void CreateShadowMap(int width, int height);
+    
+    // Streaming (see TextureStreamer): takes ownership of a fully uploaded
+    // texture object and replaces the current storage (e.g. a placeholder)
+    void AdoptStorage(GLuint texture, int width, int height, int channels, TextureFormat format, bool hasMipmaps);
+    void SetResident(bool resident) { this->resident = resident; }
+    // False while a streamed texture still shows its placeholder
+    bool IsResident() const { return resident; }
 
     // Texture parameters
     void SetFilter(TextureFilter minFilter, TextureFilter magFilter);
@@ -78,6 +103,7 @@ public:
     GLuint GetID() const { return textureID; }
     int GetWidth() const { return width; }
     int GetHeight() const { return height; }
+    int GetChannels() const { return channels; }
     TextureType GetType() const { return type; }
     TextureFormat GetFormat() const { return format; }
     bool IsValid() const { return textureID != 0; }
@@ -87,19 +113,37 @@ public:
     void Resize(int newWidth, int newHeight);
     void SaveToFile(const std::string& filePath);
     void GetData(unsigned char* data);
+    
+    // GL enums of a format
+    static GLenum GetGLFormat(TextureFormat format);
+    static GLenum GetGLInternalFormat(TextureFormat format);
+    static GLenum GetGLDataType(TextureFormat format);
+    static bool IsCompressed(TextureFormat format);
+    // Asks the driver (compressed formats are optional, e.g. S3TC)
+    static bool IsFormatSupported(TextureFormat format);
+    // Format a decoded image is uploaded as: block formats keep the image's
+    // sRGB flag, 8-bit color is sRGB for diffuse maps
+    static TextureFormat GetImageFormat(const Image& image, TextureType type);
 
 private:
     GLuint textureID;
+    GLenum target;
+    GLuint framebuffer;   // Created by BindAsRenderTarget
     int width, height;
     TextureType type;
     TextureFormat format;
     int channels;
     bool hasMipmaps;
+    bool resident;
+    std::string filePath;
+    int watchId;   // 0 when not watched
     
+    // Uploads every level as stored (containers with their own mip chain)
+    bool LoadLevels(const Image& image);
     void InitializeTexture();
     void SetTextureParameters();
-    GLenum GetGLFormat(TextureFormat format);
-    GLenum GetGLInternalFormat(TextureFormat format);
-    GLenum GetGLDataType(TextureFormat format);
+    TextureFormat ChooseFormat(int channels) const;
+    static GLenum GetGLFilter(TextureFilter filter);
+    static GLenum GetGLWrap(TextureWrap wrap);
     void DeleteTexture();
 };
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.h"
+#include "Utils/ImageLoader.h"
+
+// Asynchronous texture loading. Load returns immediately with a texture that
+// shows a 1x1 placeholder; worker threads decode the file and build its mip
+// chain, and Update (once per frame, on the GL thread) uploads the result
+// through a pool of pixel buffer objects, at most uploadBudget bytes per
+// frame. A texture is swapped in only once every level is uploaded, so a
+// half-uploaded image is never sampled.
+class TextureStreamer {
+public:
+    static constexpr int PBO_COUNT = 4;
+    static constexpr GLsizeiptr PBO_SIZE = 4 << 20;
+    static constexpr size_t DEFAULT_UPLOAD_BUDGET = 8 << 20;
+
+    struct Stats {
+        int pendingDecodes;
+        int pendingUploads;
+        int resident;
+        size_t uploadedBytes;   // Last Update
+    };
+
+    static TextureStreamer& Instance();
+
+    // Worker threads start on the first Load; 0 picks from the core count
+    void SetWorkerCount(int count) { workerCount = count; }
+    void SetUploadBudget(size_t bytesPerFrame) { uploadBudget = bytesPerFrame; }
+
+    // Requests of the same path share one texture
+    std::shared_ptr<Texture> Load(const std::string& filePath, TextureType type = TextureType::DIFFUSE);
+
+    // GL thread, once per frame
+    void Update();
+
+    // Blocks until every requested texture is resident (tools, headless runs)
+    void Flush();
+
+    // Stops the workers and frees the PBOs; the context must still be current
+    void Shutdown();
+
+    Stats GetStats() const;
+
+private:
+    struct DecodeJob {
+        std::string path;
+        std::weak_ptr<Texture> texture;
+        TextureType type;
+    };
+
+    struct Upload {
+        std::string path;
+        std::weak_ptr<Texture> texture;
+        TextureType type;
+        Image image;
+        GLuint staging;   // Receives the levels; adopted by the texture when done
+        size_t level;
+        int row;   // Next row (of blocks, when compressed) to stage
+    };
+
+    struct PixelBuffer {
+        GLuint buffer;
+        GLsync fence;
+    };
+
+    TextureStreamer();
+    ~TextureStreamer();
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    void StartWorkers();
+    void WorkerLoop();
+    void Enqueue(const std::string& path, const std::shared_ptr<Texture>& texture, TextureType type);
+    PixelBuffer* AcquirePixelBuffer();
+    // Copies up to maxBytes of the front upload into the mapped PBO and
+    // returns the bytes used (0 if not even one row fits)
+    size_t StageChunk(Upload& upload, unsigned char* mapped, GLintptr offset, size_t maxBytes);
+    void FinishUpload(Upload& upload);
+    static GLenum GetDataFormat(int channels);
+
+    int workerCount;
+    size_t uploadBudget;
+    std::vector<std::thread> workers;
+    bool stopping;
+
+    mutable std::mutex jobMutex;
+    std::condition_variable jobCondition;
+    std::deque<DecodeJob> jobs;
+    int activeDecodes;
+
+    mutable std::mutex resultMutex;
+    std::vector<Upload> decoded;
+
+    // GL thread only
+    std::deque<Upload> uploads;
+    PixelBuffer pixelBuffers[PBO_COUNT];
+    int nextPixelBuffer;
+    std::unordered_map<std::string, std::weak_ptr<Texture>> textures;
+    size_t uploadedBytes;
+    int residentCount;
+
+    struct PendingChunk {
+        GLuint texture;
+        GLint level;
+        int y;   // Texels
+        int height;
+        int width;
+        GLenum dataFormat;
+        GLenum compressedFormat;   // 0 for uncompressed data
+        GLsizei size;
+        GLintptr offset;
+    };
+    std::vector<PendingChunk> chunks;
+};
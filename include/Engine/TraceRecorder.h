@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Timeline recorder that writes Chrome trace-event JSON (loadable in
+// chrome://tracing and ui.perfetto.dev).
+//
+// Each thread appends complete events to its own fixed-size buffer, so the
+// hot path takes no lock. A thread's buffer is handed to the next new thread
+// once it exits, so short-lived workers (ParallelFor) do not pile them up.
+// When no capture is running a zone costs one relaxed atomic load, which
+// keeps TRACE_SCOPE cheap enough to leave in release builds.
+// Event names must be string literals (only the pointer is stored).
+class TraceRecorder {
+public:
+    static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+    static TraceRecorder& Instance();
+
+    static bool IsRecording() { return recording.load(std::memory_order_relaxed); }
+    static int64_t Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Records the next frameCount frames and writes them to outputPath
+    void StartCapture(int frameCount, const std::string& outputPath);
+    void StopCapture();
+    bool IsCapturing() const { return IsRecording(); }
+
+    // Call once per frame; emits a frame marker and finishes the capture
+    // after the requested number of frames
+    void FrameBoundary();
+
+    // Label for the calling thread in the timeline
+    void SetThreadName(const char* name);
+
+    void AddEvent(const char* name, int64_t beginNs, int64_t endNs);
+
+private:
+    struct Event {
+        const char* name;
+        int64_t beginNs;
+        int64_t endNs;
+    };
+
+    // Written only by its owning thread; count is published with release so
+    // the writer sees every event below it
+    struct ThreadBuffer {
+        int threadId;
+        std::string threadName;
+        std::unique_ptr<Event[]> events;
+        std::atomic<size_t> count;
+        std::atomic<size_t> dropped;
+    };
+
+    TraceRecorder();
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    ThreadBuffer& GetThreadBuffer();
+    void ReleaseThreadBuffer(ThreadBuffer& buffer);
+    bool WriteTrace();
+
+    static std::atomic<bool> recording;
+
+    std::mutex buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    // Buffers of exited threads; their events stay in the trace
+    std::vector<ThreadBuffer*> freeBuffers;
+
+    // Owned by the thread that drives FrameBoundary
+    int framesRequested;
+    int frameNumber;
+    int64_t captureStartNs;
+    int64_t frameBeginNs;
+    std::string outputPath;
+};
+
+class TraceZone {
+public:
+    explicit TraceZone(const char* name)
+        : name(name), beginNs(TraceRecorder::IsRecording() ? TraceRecorder::Now() : 0) {}
+    ~TraceZone() {
+        if (beginNs != 0) {
+            TraceRecorder::Instance().AddEvent(name, beginNs, TraceRecorder::Now());
+        }
+    }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* name;
+    int64_t beginNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceZone TRACE_CONCAT(traceZone_, __LINE__)(name)
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+// Triple-buffered streaming buffer for data rewritten every frame (per-frame
+// uniforms, per-draw data, indirect commands).
+//
+// The buffer is split into one region per frame in flight. Allocations are
+// carved linearly from the current frame's region and written in place; a
+// fence per region makes BeginFrame wait only if the GPU is still reading the
+// region from FRAMES_IN_FLIGHT frames ago. The same buffer can be bound as a
+// UBO, SSBO or indirect buffer, since allocations honour all their alignments.
+//
+// With GL_ARB_buffer_storage the buffer is persistently and coherently mapped.
+// Without it (plain GL 4.3), writes go to a CPU copy that Commit() uploads.
+//
+// An allocation that does not fit the current region spills into a temporary
+// buffer of its own, so nothing is dropped; the region is grown to fit the
+// whole frame at the next BeginFrame.
+class UniformRing {
+public:
+    static constexpr int FRAMES_IN_FLIGHT = 3;
+
+    UniformRing();
+    ~UniformRing();
+
+    // Where an allocation lives: the ring itself, or a spill buffer
+    struct Allocation {
+        void* data = nullptr;
+        GLuint buffer = 0;
+        GLintptr offset = 0;
+    };
+
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    bool Create(GLsizeiptr bytesPerFrame);
+    void Destroy();
+    // Grows each frame's region to at least bytesPerFrame, waiting for the
+    // GPU to finish with the current buffer. Call between frames.
+    bool Reserve(GLsizeiptr bytesPerFrame);
+
+    // Waits for the oldest region to be free and starts allocating from it.
+    // A region that overflowed last time is grown first.
+    void BeginFrame();
+    // Fences the current region
+    void EndFrame();
+
+    // Returns write space for size bytes and the buffer range to bind. When
+    // this frame's region is full the range is in a spill buffer instead.
+    Allocation Allocate(GLsizeiptr size);
+    // Makes written bytes visible to the GPU (a no-op for ring allocations
+    // when persistently mapped)
+    void Commit(const Allocation& allocation, GLsizeiptr size);
+
+    GLuint GetBuffer() const { return buffer; }
+    GLsizeiptr GetBytesPerFrame() const { return bytesPerFrame; }
+    GLsizeiptr GetBytesUsed() const { return head + spilledBytes; }
+    bool IsPersistent() const { return persistent; }
+
+private:
+    GLuint buffer;
+    unsigned char* mapped;   // Persistent mapping, or the CPU copy
+    std::vector<unsigned char> staging;
+    bool persistent;
+    GLsizeiptr bytesPerFrame;
+    GLsizeiptr alignment;
+    GLsync fences[FRAMES_IN_FLIGHT];
+    int frame;
+    GLsizeiptr head;
+    bool overflowed;
+
+    // Spill buffers of each region, freed once its fence has signalled
+    struct Spill {
+        GLuint buffer;
+        std::vector<unsigned char> data;
+    };
+    std::vector<Spill> spills[FRAMES_IN_FLIGHT];
+    GLsizeiptr spilledBytes;   // This frame's
+
+    void WaitForFence(int region);
+    void WaitForAllFences();
+    void ReleaseSpills(int region);
+};
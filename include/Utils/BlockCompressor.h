@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+#include "ImageLoader.h"
+
+// CPU encoder for the BC formats TextureContainer stores. Used offline by
+// tools/texcompress; quality favours simplicity over speed-matched
+// encoders: BC1/BC4 fit endpoints along the principal axis and refine them
+// once by least squares, and BC7 uses mode 6 (one RGBA subset, 4-bit
+// indices) only.
+class BlockCompressor {
+public:
+    // Encodes every level of an 8-bit image. BC1, BC3 and BC7 read RGBA;
+    // BC4 reads the first channel and BC5 the first two. The result keeps
+    // the source's orientation and srgb flag.
+    static bool Compress(const Image& source, BlockFormat format, Image& result, std::string& error);
+
+private:
+    // 4x4 texels, RGBA, edge texels repeated past the level bounds
+    struct Block {
+        float texels[16][4];
+    };
+
+    static void GatherBlock(const Image& image, int level, int blockX, int blockY, Block& block);
+    static void EncodeBC1(const Block& block, unsigned char* output);
+    static void EncodeBC4(const Block& block, int channel, unsigned char* output);
+    static void EncodeBC7(const Block& block, unsigned char* output);
+};
@@ -7,6 +7,8 @@
 #include <memory>
 #include <functional>
 
+class FileWatcher;
+
 class FileUtils {
 public:
     // File reading
@@ -18,6 +20,13 @@ public:
     // File writing
     static bool WriteTextFile(const std::string& filePath, const std::string& content);
     static bool WriteBinaryFile(const std::string& filePath, const std::vector<unsigned char>& data);
+    // Creates the parent directory and streams the file through write into a
+    // uniquely named temporary next to it (so concurrent writers of the same
+    // path never share one), renamed over filePath only once write returned
+    // true and the stream closed cleanly; a crash or full disk never leaves a
+    // truncated file behind. Does not touch GetLastError, so worker threads
+    // may call it.
+    static bool WriteFileAtomic(const std::string& filePath, const std::function<bool(std::ostream&)>& write);
     static bool CreateDirectory(const std::string& path);
     
     // Path utilities
@@ -42,10 +51,16 @@ public:
     static std::string GetTexturePath(const std::string& textureName);
     static std::string GetModelPath(const std::string& modelName);
     
-    // File watching
-    static void WatchFile(const std::string& filePath, std::function<void()> callback);
+    // File watching. Changes are detected on a background thread (inotify on
+    // Linux); UpdateFileWatchers runs the callbacks of changed files on the
+    // calling thread and costs nothing when no file changed.
+    static int WatchFile(const std::string& filePath, std::function<void()> callback);
     static void UnwatchFile(const std::string& filePath);
+    static void UnwatchFile(int watchId);
     static void UpdateFileWatchers();
+    static void StopFileWatchers();
+    // True once anything is watched; assets loaded later register themselves
+    static bool IsWatchingFiles() { return fileWatcher != nullptr; }
     
     // Configuration
     static void SetAssetDirectory(const std::string& directory);
@@ -64,13 +79,14 @@ private:
     static std::string modelDirectory;
     static std::string lastError;
     
-    struct FileWatcher {
-        std::string filePath;
+    struct FileWatch {
+        int id;
+        std::string filePath;   // Absolute, as reported by the watcher
         std::function<void()> callback;
-        std::time_t lastModified;
     };
-    static std::vector<FileWatcher> fileWatchers;
+    static std::vector<FileWatch> fileWatches;
+    static std::unique_ptr<FileWatcher> fileWatcher;
+    static int nextWatchId;
     
-    static std::time_t GetFileLastModified(const std::string& filePath);
     static std::string NormalizePath(const std::string& path);
 };
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Reports changed files from a background thread.
+//
+// On Linux the thread blocks on inotify. It watches the parent directories
+// rather than the files themselves, so editors that save by writing a temp
+// file and renaming it are still seen. Elsewhere the thread polls
+// modification times. Either way the main thread never stats anything:
+// changed paths are pushed into a lock-free single-producer/single-consumer
+// queue, and Poll drains it.
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool Start();
+    void Stop();
+
+    // Thread-safe. Paths are reported back in absolute, normalised form.
+    void Watch(const std::string& filePath);
+    void Unwatch(const std::string& filePath);
+
+    // Main thread only. Replaces changed with the distinct paths changed
+    // since the last call. If the queue overflowed, every watched path is
+    // reported. Returns false if nothing changed.
+    bool Poll(std::vector<std::string>& changed);
+
+    // False when falling back to polling modification times
+    bool IsNative() const { return native; }
+
+    static std::string NormalizePath(const std::string& filePath);
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 1024;   // Power of two
+
+    // Written by the watcher thread only; read by Poll only
+    std::array<std::string, QUEUE_CAPACITY> queue;
+    std::atomic<size_t> queueHead;   // Next slot to read
+    std::atomic<size_t> queueTail;   // Next slot to write
+    std::atomic<bool> queueOverflowed;
+
+    std::thread thread;
+    std::atomic<bool> running;
+    bool native;
+
+    std::mutex watchMutex;
+    std::unordered_set<std::string> files;
+    std::unordered_map<std::string, std::filesystem::file_time_type> modifiedTimes;   // Polling fallback
+#ifdef __linux__
+    int inotifyFd;
+    int wakeFd;
+    std::unordered_map<int, std::string> directories;   // Watch descriptor to directory
+    std::unordered_set<std::string> watchedDirectories;
+
+    void RunInotify();
+#endif
+    void RunPolling();
+    void Push(const std::string& path);
+};
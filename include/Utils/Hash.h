@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a. Stable across runs, so it keys on-disk caches as well as
+// hash maps; not meant to resist deliberate collisions.
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+// Hashes size bytes, continuing from hash
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Row-major grid of unscaled terrain heights. GL-free, so synthesis can run
+// on worker threads and in tools and benchmarks.
+//
+// Samples either live in an owned buffer or are a read-only view into
+// shared storage (a memory-mapped height field file). The first write
+// through a mutable accessor copies a view into an owned buffer.
+class HeightField {
+public:
+    // Procedural shapes, each with a fine noise layer picked by the seed
+    enum class Shape {
+        FLAT,
+        HILLS,    // Two octaves of sine ridges
+        PEAK,     // One central mountain
+        VALLEY    // Central basin with raised edges
+    };
+
+    HeightField();
+    HeightField(int width, int height);
+
+    void Resize(int width, int height);
+    // Views width x height samples owned by storage, without copying
+    void SetView(int width, int height, const float* samples, std::shared_ptr<const void> storage);
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    bool IsEmpty() const { return width == 0 || height == 0; }
+    bool IsView() const { return view != nullptr; }
+
+    float* GetData() { Detach(); return samples.data(); }
+    const float* GetData() const { return view ? view : samples.data(); }
+    float* GetRow(int z) { return GetData() + static_cast<size_t>(z) * width; }
+    const float* GetRow(int z) const { return GetData() + static_cast<size_t>(z) * width; }
+    float Get(int x, int z) const { return GetData()[static_cast<size_t>(z) * width + x]; }
+    void Set(int x, int z, float value) { GetData()[static_cast<size_t>(z) * width + x] = value; }
+
+    // Fills every sample, rows split across threads. The noise is a hash of
+    // (x, z, seed), so the result does not depend on the thread count.
+    void Generate(Shape shape, uint32_t seed);
+    // 3x3 box blur of the interior as two 1D passes; border samples keep
+    // their values
+    void Smooth();
+
+private:
+    int width;
+    int height;
+    std::vector<float> samples;
+    const float* view;
+    std::shared_ptr<const void> storage;
+
+    // Copies a view into the owned buffer
+    void Detach();
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "HeightField.h"
+
+// Versioned binary height field (.hfld), little-endian:
+//
+//   header    magic "HFLD", version, dimensions, sample format, terrain size,
+//             height scale and offset, source key, section offsets
+//   samples   width x height, row-major, float32 or float16
+//   normals   optional; width x height world-space normals (3 x float32) for
+//             the stored size and height scale
+//
+// Sections start on 64-byte boundaries, so float32 samples are used straight
+// out of the memory-mapped file without a copy.
+class HeightFieldFile {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    enum class SampleFormat : uint32_t {
+        FLOAT32 = 0,
+        FLOAT16 = 1
+    };
+
+    struct Metadata {
+        glm::vec2 size = glm::vec2(0.0f);   // World units
+        float heightScale = 1.0f;
+        float heightOffset = 0.0f;
+        // Identifies generated content (caches); 0 for authored files
+        uint64_t sourceKey = 0;
+    };
+
+    // By extension
+    static bool IsHeightFieldFile(const std::string& filePath);
+
+    // Writes to a temporary file and renames it into place. Normals may be
+    // empty; otherwise there must be one per sample.
+    static bool Write(const std::string& filePath, const HeightField& field, const Metadata& metadata,
+                      SampleFormat format, const std::vector<glm::vec3>& normals);
+
+    // float32 samples become a view into the mapped file, which stays
+    // mapped for as long as the field refers to it; float16 samples are
+    // decoded. normals is left empty when the file has none.
+    static bool Read(const std::string& filePath, HeightField& field, Metadata& metadata,
+                     std::vector<glm::vec3>& normals);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// GPU block compression; every format encodes 4x4 texel blocks
+enum class BlockFormat {
+    NONE,
+    BC1,   // RGB(A), 8 bytes per block
+    BC3,   // RGBA, 16 bytes
+    BC4,   // R, 8 bytes
+    BC5,   // RG, 16 bytes (normal maps)
+    BC7    // RGBA, 16 bytes
+};
+
+// 8-bit or block-compressed image with its mip chain. Rows are tightly
+// packed, bottom row first (OpenGL texture order); a compressed row is a
+// row of blocks.
+struct Image {
+    struct Level {
+        int width;
+        int height;
+        size_t offset;   // Into pixels
+        size_t size;
+    };
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;   // 1, 2 or 4 (RGB is expanded to RGBA)
+    BlockFormat blockFormat = BlockFormat::NONE;
+    bool srgb = false;   // Set by containers that say so; plain images follow the texture type
+    std::vector<unsigned char> pixels;
+    std::vector<Level> levels;   // levels[0] is the full image
+
+    bool IsCompressed() const { return blockFormat != BlockFormat::NONE; }
+    size_t GetRowBytes(int level) const {
+        if (IsCompressed()) {
+            return static_cast<size_t>((levels[level].width + 3) / 4) * GetBlockBytes(blockFormat);
+        }
+        return static_cast<size_t>(levels[level].width) * channels;
+    }
+    int GetRowCount(int level) const {
+        return IsCompressed() ? (levels[level].height + 3) / 4 : levels[level].height;
+    }
+
+    static int GetBlockBytes(BlockFormat format) {
+        return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+    }
+};
+
+// CPU image decoding; thread-safe, so it runs on texture streaming workers.
+// Binary PPM/PGM and TGA are decoded natively; PNG, JPEG and the other
+// formats stb_image handles are available when stb_image.h is on the
+// include path. KTX2 and DDS containers are read by TextureContainer and
+// keep their block compression and mip chain.
+class ImageLoader {
+public:
+    static bool Load(const std::string& filePath, Image& image, std::string& error);
+
+    // Appends box-filtered levels down to 1x1 after levels[0]; compressed
+    // images keep the levels they were stored with
+    static void GenerateMipChain(Image& image);
+
+    // Reverses the row order of every level. BC1-BC5 blocks are flipped in
+    // place (exact for heights that are a multiple of 4); BC7 partitions
+    // cannot be, so BC7 returns false unchanged.
+    static bool FlipVertical(Image& image);
+
+    static bool IsSupported(const std::string& filePath);
+
+private:
+    static bool LoadPNM(const std::vector<unsigned char>& data, Image& image, std::string& error);
+    static bool LoadTGA(const std::vector<unsigned char>& data, Image& image, std::string& error);
+    static bool LoadWithStb(const std::vector<unsigned char>& data, Image& image, std::string& error);
+    static void ExpandRGB(Image& image);
+    static void FlipBlock(unsigned char* block, BlockFormat format, int rows);
+};
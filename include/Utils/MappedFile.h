@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. On POSIX systems the file is mmap'd, so
+// pages are read on first touch and shared with the OS page cache; elsewhere
+// it is read into memory.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& filePath);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    // False when the fallback read the file into memory
+    bool IsMapped() const { return mapped; }
+    const unsigned char* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+
+private:
+    const unsigned char* data;
+    size_t size;
+    bool mapped;
+    std::vector<unsigned char> buffer;
+};
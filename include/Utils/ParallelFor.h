@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Runs fn(begin, end) over contiguous bands of [0, count), one band per
+// hardware thread; the calling thread takes the first band. Bands are at
+// least minBand long, so small jobs stay on the calling thread.
+template <typename Fn>
+void ParallelFor(int count, int minBand, Fn&& fn) {
+    if (count <= 0) {
+        return;
+    }
+    int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int bands = std::clamp(count / std::max(minBand, 1), 1, hardware);
+    if (bands == 1) {
+        fn(0, count);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(bands - 1);
+    for (int band = 1; band < bands; ++band) {
+        int begin = static_cast<int>(static_cast<long long>(count) * band / bands);
+        int end = static_cast<int>(static_cast<long long>(count) * (band + 1) / bands);
+        threads.emplace_back([&fn, begin, end]() { fn(begin, end); });
+    }
+    fn(0, static_cast<int>(count / bands));
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
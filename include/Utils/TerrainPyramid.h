@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "HeightField.h"
+#include "HeightFieldFile.h"
+
+// On-disk tiled height pyramid (.htp) for terrain that is streamed rather
+// than held in memory. Tiles match the landscape's quadtree nodes: the tile
+// at (level, x, z) holds the (patchSize + 1)^2 samples of that node at a
+// stride of 2^level, plus a one-sample apron on every side for normals, so
+// a tile is all a chunk needs. Samples past the far edges are clamped.
+//
+// Layout, little-endian: header, per-node (min, max) height bounds for every
+// level, then every tile in level order (finest first), row-major within a
+// level. Bounds are small and read on Open; tiles are read on demand.
+class TerrainPyramid {
+public:
+    static constexpr uint32_t VERSION = 1;
+    // Patch size of the pyramids Landscape streams (its quadtree node size)
+    static constexpr int PATCH_SIZE = 32;
+
+    TerrainPyramid();
+
+    // Writes the pyramid for field, which must be square. A memory-mapped
+    // .hfld view works, so the source does not need to fit in memory.
+    static bool Write(const std::string& filePath, const HeightField& field, const HeightFieldFile::Metadata& metadata,
+                      int patchSize);
+
+    // Unscaled (min, max) height per node, one grid per level up to the
+    // single root node. Nodes include the samples on their far edges.
+    static std::vector<std::vector<glm::vec2>> ComputeBounds(const HeightField& field, int patchSize);
+    // Recomputes, after an edit, the bounds of every node holding a sample
+    // in [first, last] (inclusive sample coordinates)
+    static void UpdateBounds(const HeightField& field, int patchSize, const glm::ivec2& first, const glm::ivec2& last,
+                             std::vector<std::vector<glm::vec2>>& levels);
+
+    // Copies one tile (with apron) out of an in-memory field
+    static void ExtractTile(const HeightField& field, int patchSize, int level, int x, int z, float* tile);
+
+    // Reads the header and bounds only
+    bool Open(const std::string& filePath);
+    bool IsOpen() const { return !filePath.empty(); }
+    const std::string& GetFilePath() const { return filePath; }
+
+    int GetResolution() const { return resolution; }
+    int GetPatchSize() const { return patchSize; }
+    int GetRootLevel() const { return static_cast<int>(bounds.size()) - 1; }
+    int GetTileSide() const { return patchSize + 3; }
+    size_t GetTileBytes() const { return static_cast<size_t>(GetTileSide()) * GetTileSide() * sizeof(float); }
+    int GetNodeCount(int level) const;
+    const HeightFieldFile::Metadata& GetMetadata() const { return metadata; }
+    const std::vector<std::vector<glm::vec2>>& GetBounds() const { return bounds; }
+
+    // Thread-safe given one stream per thread (opened on GetFilePath)
+    bool ReadTile(std::ifstream& file, int level, int x, int z, float* tile) const;
+
+private:
+    std::string filePath;
+    int resolution;
+    int patchSize;
+    HeightFieldFile::Metadata metadata;
+    std::vector<std::vector<glm::vec2>> bounds;
+    // Byte offset of each level's first tile
+    std::vector<uint64_t> levelOffsets;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ImageLoader.h"
+
+// KTX2 and DDS texture containers: 2D images with their mip chain, either
+// block-compressed (BC1/BC3/BC4/BC5/BC7) or 8-bit R/RG/RGBA. Read produces
+// an Image in OpenGL row order; both containers store the top row first
+// unless a KTX2 file says otherwise (KTXorientation), so rows are flipped
+// on load. BC7 blocks cannot be flipped, so top-down BC7 files load upside
+// down with a warning; texcompress writes BC7 KTX2 bottom-up to avoid it.
+class TextureContainer {
+public:
+    static bool ReadKTX2(const std::vector<unsigned char>& data, Image& image, std::string& error);
+    static bool ReadDDS(const std::vector<unsigned char>& data, Image& image, std::string& error);
+
+    // Rows are written as stored. KTX2 marks them bottom-up; DDS has no
+    // orientation flag, so the caller flips the image first.
+    static bool WriteKTX2(const std::string& filePath, const Image& image, std::string& error);
+    static bool WriteDDS(const std::string& filePath, const Image& image, std::string& error);
+
+private:
+    struct FormatInfo {
+        uint32_t vkFormat;
+        uint32_t dxgiFormat;
+        BlockFormat blockFormat;
+        int channels;
+        bool srgb;
+    };
+    static const FormatInfo FORMATS[];
+
+    static const FormatInfo* FindVkFormat(uint32_t vkFormat);
+    static const FormatInfo* FindDxgiFormat(uint32_t dxgiFormat);
+    static const FormatInfo* FindImageFormat(const Image& image);
+    // Level sizes from the dimensions, tightly packed level 0 first. Caps
+    // levelCount at the full chain and returns the total size; pixels are
+    // left for the caller to allocate once the data is known to fit.
+    static size_t LayoutLevels(Image& image, int levelCount);
+    static std::vector<uint32_t> BuildDataFormatDescriptor(const FormatInfo& format);
+};
@@ -1,20 +1,27 @@
 #version 430 core
 
+// Variant defines (see Engine/ShaderVariants.h): SHADOWS, NORMAL_MAP, UNLIT,
+// and LIGHT_COUNT, the compile-time bound of the light loop
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT 64
+#endif
+
 in VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
-    vec4 FragPosLightSpace;
 } fs_in;
 
+// x = efficiency, y = temperature, z = dirt level, w = selected
+flat in vec4 InstanceState;
+
+// Index into DrawBlock for this draw's material
+flat in int DrawID;
+
 out vec4 FragColor;
 
-// Material properties
+// Material textures; the scalar factors come from DrawBlock
 struct Material {
-    vec3 albedo;
-    float metallic;
-    float roughness;
-    float ao;
     sampler2D albedoMap;
     sampler2D normalMap;
     sampler2D metallicMap;
@@ -22,36 +29,62 @@ struct Material {
     sampler2D aoMap;
 };
 
-// Light properties
-struct Light {
-    int type;
-    vec3 position;
-    vec3 direction;
-    vec3 color;
-    float intensity;
-    float ambient;
-    float diffuse;
-    float specular;
-    float constant;
-    float linear;
-    float quadratic;
-    float cutOff;
-    float outerCutOff;
+// Light properties (std140, mirrors GPULight in Engine/Light.h)
+struct LightData {
+    vec4 positionType;     // xyz = position, w = type
+    vec4 direction;        // xyz = direction
+    vec4 colorIntensity;   // rgb = color, a = intensity
+    vec4 attenuation;      // x = constant, y = linear, z = quadratic
+    vec4 spot;             // x = cos(cutOff), y = cos(outerCutOff)
+};
+
+#define MAX_LIGHTS 64
+
+// Owned by the Renderer, uploaded only when a light changes
+layout(std140, binding = 0) uniform LightBlock {
+    vec4 ambientLight;
+    ivec4 lightCount;
+    LightData lights[MAX_LIGHTS];
+};
+
+// Per-draw data (std430, mirrors GPUDrawData in Engine/RenderQueue.h)
+struct DrawData {
+    mat4 model;
+    vec4 albedoMetallic;   // rgb = albedo, a = metallic
+    vec4 roughnessAo;      // x = roughness, y = ao
+};
+
+layout(std430, binding = 1) readonly buffer DrawBlock {
+    DrawData draws[];
+};
+
+// Per-frame data (std140, mirrors GPUFrameData in Engine/Renderer.h)
+#define MAX_CASCADES 4
+layout(std140, binding = 2) uniform FrameBlock {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+    vec4 shadowLightDirection;
+    vec4 cascadeSplits;
+    ivec4 cascadeCount;
+    mat4 lightSpaceMatrices[MAX_CASCADES];
 };
 
 uniform Material material;
-uniform Light lights[16];
-uniform int numLights;
-uniform vec3 viewPos;
-uniform vec3 ambientLight;
-uniform sampler2D shadowMap;
+
+// Cascaded shadow map, one layer per cascade (see Renderer::UpdateCascades)
+uniform sampler2DArrayShadow shadowMap;
 
 // Constants
 const float PI = 3.14159265359;
 
 // PBR functions
+#ifdef NORMAL_MAP
 vec3 getNormalFromMap() {
-    vec3 tangentNormal = texture(material.normalMap, fs_in.TexCoords).xyz * 2.0 - 1.0;
+    // Z is rebuilt from X/Y, so two-channel (BC5) maps work as well
+    vec3 tangentNormal;
+    tangentNormal.xy = texture(material.normalMap, fs_in.TexCoords).xy * 2.0 - 1.0;
+    tangentNormal.z = sqrt(max(1.0 - dot(tangentNormal.xy, tangentNormal.xy), 0.0));
     
     vec3 Q1  = dFdx(fs_in.FragPos);
     vec3 Q2  = dFdy(fs_in.FragPos);
@@ -65,6 +98,7 @@ vec3 getNormalFromMap() {
     
     return normalize(TBN * tangentNormal);
 }
+#endif
 
 float DistributionGGX(vec3 N, vec3 H, float roughness) {
     float a = roughness*roughness;
@@ -102,44 +136,67 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0) {
     return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
 }
 
-float ShadowCalculation(vec4 fragPosLightSpace) {
-    // Perspective divide
-    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+#ifdef SHADOWS
+float ShadowCalculation(vec3 fragPos, vec3 N) {
+    int cascades = cascadeCount.x;
+    if (cascades == 0) {
+        return 0.0;
+    }
     
-    // Transform to [0,1] range
-    projCoords = projCoords * 0.5 + 0.5;
+    // Pick the first cascade whose slice contains the fragment
+    float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+    int cascade = cascades - 1;
+    for (int i = 0; i < cascades; ++i) {
+        if (viewDepth < cascadeSplits[i]) {
+            cascade = i;
+            break;
+        }
+    }
+    if (viewDepth > cascadeSplits[cascades - 1]) {
+        return 0.0;
+    }
     
-    // Get closest depth value from light's perspective
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
+    vec4 fragPosLightSpace = lightSpaceMatrices[cascade] * vec4(fragPos, 1.0);
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+    projCoords = projCoords * 0.5 + 0.5;
     
-    // Get depth of current fragment from light's perspective
-    float currentDepth = projCoords.z;
+    // Slope-scaled bias, grown with the cascade's texel footprint
+    vec3 L = normalize(-shadowLightDirection.xyz);
+    float bias = max(0.002 * (1.0 - dot(N, L)), 0.0005) * float(cascade + 1);
+    float currentDepth = clamp(projCoords.z - bias, 0.0, 1.0);
     
-    // Check whether current frag pos is in shadow
-    float bias = 0.005;
-    float shadow = currentDepth - bias > closestDepth ? 1.0 : 0.0;
+    // 3x3 PCF on top of the hardware depth comparison
+    float lit = 0.0;
+    for (int x = -1; x <= 1; ++x) {
+        for (int y = -1; y <= 1; ++y) {
+            lit += textureOffset(shadowMap, vec4(projCoords.xy, float(cascade), currentDepth), ivec2(x, y));
+        }
+    }
     
-    return shadow;
+    return 1.0 - lit / 9.0;
 }
+#endif
 
-vec3 calculateLighting(Light light, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, vec3 F0) {
+vec3 calculateLighting(LightData light, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, vec3 F0) {
+    int type = int(light.positionType.w);
+    vec3 position = light.positionType.xyz;
     vec3 L;
     float attenuation = 1.0;
     
-    if (light.type == 0) { // Directional light
-        L = normalize(-light.direction);
-    } else if (light.type == 1) { // Point light
-        L = normalize(light.position - fs_in.FragPos);
-        float distance = length(light.position - fs_in.FragPos);
-        attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * distance * distance);
-    } else if (light.type == 2) { // Spot light
-        L = normalize(light.position - fs_in.FragPos);
-        float distance = length(light.position - fs_in.FragPos);
-        attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+    if (type == 0) { // Directional light
+        L = normalize(-light.direction.xyz);
+    } else if (type == 1) { // Point light
+        L = normalize(position - fs_in.FragPos);
+        float distance = length(position - fs_in.FragPos);
+        attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * distance * distance);
+    } else if (type == 2) { // Spot light
+        L = normalize(position - fs_in.FragPos);
+        float distance = length(position - fs_in.FragPos);
+        attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * distance * distance);
         
-        float theta = dot(L, normalize(-light.direction));
-        float epsilon = light.cutOff - light.outerCutOff;
-        float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+        float theta = dot(L, normalize(-light.direction.xyz));
+        float epsilon = light.spot.x - light.spot.y;
+        float intensity = clamp((theta - light.spot.y) / epsilon, 0.0, 1.0);
         attenuation *= intensity;
     }
     
@@ -159,21 +216,39 @@ vec3 calculateLighting(Light light, vec3 N, vec3 V, vec3 albedo, float metallic,
     vec3 kD = vec3(1.0) - kS;
     kD *= 1.0 - metallic;
     
-    vec3 Lo = (kD * albedo / PI + specular) * light.color * light.intensity * NdotL * attenuation;
+    vec3 Lo = (kD * albedo / PI + specular) * light.colorIntensity.rgb * light.colorIntensity.a * NdotL * attenuation;
     
     return Lo;
 }
 
 void main() {
     // Get material properties
-    vec3 albedo = texture(material.albedoMap, fs_in.TexCoords).rgb * material.albedo;
-    float metallic = texture(material.metallicMap, fs_in.TexCoords).r * material.metallic;
-    float roughness = texture(material.roughnessMap, fs_in.TexCoords).r * material.roughness;
-    float ao = texture(material.aoMap, fs_in.TexCoords).r * material.ao;
+    vec3 baseAlbedo = draws[DrawID].albedoMetallic.rgb;
+    float baseMetallic = draws[DrawID].albedoMetallic.a;
+    float baseRoughness = draws[DrawID].roughnessAo.x;
+    float baseAo = draws[DrawID].roughnessAo.y;
+    
+    vec3 albedo = texture(material.albedoMap, fs_in.TexCoords).rgb * baseAlbedo;
+    float metallic = texture(material.metallicMap, fs_in.TexCoords).r * baseMetallic;
+    float roughness = texture(material.roughnessMap, fs_in.TexCoords).r * baseRoughness;
+    float ao = texture(material.aoMap, fs_in.TexCoords).r * baseAo;
+    
+    // Instanced panels darken with dirt and are tinted when selected
+    albedo *= 1.0 - 0.6 * InstanceState.z;
+    albedo = mix(albedo, vec3(1.0, 0.8, 0.2), 0.5 * InstanceState.w);
+    
+#ifdef UNLIT
+    FragColor = vec4(pow(albedo, vec3(1.0/2.2)), 1.0);
+    return;
+#endif
     
     // Get normal
+#ifdef NORMAL_MAP
     vec3 N = getNormalFromMap();
-    vec3 V = normalize(viewPos - fs_in.FragPos);
+#else
+    vec3 N = normalize(fs_in.Normal);
+#endif
+    vec3 V = normalize(viewPos.xyz - fs_in.FragPos);
     
     // Calculate reflectance at normal incidence
     vec3 F0 = vec3(0.04);
@@ -181,15 +256,20 @@ void main() {
     
     // Calculate lighting
     vec3 Lo = vec3(0.0);
+    int numLights = min(lightCount.x, LIGHT_COUNT);
     for (int i = 0; i < numLights; i++) {
         Lo += calculateLighting(lights[i], N, V, albedo, metallic, roughness, F0);
     }
     
     // Ambient lighting
-    vec3 ambient = ambientLight * albedo * ao;
+    vec3 ambient = ambientLight.rgb * albedo * ao;
     
     // Calculate shadow
-    float shadow = ShadowCalculation(fs_in.FragPosLightSpace);
+#ifdef SHADOWS
+    float shadow = ShadowCalculation(fs_in.FragPos, N);
+#else
+    float shadow = 0.0;
+#endif
     
     // Final color
     vec3 color = ambient + Lo * (1.0 - shadow);
@@ -4,8 +4,84 @@ in vec3 TexCoords;
 
 out vec4 FragColor;
 
-uniform samplerCube skybox;
+// Atmosphere LUTs (see Engine/Atmosphere.h for the parameterisation)
+layout(binding = 0) uniform sampler2D transmittanceLut;
+layout(binding = 1) uniform sampler3D skyLut;
+
+uniform vec3 sunDirection;
+uniform float sunIntensity;
+uniform float cloudiness;
+uniform vec3 skyColor;
+uniform vec3 horizonColor;
+uniform vec3 groundColor;
+uniform bool atmosphereReady;
+
+const float PI = 3.14159265359;
+// Keep in sync with Atmosphere.cpp / Atmosphere.h
+const float MIN_SUN_ELEVATION = -0.35;
+const float OBSERVER_HEIGHT = 0.2;
+const float ATMOSPHERE_THICKNESS = 100.0;
+const float SUN_ANGULAR_RADIUS = 0.0047;
+const float EXPOSURE = 1.0;
+
+// LUT texel i stores the parameter i / (N - 1)
+vec3 texelCenters(vec3 uvw, vec3 size) {
+    return 0.5 / size + uvw * (1.0 - 1.0 / size);
+}
+
+vec3 sampleSky(vec3 view, vec3 sun) {
+    float viewElevation = asin(clamp(view.y, -1.0, 1.0));
+    float sunElevation = asin(clamp(sun.y, -1.0, 1.0));
+
+    vec2 viewFlat = view.xz;
+    vec2 sunFlat = sun.xz;
+    float cosAzimuth = 1.0;
+    if (dot(viewFlat, viewFlat) > 1e-8 && dot(sunFlat, sunFlat) > 1e-8) {
+        cosAzimuth = dot(normalize(viewFlat), normalize(sunFlat));
+    }
+
+    vec3 uvw;
+    uvw.x = acos(clamp(cosAzimuth, -1.0, 1.0)) / PI;
+    uvw.y = 0.5 + 0.5 * sign(viewElevation) * sqrt(abs(viewElevation) / (0.5 * PI));
+    uvw.z = clamp((sunElevation - MIN_SUN_ELEVATION) / (0.5 * PI - MIN_SUN_ELEVATION), 0.0, 1.0);
+    return texture(skyLut, texelCenters(uvw, vec3(textureSize(skyLut, 0)))).rgb;
+}
+
+vec3 sunTransmittance(float cosZenith) {
+    // The LUT stores altitude h = H * v^2 along v, so the row is v = sqrt(h / H)
+    vec2 uv = vec2(cosZenith * 0.5 + 0.5, sqrt(OBSERVER_HEIGHT / ATMOSPHERE_THICKNESS));
+    vec2 size = vec2(textureSize(transmittanceLut, 0));
+    return texture(transmittanceLut, 0.5 / size + uv * (1.0 - 1.0 / size)).rgb;
+}
 
 void main() {
-    FragColor = texture(skybox, TexCoords);
+    vec3 view = normalize(TexCoords);
+    vec3 sun = normalize(sunDirection);
+
+    vec3 color;
+    if (atmosphereReady) {
+        color = sampleSky(view, sun) * sunIntensity;
+
+        // Sun disk, reddened by the air in front of it
+        float cosToSun = dot(view, sun);
+        float disk = smoothstep(cos(SUN_ANGULAR_RADIUS * 1.5), cos(SUN_ANGULAR_RADIUS), cosToSun);
+        color += disk * sunTransmittance(sun.y) * sunIntensity * (1.0 - cloudiness);
+
+        // Overcast: a flat grey layer lit by however much sun gets through
+        float daylight = clamp(sun.y * 4.0 + 0.3, 0.0, 1.0);
+        vec3 overcast = mix(horizonColor, skyColor, 0.3) * daylight;
+        color = mix(color, overcast, cloudiness * step(0.0, view.y));
+        // Faint airglow so the night sky is not pure black
+        color += skyColor * 0.02;
+        color *= EXPOSURE;
+
+        // Same tone mapping and gamma as the lit geometry
+        color = color / (color + vec3(1.0));
+        color = pow(color, vec3(1.0 / 2.2));
+    } else {
+        // Gradient until the LUTs have been built
+        color = view.y >= 0.0 ? mix(horizonColor, skyColor, sqrt(view.y)) : groundColor;
+    }
+
+    FragColor = vec4(color, 1.0);
 }
@@ -1,26 +1,68 @@
 #version 430 core
 
+// Variant defines (see Engine/ShaderVariants.h): INSTANCING
+
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+#ifdef INSTANCING
+layout (location = 3) in mat4 aInstanceTransform;
+layout (location = 7) in vec4 aInstanceState;
+#endif
+
+// Arena pages feed this from a per-instance array (indirect draws); other
+// meshes get it as the generic attribute value (see Mesh::DrawBound)
+layout (location = 8) in uint aDrawID;
 
 out VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
-    vec4 FragPosLightSpace;
 } vs_out;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat4 lightSpaceMatrix;
+// x = efficiency, y = temperature, z = dirt level, w = selected;
+// neutral for non-instanced draws
+flat out vec4 InstanceState;
+
+// Index into DrawBlock, for the material in main.frag
+flat out int DrawID;
+
+// Per-draw data (std430, mirrors GPUDrawData in Engine/RenderQueue.h)
+struct DrawData {
+    mat4 model;
+    vec4 albedoMetallic;   // rgb = albedo, a = metallic
+    vec4 roughnessAo;      // x = roughness, y = ao
+};
+
+layout(std430, binding = 1) readonly buffer DrawBlock {
+    DrawData draws[];
+};
+
+// Per-frame data (std140, mirrors GPUFrameData in Engine/Renderer.h)
+#define MAX_CASCADES 4
+layout(std140, binding = 2) uniform FrameBlock {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+    vec4 shadowLightDirection;
+    vec4 cascadeSplits;
+    ivec4 cascadeCount;
+    mat4 lightSpaceMatrices[MAX_CASCADES];
+};
 
 void main() {
+#ifdef INSTANCING
+    mat4 model = draws[aDrawID].model * aInstanceTransform;
+    InstanceState = aInstanceState;
+#else
+    mat4 model = draws[aDrawID].model;
+    InstanceState = vec4(1.0, 25.0, 0.0, 0.0);
+#endif
+    
     vs_out.FragPos = vec3(model * vec4(aPos, 1.0));
     vs_out.Normal = transpose(inverse(mat3(model))) * aNormal;
     vs_out.TexCoords = aTexCoords;
-    vs_out.FragPosLightSpace = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
+    DrawID = int(aDrawID);
     
     gl_Position = projection * view * vec4(vs_out.FragPos, 1.0);
 }
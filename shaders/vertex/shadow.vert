@@ -1,12 +1,31 @@
 #version 430 core
 
+// Variant defines (see Engine/ShaderVariants.h): INSTANCING
+
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+#ifdef INSTANCING
+layout (location = 3) in mat4 aInstanceTransform;
+#endif
+layout (location = 8) in uint aDrawID;
+
+struct DrawData {
+    mat4 model;
+    vec4 albedoMetallic;
+    vec4 roughnessAo;
+};
+
+layout(std430, binding = 1) readonly buffer DrawBlock {
+    DrawData draws[];
+};
 
 uniform mat4 lightSpaceMatrix;
-uniform mat4 model;
 
 void main() {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+#ifdef INSTANCING
+    gl_Position = lightSpaceMatrix * draws[aDrawID].model * aInstanceTransform * vec4(aPos, 1.0);
+#else
+    gl_Position = lightSpaceMatrix * draws[aDrawID].model * vec4(aPos, 1.0);
+#endif
 }
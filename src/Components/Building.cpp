@@ -2,6 +2,7 @@
 #include "Engine/Model.h"
 #include "Engine/Mesh.h"
 #include "Engine/Material.h"
+#include "Engine/TraceRecorder.h"
 #include <GL/glew.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
@@ -35,6 +36,7 @@ void Building::SetPosition(const glm::vec3& pos) {
 }
 
 void Building::GenerateGeometry() {
+    TRACE_SCOPE("Building::GenerateGeometry");
     // Create building geometry
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
@@ -92,6 +94,7 @@ void Building::GenerateGeometry() {
     model->AddMesh(mesh);
     model->SetPosition(position);
     model->SetMaterial(material);
+    model->SetStatic(true);
 }
 
 void Building::AddWindows(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
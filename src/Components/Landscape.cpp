@@ -2,244 +2,413 @@
 #include "Engine/Model.h"
 #include "Engine/Mesh.h"
 #include "Engine/Material.h"
+#include "Engine/Profiler.h"
+#include "Engine/Scene.h"
+#include "Engine/TerrainTileCache.h"
+#include "Engine/TraceRecorder.h"
+#include "Utils/FileUtils.h"
+#include "Utils/Hash.h"
+#include "Utils/ImageLoader.h"
 #include "Utils/MathUtils.h"
+#include "Utils/ParallelFor.h"
+#include "Utils/TerrainPyramid.h"
 #include <GL/glew.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-#include <random>
+#include <limits>
+#include <sstream>
 
-Landscape::Landscape(TerrainType type, const glm::vec2& size, int resolution)
-    : terrainType(type), size(size), resolution(resolution),
-      heightScale(50.0f), model(nullptr) {
+namespace {
+    // Split a node while the camera is closer than this many node widths
+    const float DEFAULT_LOD_DISTANCE = 1.5f;
+    // New chunk meshes per UpdateChunks; a node stays coarse until all four
+    // children fit in the budget, so the surface never has holes
+    const int MAX_CHUNK_BUILDS_PER_UPDATE = 16;
+    // Chunks kept after leaving the selection, so moving back is free
+    const size_t MAX_CACHED_CHUNKS = 64;
+    // Streamed children are read once the camera is this much nearer than
+    // the split distance
+    const float PREFETCH_DISTANCE_SCALE = 1.5f;
+
+    // Chunk vertex layout: the grid row by row, then one skirt vertex per
+    // border vertex
+    const int CHUNK_SIDE = Landscape::PATCH_SIZE + 1;
+    const int SKIRT_BASE = CHUNK_SIDE * CHUNK_SIDE;
+    const int SKIRT_VERTICES = 4 * Landscape::PATCH_SIZE;
+
+    // Batch height queries are interpolated this many at a time, and bands
+    // of fewer blocks are not worth a thread
+    const int QUERY_BLOCK = 256;
+    const int MIN_QUERY_BLOCKS_PER_BAND = 16;
+
+    // Bump when HeightField synthesis changes, so cached terrain is regenerated
+    const uint32_t GENERATOR_VERSION = 1;
+    const char* TERRAIN_TYPE_NAMES[] = { "flat", "hilly", "mountainous", "coastal", "urban" };
+
+    // Normal at tile sample (i, j) (apron included) by central differences
+    // at the tile's own stride; spanX and spanZ are the world distances
+    // between the neighbours, zero where both clamp to the same sample
+    glm::vec3 TileNormal(const float* tile, int side, int i, int j, float spanX, float spanZ, float heightScale) {
+        float dx = spanX > 0.0f ? (tile[j * side + i + 1] - tile[j * side + i - 1]) * heightScale / spanX : 0.0f;
+        float dz = spanZ > 0.0f ? (tile[(j + 1) * side + i] - tile[(j - 1) * side + i]) * heightScale / spanZ : 0.0f;
+        return glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+    }
+
+    // Grid vertices around a chunk's border, in order
+    const std::vector<unsigned int>& ChunkBorder() {
+        static const std::vector<unsigned int> border = []() {
+            const unsigned int patch = Landscape::PATCH_SIZE;
+            std::vector<unsigned int> indices;
+            indices.reserve(SKIRT_VERTICES);
+            for (unsigned int i = 0; i < patch; ++i) indices.push_back(i);
+            for (unsigned int j = 0; j < patch; ++j) indices.push_back(j * CHUNK_SIDE + patch);
+            for (unsigned int i = patch; i > 0; --i) indices.push_back(patch * CHUNK_SIDE + i);
+            for (unsigned int j = patch; j > 0; --j) indices.push_back(j * CHUNK_SIDE);
+            return indices;
+        }();
+        return border;
+    }
+}
+
+Landscape::Landscape() : Landscape(TerrainType::FLAT, glm::vec2(100.0f, 100.0f), 64) {
+}
+
+Landscape::Landscape(TerrainType type, const glm::vec2& size, int resolution, uint32_t seed)
+    : type(type), size(size), resolution(std::max(resolution, 2)),
+      heightScale(50.0f), heightOffset(0.0f), seed(seed), cacheDirectory("terrain_cache"),
+      tileMemoryBudget(TerrainTileCache::DEFAULT_MEMORY_BUDGET), rootLevel(0),
+      lodDistance(DEFAULT_LOD_DISTANCE), updateCount(0), chunksDirty(true), refinementDeferred(false) {
     
+    ClearDirty();
+    
+    // Heights are generated by GenerateGeometry, after the caller has had a
+    // chance to set the seed and cache directory
     SetupMaterial();
-    GenerateGeometry();
 }
 
 Landscape::~Landscape() {
+    // Chunk models still in a scene stay valid; RemoveChunks takes them out
+}
+
+void Landscape::SetType(TerrainType terrainType) {
+    type = terrainType;
+    SetupMaterial();
+    GenerateGeometry();
+}
+
+void Landscape::SetSize(const glm::vec2& terrainSize) {
+    size = terrainSize;
+    CalculateNormals();
+    MarkDirty(glm::ivec2(0), glm::ivec2(resolution - 1));
+}
+
+void Landscape::SetResolution(int terrainResolution) {
+    resolution = std::max(terrainResolution, 2);
+    GenerateGeometry();
 }
 
 void Landscape::SetHeightScale(float scale) {
     heightScale = scale;
-    GenerateGeometry();
+    CalculateNormals();
+    MarkDirty(glm::ivec2(0), glm::ivec2(resolution - 1));
+}
+
+void Landscape::SetHeightOffset(float offset) {
+    heightOffset = offset;
+    MarkDirty(glm::ivec2(0), glm::ivec2(resolution - 1));
 }
 
-void Landscape::SetTerrainType(TerrainType type) {
-    terrainType = type;
+void Landscape::SetSeed(uint32_t terrainSeed) {
+    seed = terrainSeed;
     GenerateGeometry();
 }
 
+void Landscape::SetCacheDirectory(const std::string& directory) {
+    cacheDirectory = directory;
+}
+
+void Landscape::SetLODDistance(float factor) {
+    lodDistance = std::max(factor, 0.5f);
+}
+
 void Landscape::GenerateGeometry() {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
+    TRACE_SCOPE("Landscape::GenerateGeometry");
+    GenerateHeightMap();
     
-    // Generate height map
-    std::vector<std::vector<float>> heightMap = GenerateHeightMap();
-    
-    // Generate vertices
-    for (int z = 0; z < resolution; ++z) {
-        for (int x = 0; x < resolution; ++x) {
-            float xPos = (float)x / (resolution - 1) * size.x - size.x / 2;
-            float zPos = (float)z / (resolution - 1) * size.y - size.y / 2;
-            float yPos = heightMap[z][x] * heightScale;
-            
-            // Calculate normal
-            glm::vec3 normal = CalculateNormal(heightMap, x, z);
-            
-            // Texture coordinates
-            float u = (float)x / (resolution - 1);
-            float v = (float)z / (resolution - 1);
-            
-            vertices.push_back({{xPos, yPos, zPos}, normal, {u, v}});
+    // Chunks are rebuilt from the new heights on the next UpdateChunks
+    chunksDirty = true;
+}
+
+bool Landscape::LoadHeightMap(const std::string& filePath) {
+    TRACE_SCOPE("Landscape::LoadHeightMap");
+    if (HeightFieldFile::IsHeightFieldFile(filePath)) {
+        HeightField field;
+        HeightFieldFile::Metadata metadata;
+        std::vector<glm::vec3> fileNormals;
+        if (!HeightFieldFile::Read(filePath, field, metadata, fileNormals)) {
+            std::cerr << "Failed to load height map: " << filePath << std::endl;
+            return false;
         }
-    }
-    
-    // Generate indices
-    for (int z = 0; z < resolution - 1; ++z) {
-        for (int x = 0; x < resolution - 1; ++x) {
-            int topLeft = z * resolution + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = (z + 1) * resolution + x;
-            int bottomRight = bottomLeft + 1;
-            
-            // First triangle
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-            
-            // Second triangle
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
+        if (field.GetWidth() != field.GetHeight() || field.GetWidth() < 2) {
+            std::cerr << "Height map must be square: " << filePath << std::endl;
+            return false;
         }
+        
+        CloseTiles();
+        resolution = field.GetWidth();
+        if (metadata.size.x > 0.0f && metadata.size.y > 0.0f) {
+            size = metadata.size;
+        }
+        heightScale = metadata.heightScale;
+        heightOffset = metadata.heightOffset;
+        heightField = std::move(field);
+        if (!fileNormals.empty()) {
+            normals = std::move(fileNormals);
+        } else {
+            CalculateNormals();
+        }
+    } else {
+        Image image;
+        std::string error;
+        if (!ImageLoader::Load(filePath, image, error)) {
+            std::cerr << "Failed to load height map: " << filePath << " (" << error << ")" << std::endl;
+            return false;
+        }
+        if (image.IsCompressed() || image.width != image.height || image.width < 2) {
+            std::cerr << "Height map must be a square, uncompressed image: " << filePath << std::endl;
+            return false;
+        }
+        
+        // First channel, 0-255 to 0-1; image rows are stored bottom first
+        CloseTiles();
+        resolution = image.width;
+        heightField.Resize(resolution, resolution);
+        for (int z = 0; z < resolution; ++z) {
+            const unsigned char* source = &image.pixels[static_cast<size_t>(resolution - 1 - z) * resolution * image.channels];
+            float* row = heightField.GetRow(z);
+            for (int x = 0; x < resolution; ++x) {
+                row[x] = source[x * image.channels] / 255.0f;
+            }
+        }
+        CalculateNormals();
     }
     
-    // Create mesh
-    auto mesh = std::make_shared<Mesh>(vertices, indices);
-    
-    // Create model
-    model = std::make_shared<Model>();
-    model->AddMesh(mesh);
-    model->SetMaterial(material);
+    chunksDirty = true;
+    return true;
 }
 
-std::vector<std::vector<float>> Landscape::GenerateHeightMap() {
-    std::vector<std::vector<float>> heightMap(resolution, std::vector<float>(resolution));
-    
-    // Initialize random number generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+bool Landscape::SaveHeightMap(const std::string& filePath, HeightFieldFile::SampleFormat format) const {
+    HeightFieldFile::Metadata metadata;
+    metadata.size = size;
+    metadata.heightScale = heightScale;
+    metadata.heightOffset = heightOffset;
+    return HeightFieldFile::Write(filePath, heightField, metadata, format, normals);
+}
+
+void Landscape::GenerateHeightMap() {
+    TRACE_SCOPE("Landscape::GenerateHeightMap");
+    CloseTiles();
+    std::string cachePath = GetCachePath();
+    if (!cachePath.empty() && LoadCache(cachePath)) {
+        return;
+    }
     
-    // Generate base height map based on terrain type
-    switch (terrainType) {
+    HeightField::Shape shape = HeightField::Shape::FLAT;
+    switch (type) {
         case TerrainType::FLAT:
-            GenerateFlatTerrain(heightMap);
+        case TerrainType::URBAN:
+            shape = HeightField::Shape::FLAT;
             break;
         case TerrainType::HILLY:
-            GenerateHillyTerrain(heightMap, gen, dis);
+            shape = HeightField::Shape::HILLS;
             break;
         case TerrainType::MOUNTAINOUS:
-            GenerateMountainousTerrain(heightMap, gen, dis);
+            shape = HeightField::Shape::PEAK;
             break;
-        case TerrainType::VALLEY:
-            GenerateValleyTerrain(heightMap, gen, dis);
+        case TerrainType::COASTAL:
+            shape = HeightField::Shape::VALLEY;
             break;
     }
     
-    // Apply smoothing
-    SmoothHeightMap(heightMap);
+    heightField.Resize(resolution, resolution);
+    heightField.Generate(shape, seed);
+    heightField.Smooth();
+    CalculateNormals();
     
-    return heightMap;
+    if (!cachePath.empty()) {
+        HeightFieldFile::Metadata metadata;
+        metadata.size = size;
+        metadata.heightScale = heightScale;
+        metadata.heightOffset = heightOffset;
+        metadata.sourceKey = GetSourceKey();
+        HeightFieldFile::Write(cachePath, heightField, metadata, HeightFieldFile::SampleFormat::FLOAT32, normals);
+    }
 }
 
-void Landscape::GenerateFlatTerrain(std::vector<std::vector<float>>& heightMap) {
-    for (int z = 0; z < resolution; ++z) {
-        for (int x = 0; x < resolution; ++x) {
-            heightMap[z][x] = 0.0f;
-        }
+std::string Landscape::GetCachePath() const {
+    if (cacheDirectory.empty()) {
+        return "";
     }
+    std::ostringstream name;
+    name << TERRAIN_TYPE_NAMES[static_cast<int>(type)] << '-' << seed << '-' << resolution << ".hfld";
+    return FileUtils::CombinePath(cacheDirectory, name.str());
 }
 
-void Landscape::GenerateHillyTerrain(std::vector<std::vector<float>>& heightMap, 
-                                   std::mt19937& gen, std::uniform_real_distribution<float>& dis) {
-    // Generate multiple noise layers for hilly terrain
-    for (int z = 0; z < resolution; ++z) {
-        for (int x = 0; x < resolution; ++x) {
-            float height = 0.0f;
-            
-            // Large scale hills
-            float largeScale = sin(x * 0.1f) * cos(z * 0.1f) * 0.5f;
-            
-            // Medium scale variation
-            float mediumScale = sin(x * 0.3f) * cos(z * 0.3f) * 0.3f;
-            
-            // Small scale noise
-            float smallScale = dis(gen) * 0.2f;
-            
-            height = largeScale + mediumScale + smallScale;
-            heightMap[z][x] = std::max(0.0f, height);
-        }
+uint64_t Landscape::GetSourceKey() const {
+    // Everything the generated heights depend on, little-endian
+    uint32_t fields[] = { GENERATOR_VERSION, static_cast<uint32_t>(type), seed, static_cast<uint32_t>(resolution) };
+    unsigned char bytes[sizeof(fields)];
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+        bytes[i] = static_cast<unsigned char>(fields[i / 4] >> (i % 4 * 8));
     }
+    return HashBytes(bytes, sizeof(bytes));
 }
 
-void Landscape::GenerateMountainousTerrain(std::vector<std::vector<float>>& heightMap,
-                                         std::mt19937& gen, std::uniform_real_distribution<float>& dis) {
-    // Generate mountainous terrain with peaks
-    for (int z = 0; z < resolution; ++z) {
-        for (int x = 0; x < resolution; ++x) {
-            float height = 0.0f;
-            
-            // Create mountain peaks
-            float centerX = resolution / 2.0f;
-            float centerZ = resolution / 2.0f;
-            float distanceFromCenter = sqrt((x - centerX) * (x - centerX) + (z - centerZ) * (z - centerZ));
-            float maxDistance = resolution / 3.0f;
-            
-            if (distanceFromCenter < maxDistance) {
-                float peakHeight = 1.0f - (distanceFromCenter / maxDistance);
-                peakHeight = peakHeight * peakHeight; // Square for sharper peaks
-                height = peakHeight;
-            }
-            
-            // Add noise
-            height += dis(gen) * 0.1f;
-            
-            heightMap[z][x] = std::max(0.0f, height);
-        }
+bool Landscape::LoadCache(const std::string& cachePath) {
+    if (!FileUtils::FileExists(cachePath)) {
+        return false;
+    }
+    HeightField cached;
+    HeightFieldFile::Metadata metadata;
+    std::vector<glm::vec3> cachedNormals;
+    if (!HeightFieldFile::Read(cachePath, cached, metadata, cachedNormals) || metadata.sourceKey != GetSourceKey() ||
+        cached.GetWidth() != resolution || cached.GetHeight() != resolution) {
+        // Stale or damaged; regenerated and overwritten by the caller
+        return false;
     }
+    
+    // Heights stay in the mapped file; normals are only valid for the size
+    // and height scale they were computed with
+    heightField = std::move(cached);
+    if (!cachedNormals.empty() && metadata.size == size && metadata.heightScale == heightScale) {
+        normals = std::move(cachedNormals);
+    } else {
+        CalculateNormals();
+    }
+    return true;
 }
 
-void Landscape::GenerateValleyTerrain(std::vector<std::vector<float>>& heightMap,
-                                    std::mt19937& gen, std::uniform_real_distribution<float>& dis) {
-    // Generate valley terrain
-    for (int z = 0; z < resolution; ++z) {
-        for (int x = 0; x < resolution; ++x) {
-            float height = 0.0f;
-            
-            // Create valley
-            float centerX = resolution / 2.0f;
-            float centerZ = resolution / 2.0f;
-            float distanceFromCenter = sqrt((x - centerX) * (x - centerX) + (z - centerZ) * (z - centerZ));
-            float maxDistance = resolution / 4.0f;
-            
-            if (distanceFromCenter < maxDistance) {
-                float valleyDepth = (distanceFromCenter / maxDistance);
-                valleyDepth = valleyDepth * valleyDepth; // Square for deeper valleys
-                height = 1.0f - valleyDepth;
-            } else {
-                height = 0.5f; // Elevated edges
-            }
-            
-            // Add noise
-            height += dis(gen) * 0.05f;
-            
-            heightMap[z][x] = std::max(0.0f, height);
-        }
+bool Landscape::OpenTiles(const std::string& filePath) {
+    TRACE_SCOPE("Landscape::OpenTiles");
+    auto pyramid = std::make_shared<TerrainPyramid>();
+    if (!pyramid->Open(filePath)) {
+        return false;
+    }
+    if (pyramid->GetPatchSize() != PATCH_SIZE) {
+        std::cerr << "Terrain pyramid was built for " << pyramid->GetPatchSize() << "-quad patches, not "
+                  << PATCH_SIZE << ": " << filePath << std::endl;
+        return false;
+    }
+    auto cache = std::make_unique<TerrainTileCache>(pyramid);
+    if (!cache->Find(pyramid->GetRootLevel(), 0, 0)) {
+        return false;
+    }
+    cache->SetMemoryBudget(tileMemoryBudget);
+    
+    const HeightFieldFile::Metadata& metadata = pyramid->GetMetadata();
+    resolution = pyramid->GetResolution();
+    if (metadata.size.x > 0.0f && metadata.size.y > 0.0f) {
+        size = metadata.size;
     }
+    heightScale = metadata.heightScale;
+    heightOffset = metadata.heightOffset;
+    heightField = HeightField();
+    normals.clear();
+    normals.shrink_to_fit();
+    tilePyramid = pyramid;
+    tileCache = std::move(cache);
+    chunksDirty = true;
+    return true;
 }
 
-void Landscape::SmoothHeightMap(std::vector<std::vector<float>>& heightMap) {
-    std::vector<std::vector<float>> smoothed = heightMap;
-    
-    for (int z = 1; z < resolution - 1; ++z) {
-        for (int x = 1; x < resolution - 1; ++x) {
-            float sum = 0.0f;
-            int count = 0;
-            
-            // Average with neighbors
-            for (int dz = -1; dz <= 1; ++dz) {
-                for (int dx = -1; dx <= 1; ++dx) {
-                    sum += heightMap[z + dz][x + dx];
-                    count++;
-                }
-            }
-            
-            smoothed[z][x] = sum / count;
-        }
+bool Landscape::SaveTiles(const std::string& filePath) const {
+    if (IsStreaming() || heightField.IsEmpty()) {
+        std::cerr << "No in-memory height map to write: " << filePath << std::endl;
+        return false;
     }
-    
-    heightMap = smoothed;
+    HeightFieldFile::Metadata metadata;
+    metadata.size = size;
+    metadata.heightScale = heightScale;
+    metadata.heightOffset = heightOffset;
+    return TerrainPyramid::Write(filePath, heightField, metadata, PATCH_SIZE);
 }
 
-glm::vec3 Landscape::CalculateNormal(const std::vector<std::vector<float>>& heightMap, int x, int z) {
-    // Calculate normal using finite differences
-    float left = (x > 0) ? heightMap[z][x - 1] : heightMap[z][x];
-    float right = (x < resolution - 1) ? heightMap[z][x + 1] : heightMap[z][x];
-    float up = (z > 0) ? heightMap[z - 1][x] : heightMap[z][x];
-    float down = (z < resolution - 1) ? heightMap[z + 1][x] : heightMap[z][x];
-    
-    float dx = (right - left) * heightScale;
-    float dz = (down - up) * heightScale;
+void Landscape::SetTileMemoryBudget(size_t bytes) {
+    tileMemoryBudget = bytes;
+    if (tileCache) {
+        tileCache->SetMemoryBudget(bytes);
+    }
+}
+
+void Landscape::WaitForTiles() {
+    if (tileCache) {
+        tileCache->Flush();
+    }
+}
+
+void Landscape::CloseTiles() {
+    tileCache.reset();
+    tilePyramid.reset();
+}
+
+float Landscape::SampleTiles(float gx, float gz, glm::vec3* normal) const {
+    const int last = resolution - 1;
+    const int tileSide = PATCH_SIZE + 3;
+    const glm::vec2 cell = GetCellSize();
     
-    glm::vec3 normal(-dx, 2.0f, -dz);
-    return glm::normalize(normal);
+    // The pyramid's root, not rootLevel: queries may come before the first UpdateChunks
+    for (int level = 0; level <= tilePyramid->GetRootLevel(); ++level) {
+        const int stride = 1 << level;
+        const int span = PATCH_SIZE << level;
+        const int count = tilePyramid->GetNodeCount(level);
+        int x = std::min(static_cast<int>(gx) / span, count - 1);
+        int z = std::min(static_cast<int>(gz) / span, count - 1);
+        const float* tile = tileCache->Find(level, x, z);
+        if (!tile) {
+            if (level == 0) {
+                tileCache->Request(0, x, z);
+            }
+            continue;
+        }
+        
+        // Tile-local sample coordinates; the apron shifts indices by one
+        float lx = (gx - x * span) / stride;
+        float lz = (gz - z * span) / stride;
+        int i0 = std::clamp(static_cast<int>(lx), 0, PATCH_SIZE - 1);
+        int j0 = std::clamp(static_cast<int>(lz), 0, PATCH_SIZE - 1);
+        float fx = lx - i0;
+        float fz = lz - j0;
+        const float* row0 = tile + (j0 + 1) * tileSide + i0 + 1;
+        const float* row1 = row0 + tileSide;
+        float top = row0[0] + (row0[1] - row0[0]) * fx;
+        float bottom = row1[0] + (row1[1] - row1[0]) * fx;
+        
+        if (normal) {
+            auto spanAt = [&](int u) {
+                return static_cast<float>(std::clamp(u + stride, 0, last) - std::clamp(u - stride, 0, last));
+            };
+            glm::vec3 corners[4];
+            for (int corner = 0; corner < 4; ++corner) {
+                int i = i0 + (corner & 1);
+                int j = j0 + (corner >> 1);
+                corners[corner] = TileNormal(tile, tileSide, i + 1, j + 1, spanAt(x * span + i * stride) * cell.x,
+                                             spanAt(z * span + j * stride) * cell.y, heightScale);
+            }
+            *normal = glm::normalize(glm::mix(glm::mix(corners[0], corners[1], fx),
+                                              glm::mix(corners[2], corners[3], fx), fz));
+        }
+        return top + (bottom - top) * fz;
+    }
+    // Not reached: the root tile stays resident
+    return 0.0f;
 }
 
 void Landscape::SetupMaterial() {
     material = Material();
     
-    switch (terrainType) {
+    switch (type) {
         case TerrainType::FLAT:
             material.albedo = glm::vec3(0.4f, 0.6f, 0.3f); // Grass green
             material.metallic = 0.0f;
@@ -261,25 +430,623 @@ void Landscape::SetupMaterial() {
             material.ao = 1.0f;
             break;
             
-        case TerrainType::VALLEY:
-            material.albedo = glm::vec3(0.3f, 0.5f, 0.2f); // Dark green
+        case TerrainType::COASTAL:
+            material.albedo = glm::vec3(0.76f, 0.7f, 0.5f); // Sand
             material.metallic = 0.0f;
-            material.roughness = 0.8f;
+            material.roughness = 0.9f;
+            material.ao = 1.0f;
+            break;
+            
+        case TerrainType::URBAN:
+            material.albedo = glm::vec3(0.45f, 0.47f, 0.42f); // Worn grass and gravel
+            material.metallic = 0.0f;
+            material.roughness = 0.85f;
             material.ao = 1.0f;
             break;
     }
 }
 
-void Landscape::Update(float deltaTime) {
-    // Landscape-specific updates if needed
+glm::vec2 Landscape::GetCellSize() const {
+    return glm::vec2(size.x / (resolution - 1), size.y / (resolution - 1));
+}
+
+glm::vec3 Landscape::CalculateNormal(int x, int z) const {
+    // Central differences in world units, one-sided at the border
+    int left = std::max(x - 1, 0);
+    int right = std::min(x + 1, resolution - 1);
+    int up = std::max(z - 1, 0);
+    int down = std::min(z + 1, resolution - 1);
+    glm::vec2 cell = GetCellSize();
+    
+    float dx = (heightField.Get(right, z) - heightField.Get(left, z)) * heightScale / ((right - left) * cell.x);
+    float dz = (heightField.Get(x, down) - heightField.Get(x, up)) * heightScale / ((down - up) * cell.y);
+    return glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+}
+
+void Landscape::CalculateNormals() {
+    TRACE_SCOPE("Landscape::CalculateNormals");
+    if (IsStreaming()) {
+        // Chunks and queries derive normals from the tiles
+        return;
+    }
+    if (heightField.IsEmpty()) {
+        // Computed once the height map is generated or loaded
+        return;
+    }
+    normals.resize(static_cast<size_t>(resolution) * resolution);
+    ParallelFor(resolution, 64, [this](int begin, int end) {
+        for (int z = begin; z < end; ++z) {
+            for (int x = 0; x < resolution; ++x) {
+                normals[static_cast<size_t>(z) * resolution + x] = CalculateNormal(x, z);
+            }
+        }
+    });
+}
+
+void Landscape::SetHeightAt(int x, int z, float height) {
+    if (x < 0 || z < 0 || x >= resolution || z >= resolution || heightScale == 0.0f || IsStreaming() ||
+        heightField.IsEmpty()) {
+        return;
+    }
+    heightField.Set(x, z, (height - heightOffset) / heightScale);
+    
+    for (int nz = std::max(z - 1, 0); nz <= std::min(z + 1, resolution - 1); ++nz) {
+        for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, resolution - 1); ++nx) {
+            normals[static_cast<size_t>(nz) * resolution + nx] = CalculateNormal(nx, nz);
+        }
+    }
+    MarkDirty(glm::ivec2(x, z), glm::ivec2(x, z));
 }
 
-std::shared_ptr<Model> Landscape::GetModel() const {
+void Landscape::FlattenRegion(const glm::vec3& center, const glm::vec2& extent, float blend) {
+    if (heightScale == 0.0f || IsStreaming() || heightField.IsEmpty()) {
+        return;
+    }
+    TRACE_SCOPE("Landscape::FlattenRegion");
+    const glm::vec2 cell = GetCellSize();
+    const glm::vec2 half = glm::max(extent * 0.5f, glm::vec2(0.0f));
+    blend = std::max(blend, 0.0f);
+    
+    // Samples within reach of the pad and its blend margin
+    const float last = static_cast<float>(resolution - 1);
+    float minX = std::ceil((center.x - half.x - blend + size.x * 0.5f) / cell.x);
+    float maxX = std::floor((center.x + half.x + blend + size.x * 0.5f) / cell.x);
+    float minZ = std::ceil((center.z - half.y - blend + size.y * 0.5f) / cell.y);
+    float maxZ = std::floor((center.z + half.y + blend + size.y * 0.5f) / cell.y);
+    if (maxX < 0.0f || maxZ < 0.0f || minX > last || minZ > last || minX > maxX || minZ > maxZ) {
+        return;
+    }
+    glm::ivec2 first(static_cast<int>(std::max(minX, 0.0f)), static_cast<int>(std::max(minZ, 0.0f)));
+    glm::ivec2 end(static_cast<int>(std::min(maxX, last)), static_cast<int>(std::min(maxZ, last)));
+    
+    // Full weight on the pad, easing to none at the edge of the margin
+    const float target = (center.y - heightOffset) / heightScale;
+    for (int z = first.y; z <= end.y; ++z) {
+        float* row = heightField.GetRow(z);
+        float dz = std::max(std::abs(z * cell.y - size.y * 0.5f - center.z) - half.y, 0.0f);
+        for (int x = first.x; x <= end.x; ++x) {
+            float dx = std::max(std::abs(x * cell.x - size.x * 0.5f - center.x) - half.x, 0.0f);
+            float distance = std::sqrt(dx * dx + dz * dz);
+            if (distance >= blend && distance > 0.0f) {
+                continue;
+            }
+            float t = distance > 0.0f ? 1.0f - distance / blend : 1.0f;
+            row[x] += (target - row[x]) * t * t * (3.0f - 2.0f * t);
+        }
+    }
+    
+    for (int z = std::max(first.y - 1, 0); z <= std::min(end.y + 1, resolution - 1); ++z) {
+        for (int x = std::max(first.x - 1, 0); x <= std::min(end.x + 1, resolution - 1); ++x) {
+            normals[static_cast<size_t>(z) * resolution + x] = CalculateNormal(x, z);
+        }
+    }
+    MarkDirty(first, end);
+}
+
+void Landscape::MarkDirty(const glm::ivec2& first, const glm::ivec2& last) {
+    if (IsStreaming()) {
+        // Tiles of cached chunks may be gone; rebuild from what is resident
+        chunksDirty = true;
+        return;
+    }
+    dirtyMin = glm::min(dirtyMin, first);
+    dirtyMax = glm::max(dirtyMax, last);
+}
+
+void Landscape::ClearDirty() {
+    dirtyMin = glm::ivec2(std::numeric_limits<int>::max());
+    dirtyMax = glm::ivec2(-1);
+}
+
+float Landscape::GetHeightAt(int x, int z) const {
+    x = std::clamp(x, 0, resolution - 1);
+    z = std::clamp(z, 0, resolution - 1);
+    if (IsStreaming()) {
+        return SampleTiles(static_cast<float>(x), static_cast<float>(z), nullptr) * heightScale + heightOffset;
+    }
+    if (heightField.IsEmpty()) {
+        return heightOffset;
+    }
+    return heightField.Get(x, z) * heightScale + heightOffset;
+}
+
+float Landscape::GetHeightAt(const glm::vec3& position) const {
+    return InterpolateHeight(position).y;
+}
+
+void Landscape::GetHeightsAt(const glm::vec2* positions, size_t count, float* heights, glm::vec3* normalsOut) const {
+    TRACE_SCOPE("Landscape::GetHeightsAt");
+    if (IsStreaming() || heightField.IsEmpty()) {
+        // The tile cache belongs to the main thread
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 position(positions[i].x, 0.0f, positions[i].y);
+            heights[i] = GetHeightAt(position);
+            if (normalsOut) {
+                normalsOut[i] = GetTerrainNormal(position);
+            }
+        }
+        return;
+    }
+    
+    const glm::vec2 cell = GetCellSize();
+    const glm::vec2 origin = size * 0.5f;
+    const float last = static_cast<float>(resolution - 1);
+    const float* samples = heightField.GetData();
+    // Locals, so writes to heights cannot alias them and block vectorisation
+    const float scale = heightScale;
+    const float offset = heightOffset;
+    const int stride = resolution;
+    const int blocks = static_cast<int>((count + QUERY_BLOCK - 1) / QUERY_BLOCK);
+    
+    ParallelFor(blocks, MIN_QUERY_BLOCKS_PER_BAND, [&](int beginBlock, int endBlock) {
+        // Same arithmetic as InterpolateHeight, split into passes: cell and
+        // weights, corner loads, blend. The first and last are branch-free
+        // loops over plain arrays, which the compiler vectorises.
+        size_t offsets[QUERY_BLOCK];
+        float fx[QUERY_BLOCK], fz[QUERY_BLOCK];
+        float h00[QUERY_BLOCK], h01[QUERY_BLOCK], h10[QUERY_BLOCK], h11[QUERY_BLOCK];
+        
+        for (int block = beginBlock; block < endBlock; ++block) {
+            const size_t first = static_cast<size_t>(block) * QUERY_BLOCK;
+            const int n = static_cast<int>(std::min<size_t>(QUERY_BLOCK, count - first));
+            const glm::vec2* p = positions + first;
+            
+            for (int i = 0; i < n; ++i) {
+                float gx = std::clamp((p[i].x + origin.x) / cell.x, 0.0f, last);
+                float gz = std::clamp((p[i].y + origin.y) / cell.y, 0.0f, last);
+                int x0 = std::min(static_cast<int>(gx), stride - 2);
+                int z0 = std::min(static_cast<int>(gz), stride - 2);
+                fx[i] = gx - x0;
+                fz[i] = gz - z0;
+                offsets[i] = static_cast<size_t>(z0) * stride + x0;
+            }
+            for (int i = 0; i < n; ++i) {
+                const float* row0 = samples + offsets[i];
+                const float* row1 = row0 + stride;
+                h00[i] = row0[0];
+                h01[i] = row0[1];
+                h10[i] = row1[0];
+                h11[i] = row1[1];
+            }
+            float* out = heights + first;
+            for (int i = 0; i < n; ++i) {
+                float top = h00[i] + (h01[i] - h00[i]) * fx[i];
+                float bottom = h10[i] + (h11[i] - h10[i]) * fx[i];
+                out[i] = (top + (bottom - top) * fz[i]) * scale + offset;
+            }
+            
+            if (normalsOut) {
+                for (int i = 0; i < n; ++i) {
+                    const glm::vec3* row0 = &normals[offsets[i]];
+                    const glm::vec3* row1 = row0 + stride;
+                    glm::vec3 normal = glm::mix(glm::mix(row0[0], row0[1], fx[i]), glm::mix(row1[0], row1[1], fx[i]), fz[i]);
+                    normalsOut[first + i] = glm::normalize(normal);
+                }
+            }
+        }
+    });
+}
+
+glm::vec3 Landscape::InterpolateHeight(const glm::vec3& position) const {
+    // Bilinear over the cell containing the point, clamped to the terrain
+    glm::vec2 cell = GetCellSize();
+    float gx = std::clamp((position.x + size.x * 0.5f) / cell.x, 0.0f, static_cast<float>(resolution - 1));
+    float gz = std::clamp((position.z + size.y * 0.5f) / cell.y, 0.0f, static_cast<float>(resolution - 1));
+    if (IsStreaming()) {
+        return glm::vec3(position.x, SampleTiles(gx, gz, nullptr) * heightScale + heightOffset, position.z);
+    }
+    if (heightField.IsEmpty()) {
+        return glm::vec3(position.x, heightOffset, position.z);
+    }
+    int x0 = std::min(static_cast<int>(gx), resolution - 2);
+    int z0 = std::min(static_cast<int>(gz), resolution - 2);
+    float fx = gx - x0;
+    float fz = gz - z0;
+    
+    const float* row0 = heightField.GetRow(z0) + x0;
+    const float* row1 = row0 + resolution;
+    float top = row0[0] + (row0[1] - row0[0]) * fx;
+    float bottom = row1[0] + (row1[1] - row1[0]) * fx;
+    return glm::vec3(position.x, (top + (bottom - top) * fz) * heightScale + heightOffset, position.z);
+}
+
+glm::vec3 Landscape::GetTerrainNormal(const glm::vec3& position) const {
+    glm::vec2 cell = GetCellSize();
+    float gx = std::clamp((position.x + size.x * 0.5f) / cell.x, 0.0f, static_cast<float>(resolution - 1));
+    float gz = std::clamp((position.z + size.y * 0.5f) / cell.y, 0.0f, static_cast<float>(resolution - 1));
+    if (IsStreaming()) {
+        glm::vec3 normal;
+        SampleTiles(gx, gz, &normal);
+        return normal;
+    }
+    if (heightField.IsEmpty()) {
+        return glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+    int x0 = std::min(static_cast<int>(gx), resolution - 2);
+    int z0 = std::min(static_cast<int>(gz), resolution - 2);
+    float fx = gx - x0;
+    float fz = gz - z0;
+    
+    const glm::vec3* row0 = &normals[static_cast<size_t>(z0) * resolution + x0];
+    const glm::vec3* row1 = row0 + resolution;
+    glm::vec3 normal = glm::mix(glm::mix(row0[0], row0[1], fx), glm::mix(row1[0], row1[1], fx), fz);
+    return glm::normalize(normal);
+}
+
+bool Landscape::IsPointOnTerrain(const glm::vec3& point) const {
+    return std::abs(point.x) <= size.x * 0.5f && std::abs(point.z) <= size.y * 0.5f;
+}
+
+uint64_t Landscape::GetChunkKey(int level, int x, int z) {
+    return (static_cast<uint64_t>(level) << 56) | (static_cast<uint64_t>(x) << 28) | static_cast<uint64_t>(z);
+}
+
+void Landscape::BuildNodeBounds() {
+    TRACE_SCOPE("Landscape::BuildNodeBounds");
+    nodeBounds = IsStreaming() ? tilePyramid->GetBounds() : TerrainPyramid::ComputeBounds(heightField, PATCH_SIZE);
+    rootLevel = static_cast<int>(nodeBounds.size()) - 1;
+}
+
+bool Landscape::IsNodeInside(int level, int x, int z) const {
+    int span = PATCH_SIZE << level;
+    return x * span < resolution - 1 && z * span < resolution - 1;
+}
+
+bool Landscape::ShouldSplit(int level, int x, int z, const glm::vec3& cameraPosition, float distanceScale) const {
+    int span = PATCH_SIZE << level;
+    int count = (resolution - 1 + span - 1) / span;
+    glm::vec2 range = nodeBounds[level][z * count + x];
+    glm::vec2 cell = GetCellSize();
+    
+    glm::vec3 boxMin(x * span * cell.x - size.x * 0.5f, range.x * heightScale + heightOffset,
+                     z * span * cell.y - size.y * 0.5f);
+    glm::vec3 boxMax(std::min((x + 1) * span, resolution - 1) * cell.x - size.x * 0.5f,
+                     range.y * heightScale + heightOffset,
+                     std::min((z + 1) * span, resolution - 1) * cell.y - size.y * 0.5f);
+    if (boxMin.y > boxMax.y) {
+        std::swap(boxMin.y, boxMax.y);   // Negative height scale
+    }
+    
+    glm::vec3 closest = glm::clamp(cameraPosition, boxMin, boxMax);
+    float nodeSize = span * std::max(cell.x, cell.y);
+    return glm::length(cameraPosition - closest) < lodDistance * distanceScale * nodeSize;
+}
+
+void Landscape::SelectNodes(int level, int x, int z, const glm::vec3& cameraPosition, int& buildBudget) {
+    if (!IsNodeInside(level, x, z)) {
+        return;
+    }
+    
+    if (level > 0 && ShouldSplit(level, x, z, cameraPosition)) {
+        // Split only when every child that will be drawn can be built now;
+        // children that split again check their own children. Streamed
+        // children also need their tile, which is requested when missing.
+        int missing = 0;
+        bool resident = true;
+        for (int child = 0; child < 4; ++child) {
+            int cx = 2 * x + (child & 1);
+            int cz = 2 * z + (child >> 1);
+            if (!IsNodeInside(level - 1, cx, cz)) {
+                continue;
+            }
+            bool built = chunks.find(GetChunkKey(level - 1, cx, cz)) != chunks.end();
+            if (!built && IsStreaming() && !tileCache->Find(level - 1, cx, cz)) {
+                tileCache->Request(level - 1, cx, cz);
+                resident = false;
+            }
+            if (!built && (level == 1 || !ShouldSplit(level - 1, cx, cz, cameraPosition))) {
+                missing++;
+            }
+        }
+        if (resident && missing <= buildBudget) {
+            for (int child = 0; child < 4; ++child) {
+                SelectNodes(level - 1, 2 * x + (child & 1), 2 * z + (child >> 1), cameraPosition, buildBudget);
+            }
+            return;
+        }
+        refinementDeferred = true;
+    } else if (level > 0 && IsStreaming() && ShouldSplit(level, x, z, cameraPosition, PREFETCH_DISTANCE_SCALE)) {
+        // Read the children before the camera is close enough to need them
+        for (int child = 0; child < 4; ++child) {
+            int cx = 2 * x + (child & 1);
+            int cz = 2 * z + (child >> 1);
+            if (IsNodeInside(level - 1, cx, cz) && chunks.find(GetChunkKey(level - 1, cx, cz)) == chunks.end() &&
+                !tileCache->Find(level - 1, cx, cz)) {
+                tileCache->Request(level - 1, cx, cz);
+            }
+        }
+    }
+    
+    // A node that is drawn is always built, so coarse fallbacks can go over budget
+    uint64_t key = GetChunkKey(level, x, z);
+    if (chunks.find(key) == chunks.end()) {
+        buildBudget--;
+    }
+    AcquireChunk(level, x, z).lastUsed = updateCount;
+    selectedChunks.push_back(key);
+}
+
+Landscape::Chunk& Landscape::AcquireChunk(int level, int x, int z) {
+    uint64_t key = GetChunkKey(level, x, z);
+    auto it = chunks.find(key);
+    if (it != chunks.end()) {
+        return it->second;
+    }
+    Chunk& chunk = chunks[key];
+    chunk.model = BuildChunk(level, x, z);
+    chunk.lastUsed = updateCount;
+    chunk.inScene = false;
+    return chunk;
+}
+
+std::shared_ptr<Model> Landscape::BuildChunk(int level, int x, int z) const {
+    const int tileSide = PATCH_SIZE + 3;
+    
+    // The node's samples with a one-sample apron, streamed or copied out of
+    // the height map. A streamed node is only drawn once SelectNodes has
+    // seen its tile resident this frame.
+    std::vector<float> extracted;
+    const float* tile = nullptr;
+    if (IsStreaming()) {
+        tile = tileCache->Find(level, x, z);
+    } else {
+        extracted.resize(static_cast<size_t>(tileSide) * tileSide);
+        TerrainPyramid::ExtractTile(heightField, PATCH_SIZE, level, x, z, extracted.data());
+        tile = extracted.data();
+    }
+    
+    std::vector<Vertex> vertices(SKIRT_BASE + SKIRT_VERTICES);
+    WriteChunkRows(level, x, z, tile, 0, PATCH_SIZE, vertices.data());
+    WriteChunkSkirts(level, x, z, vertices.data());
+    
+    std::vector<unsigned int> indices;
+    indices.reserve(6 * PATCH_SIZE * PATCH_SIZE + 6 * SKIRT_VERTICES);
+    for (int j = 0; j < PATCH_SIZE; ++j) {
+        for (int i = 0; i < PATCH_SIZE; ++i) {
+            unsigned int topLeft = j * CHUNK_SIDE + i;
+            unsigned int topRight = topLeft + 1;
+            unsigned int bottomLeft = topLeft + CHUNK_SIDE;
+            unsigned int bottomRight = bottomLeft + 1;
+            
+            indices.insert(indices.end(), { topLeft, bottomLeft, topRight, topRight, bottomLeft, bottomRight });
+        }
+    }
+    
+    const std::vector<unsigned int>& border = ChunkBorder();
+    unsigned int borderCount = static_cast<unsigned int>(border.size());
+    for (unsigned int k = 0; k < borderCount; ++k) {
+        unsigned int next = (k + 1) % borderCount;
+        unsigned int a = border[k];
+        unsigned int b = border[next];
+        unsigned int lowA = SKIRT_BASE + k;
+        unsigned int lowB = SKIRT_BASE + next;
+        indices.insert(indices.end(), { a, b, lowA, b, lowB, lowA });
+    }
+    
+    auto model = std::make_shared<Model>();
+    model->AddMesh(std::make_shared<Mesh>(vertices, indices));
+    model->SetMaterial(material);
+    model->SetStatic(true);
     return model;
 }
 
-// Getters
-Landscape::TerrainType Landscape::GetType() const { return terrainType; }
-glm::vec2 Landscape::GetSize() const { return size; }
-int Landscape::GetResolution() const { return resolution; }
-float Landscape::GetHeightScale() const { return heightScale; }
+void Landscape::WriteChunkRows(int level, int x, int z, const float* tile, int firstRow, int lastRow,
+                               Vertex* vertices) const {
+    const int stride = 1 << level;
+    const int span = PATCH_SIZE << level;
+    const int originX = x * span;
+    const int originZ = z * span;
+    const int last = resolution - 1;
+    const int tileSide = PATCH_SIZE + 3;
+    const glm::vec2 cell = GetCellSize();
+    auto spanAt = [&](int u) {
+        return static_cast<float>(std::clamp(u + stride, 0, last) - std::clamp(u - stride, 0, last));
+    };
+    
+    // Every stride-th sample; nodes on the far edges clamp, which only
+    // collapses the triangles past the edge
+    // Normals come from the tile at the node's stride, so coarse chunks are
+    // shaded like the surface they actually draw
+    for (int j = firstRow; j <= lastRow; ++j) {
+        int sz = std::min(originZ + j * stride, last);
+        float spanZ = spanAt(originZ + j * stride) * cell.y;
+        for (int i = 0; i < CHUNK_SIDE; ++i) {
+            int sx = std::min(originX + i * stride, last);
+            float height = tile[(j + 1) * tileSide + i + 1];
+            glm::vec3 position(sx * cell.x - size.x * 0.5f, height * heightScale + heightOffset,
+                               sz * cell.y - size.y * 0.5f);
+            glm::vec3 normal = TileNormal(tile, tileSide, i + 1, j + 1, spanAt(originX + i * stride) * cell.x, spanZ,
+                                          heightScale);
+            vertices[j * CHUNK_SIDE + i] = Vertex(position, normal,
+                                                  glm::vec2(static_cast<float>(sx) / last, static_cast<float>(sz) / last));
+        }
+    }
+}
+
+void Landscape::WriteChunkSkirts(int level, int x, int z, Vertex* vertices) const {
+    // Skirts: the border hangs down far enough to cover the gap to a
+    // neighbour of another level, which is at most this node's height range
+    const int stride = 1 << level;
+    const int span = PATCH_SIZE << level;
+    const int count = (resolution - 1 + span - 1) / span;
+    const glm::vec2 cell = GetCellSize();
+    glm::vec2 range = nodeBounds[level][z * count + x];
+    float skirtDepth = std::max(std::abs(range.y - range.x) * heightScale, stride * std::max(cell.x, cell.y));
+    
+    const std::vector<unsigned int>& border = ChunkBorder();
+    for (size_t k = 0; k < border.size(); ++k) {
+        Vertex skirt = vertices[border[k]];
+        skirt.position.y -= skirtDepth;
+        vertices[SKIRT_BASE + k] = skirt;
+    }
+}
+
+void Landscape::RefitChunks(Scene& scene) {
+    TRACE_SCOPE("Landscape::RefitChunks");
+    TerrainPyramid::UpdateBounds(heightField, PATCH_SIZE, dirtyMin, dirtyMax, nodeBounds);
+    
+    const int last = resolution - 1;
+    const int tileSide = PATCH_SIZE + 3;
+    std::vector<float> tile(static_cast<size_t>(tileSide) * tileSide);
+    std::vector<Vertex> vertices;
+    // Before and after bounds of the refitted chunks in the scene
+    glm::vec3 changedMin(std::numeric_limits<float>::max());
+    glm::vec3 changedMax(-std::numeric_limits<float>::max());
+    
+    for (auto& entry : chunks) {
+        const int level = static_cast<int>(entry.first >> 56);
+        const int x = static_cast<int>((entry.first >> 28) & 0xfffffff);
+        const int z = static_cast<int>(entry.first & 0xfffffff);
+        const int stride = 1 << level;
+        const int span = PATCH_SIZE << level;
+        
+        // Rows and columns of vertices that read an edited sample, for their
+        // height or through the central differences of their normal
+        auto touches = [&](int origin, int index, int low, int high) {
+            int sample = std::min(origin + index * stride, last);
+            return sample + stride >= low && sample - stride <= high;
+        };
+        int firstRow = -1, lastRow = -1;
+        bool columns = false;
+        for (int k = 0; k < CHUNK_SIDE; ++k) {
+            if (touches(z * span, k, dirtyMin.y, dirtyMax.y)) {
+                firstRow = firstRow < 0 ? k : firstRow;
+                lastRow = k;
+            }
+            columns = columns || touches(x * span, k, dirtyMin.x, dirtyMax.x);
+        }
+        if (firstRow < 0 || !columns) {
+            continue;
+        }
+        
+        // Whole rows are rewritten, since they are contiguous in the buffer.
+        // Skirts hang off the border and the node's height range; they are
+        // few, so they are always sent.
+        TerrainPyramid::ExtractTile(heightField, PATCH_SIZE, level, x, z, tile.data());
+        const std::shared_ptr<Model>& model = entry.second.model;
+        const std::shared_ptr<Mesh>& mesh = model->GetMeshes().front();
+        if (entry.second.inScene) {
+            changedMin = glm::min(changedMin, model->GetBoundingBoxMin());
+            changedMax = glm::max(changedMax, model->GetBoundingBoxMax());
+        }
+        vertices = mesh->GetVertices();
+        WriteChunkRows(level, x, z, tile.data(), firstRow, lastRow, vertices.data());
+        WriteChunkSkirts(level, x, z, vertices.data());
+        
+        size_t first = static_cast<size_t>(firstRow) * CHUNK_SIDE;
+        mesh->UpdateVertexBuffer(first, static_cast<size_t>(lastRow - firstRow + 1) * CHUNK_SIDE, &vertices[first]);
+        mesh->UpdateVertexBuffer(SKIRT_BASE, SKIRT_VERTICES, &vertices[SKIRT_BASE]);
+        model->InvalidateBounds();
+        if (entry.second.inScene) {
+            changedMin = glm::min(changedMin, model->GetBoundingBoxMin());
+            changedMax = glm::max(changedMax, model->GetBoundingBoxMax());
+        }
+    }
+    
+    if (changedMin.x <= changedMax.x) {
+        scene.MarkStaticGeometryChanged(changedMin, changedMax);
+    }
+    ClearDirty();
+}
+
+bool Landscape::UpdateChunks(const glm::vec3& cameraPosition, Scene& scene) {
+    TRACE_SCOPE("Landscape::UpdateChunks");
+    if (tileCache) {
+        tileCache->Update();
+    }
+    if (chunksDirty) {
+        RemoveChunks(scene);
+        chunks.clear();
+        if (!IsStreaming() && heightField.IsEmpty()) {
+            GenerateHeightMap();
+        }
+        BuildNodeBounds();
+        ClearDirty();
+        chunksDirty = false;
+    } else if (dirtyMin.x <= dirtyMax.x) {
+        RefitChunks(scene);
+    }
+    
+    updateCount++;
+    std::vector<uint64_t> previous;
+    previous.swap(selectedChunks);
+    int buildBudget = MAX_CHUNK_BUILDS_PER_UPDATE;
+    refinementDeferred = false;
+    SelectNodes(rootLevel, 0, 0, cameraPosition, buildBudget);
+    
+    for (uint64_t key : selectedChunks) {
+        Chunk& chunk = chunks[key];
+        if (!chunk.inScene) {
+            scene.AddModel(chunk.model);
+            chunk.inScene = true;
+        }
+    }
+    for (uint64_t key : previous) {
+        Chunk& chunk = chunks[key];
+        if (chunk.inScene && chunk.lastUsed != updateCount) {
+            scene.RemoveModel(chunk.model);
+            chunk.inScene = false;
+        }
+    }
+    
+    // Drop the least recently drawn chunks beyond the cache size
+    if (chunks.size() > selectedChunks.size() + MAX_CACHED_CHUNKS) {
+        std::vector<std::pair<uint64_t, uint64_t>> unused;
+        for (const auto& entry : chunks) {
+            if (!entry.second.inScene && entry.second.lastUsed != updateCount) {
+                unused.push_back({ entry.second.lastUsed, entry.first });
+            }
+        }
+        size_t excess = std::min(chunks.size() - selectedChunks.size() - MAX_CACHED_CHUNKS, unused.size());
+        std::partial_sort(unused.begin(), unused.begin() + excess, unused.end());
+        for (size_t i = 0; i < excess; ++i) {
+            chunks.erase(unused[i].second);
+        }
+    }
+    
+    Profiler& profiler = Profiler::Instance();
+    profiler.SetCounter("Terrain chunks", static_cast<long long>(selectedChunks.size()));
+    profiler.SetCounter("Terrain triangles", static_cast<long long>(GetTriangleCount()));
+    if (tileCache) {
+        TerrainTileCache::Stats stats = tileCache->GetStats();
+        profiler.SetCounter("Terrain tiles", stats.resident);
+        profiler.SetCounter("Terrain tile reads", stats.pending);
+    }
+    return !refinementDeferred;
+}
+
+void Landscape::RemoveChunks(Scene& scene) {
+    for (auto& entry : chunks) {
+        if (entry.second.inScene) {
+            scene.RemoveModel(entry.second.model);
+            entry.second.inScene = false;
+        }
+    }
+    selectedChunks.clear();
+}
+
+size_t Landscape::GetTriangleCount() const {
+    // Patch grid plus two triangles per border edge for the skirts
+    const size_t trianglesPerChunk = 2 * PATCH_SIZE * PATCH_SIZE + 8 * PATCH_SIZE;
+    return selectedChunks.size() * trianglesPerChunk;
+}
@@ -1,18 +1,39 @@
 #include "Components/Skybox.h"
-#include "Engine/Texture.h"
-#include <GL/glew.h>
-#include <glm/gtc/matrix_transform.hpp>
-#include <iostream>
+#include "Engine/Atmosphere.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+namespace {
+    const UniformId SUN_DIRECTION_UNIFORM("sunDirection");
+    const UniformId SUN_INTENSITY_UNIFORM("sunIntensity");
+    const UniformId CLOUDINESS_UNIFORM("cloudiness");
+    const UniformId SKY_COLOR_UNIFORM("skyColor");
+    const UniformId HORIZON_COLOR_UNIFORM("horizonColor");
+    const UniformId GROUND_COLOR_UNIFORM("groundColor");
+    const UniformId ATMOSPHERE_READY_UNIFORM("atmosphereReady");
+
+    // Texture units fixed by layout(binding) in skybox.frag
+    const GLuint TRANSMITTANCE_UNIT = 0;
+    const GLuint SKY_LUT_UNIT = 1;
+
+    const float DEFAULT_SUN_INTENSITY = 20.0f;
+}
+
+Skybox::Skybox() : Skybox(SkyType::CLEAR_DAY) {
+}
 
-Skybox::Skybox(SkyType type) : skyType(type), timeOfDay(0.5f), cubemapTexture(0), vao(0), vbo(0) {
+Skybox::Skybox(SkyType type)
+    : type(type), timeOfDay(0.5f), cloudiness(0.0f), sunIntensity(DEFAULT_SUN_INTENSITY), vao(0), vbo(0) {
+    SetType(type);
+    SetTimeOfDay(timeOfDay);
     InitializeGeometry();
-    GenerateCubemap();
+
+    // Built once on a worker thread (or read from the disk cache)
+    Atmosphere::Instance().Prepare();
 }
 
 Skybox::~Skybox() {
-    if (cubemapTexture != 0) {
-        glDeleteTextures(1, &cubemapTexture);
-    }
     if (vao != 0) {
         glDeleteVertexArrays(1, &vao);
     }
@@ -21,36 +42,94 @@ Skybox::~Skybox() {
     }
 }
 
+void Skybox::SetType(SkyType skyType) {
+    type = skyType;
+    switch (type) {
+        case SkyType::CLEAR_DAY:
+            SetAtmosphere(glm::vec3(0.3f, 0.5f, 0.8f), glm::vec3(0.8f, 0.9f, 1.0f), glm::vec3(0.3f, 0.3f, 0.3f));
+            cloudiness = 0.0f;
+            break;
+        case SkyType::CLOUDY_DAY:
+            SetAtmosphere(glm::vec3(0.4f, 0.5f, 0.6f), glm::vec3(0.7f, 0.8f, 0.9f), glm::vec3(0.3f, 0.3f, 0.3f));
+            cloudiness = 0.6f;
+            break;
+        case SkyType::SUNSET:
+            SetAtmosphere(glm::vec3(0.8f, 0.3f, 0.1f), glm::vec3(1.0f, 0.4f, 0.2f), glm::vec3(0.2f, 0.15f, 0.1f));
+            cloudiness = 0.0f;
+            break;
+        case SkyType::NIGHT:
+            SetAtmosphere(glm::vec3(0.02f, 0.02f, 0.05f), glm::vec3(0.1f, 0.1f, 0.2f), glm::vec3(0.02f, 0.02f, 0.02f));
+            cloudiness = 0.0f;
+            break;
+        case SkyType::STORMY:
+            SetAtmosphere(glm::vec3(0.25f, 0.27f, 0.3f), glm::vec3(0.4f, 0.42f, 0.45f), glm::vec3(0.15f, 0.15f, 0.15f));
+            cloudiness = 0.9f;
+            break;
+        case SkyType::CUSTOM:
+            break;
+    }
+}
+
+void Skybox::SetAtmosphere(const glm::vec3& sky, const glm::vec3& horizon, const glm::vec3& ground) {
+    skyColor = sky;
+    horizonColor = horizon;
+    groundColor = ground;
+}
+
 void Skybox::SetTimeOfDay(float time) {
     timeOfDay = std::clamp(time, 0.0f, 1.0f);
-    UpdateCubemap();
+
+    // Same path as the sun light in the applications; the sky LUT already
+    // holds every sun elevation, so this is all a new time of day costs
+    float sunAngle = timeOfDay * 2.0f * glm::pi<float>();
+    sunDirection = glm::normalize(glm::vec3(200.0f * std::cos(sunAngle), 100.0f * std::sin(sunAngle),
+                                            200.0f * std::sin(sunAngle)));
 }
 
-void Skybox::SetSkyType(SkyType type) {
-    skyType = type;
-    GenerateCubemap();
+void Skybox::SetWeather(float amount) {
+    cloudiness = std::clamp(amount, 0.0f, 1.0f);
 }
 
-void Skybox::Update(float deltaTime) {
-    // Animate sky if needed
-    static float animationSpeed = 0.1f;
-    timeOfDay += animationSpeed * deltaTime / 86400.0f; // 24-hour cycle
-    if (timeOfDay > 1.0f) {
-        timeOfDay -= 1.0f;
-    }
-    UpdateCubemap();
+void Skybox::SetSunIntensity(float intensity) {
+    sunIntensity = std::max(0.0f, intensity);
 }
 
-void Skybox::Draw() const {
+void Skybox::Render(Shader& shader) {
+    Atmosphere& atmosphere = Atmosphere::Instance();
+    bool ready = atmosphere.Upload();
+
+    shader.SetVec3(SUN_DIRECTION_UNIFORM, sunDirection);
+    shader.SetFloat(SUN_INTENSITY_UNIFORM, sunIntensity);
+    shader.SetFloat(CLOUDINESS_UNIFORM, cloudiness);
+    shader.SetVec3(SKY_COLOR_UNIFORM, skyColor);
+    shader.SetVec3(HORIZON_COLOR_UNIFORM, horizonColor);
+    shader.SetVec3(GROUND_COLOR_UNIFORM, groundColor);
+    shader.SetBool(ATMOSPHERE_READY_UNIFORM, ready);
+    if (ready) {
+        glActiveTexture(GL_TEXTURE0 + TRANSMITTANCE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, atmosphere.GetTransmittanceTexture());
+        glActiveTexture(GL_TEXTURE0 + SKY_LUT_UNIT);
+        glBindTexture(GL_TEXTURE_3D, atmosphere.GetSkyTexture());
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // Drawn last at the far plane (xyww), seen from inside the cube
+    GLint depthFunc;
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    GLboolean culling = glIsEnabled(GL_CULL_FACE);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+
     glBindVertexArray(vao);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
     glDrawArrays(GL_TRIANGLES, 0, 36);
     glBindVertexArray(0);
-}
 
-GLuint Skybox::GetCubemap() const {
-    return cubemapTexture;
+    glDepthMask(GL_TRUE);
+    glDepthFunc(depthFunc);
+    if (culling) {
+        glEnable(GL_CULL_FACE);
+    }
 }
 
 void Skybox::InitializeGeometry() {
@@ -108,136 +187,3 @@ void Skybox::InitializeGeometry() {
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 }
-
-void Skybox::GenerateCubemap() {
-    if (cubemapTexture != 0) {
-        glDeleteTextures(1, &cubemapTexture);
-    }
-
-    glGenTextures(1, &cubemapTexture);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-
-    // Generate cubemap faces based on sky type and time of day
-    for (unsigned int i = 0; i < 6; ++i) {
-        GenerateCubemapFace(static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i));
-    }
-
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-}
-
-void Skybox::GenerateCubemapFace(GLenum target) {
-    const int size = 512;
-    std::vector<unsigned char> data(size * size * 3);
-
-    // Generate sky color based on time of day and sky type
-    glm::vec3 skyColor = GetSkyColor();
-    glm::vec3 horizonColor = GetHorizonColor();
-    glm::vec3 zenithColor = GetZenithColor();
-
-    for (int y = 0; y < size; ++y) {
-        for (int x = 0; x < size; ++x) {
-            float nx = (float)x / size * 2.0f - 1.0f;
-            float ny = (float)y / size * 2.0f - 1.0f;
-            float nz = 1.0f;
-
-            // Convert to world space based on face
-            glm::vec3 direction;
-            switch (target) {
-                case GL_TEXTURE_CUBE_MAP_POSITIVE_X: direction = glm::vec3(1.0f, -ny, -nx); break;
-                case GL_TEXTURE_CUBE_MAP_NEGATIVE_X: direction = glm::vec3(-1.0f, -ny, nx); break;
-                case GL_TEXTURE_CUBE_MAP_POSITIVE_Y: direction = glm::vec3(nx, 1.0f, -ny); break;
-                case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y: direction = glm::vec3(nx, -1.0f, ny); break;
-                case GL_TEXTURE_CUBE_MAP_POSITIVE_Z: direction = glm::vec3(nx, -ny, 1.0f); break;
-                case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z: direction = glm::vec3(-nx, -ny, -1.0f); break;
-            }
-
-            direction = glm::normalize(direction);
-            glm::vec3 color = CalculateSkyColor(direction, skyColor, horizonColor, zenithColor);
-
-            int index = (y * size + x) * 3;
-            data[index] = static_cast<unsigned char>(color.r * 255);
-            data[index + 1] = static_cast<unsigned char>(color.g * 255);
-            data[index + 2] = static_cast<unsigned char>(color.b * 255);
-        }
-    }
-
-    glTexImage2D(target, 0, GL_RGB, size, size, 0, GL_RGB, GL_UNSIGNED_BYTE, data.data());
-}
-
-glm::vec3 Skybox::GetSkyColor() const {
-    switch (skyType) {
-        case SkyType::CLEAR_DAY:
-            return glm::vec3(0.5f, 0.7f, 1.0f);
-        case SkyType::CLOUDY_DAY:
-            return glm::vec3(0.6f, 0.7f, 0.8f);
-        case SkyType::SUNSET:
-            return glm::vec3(1.0f, 0.6f, 0.4f);
-        case SkyType::NIGHT:
-            return glm::vec3(0.05f, 0.05f, 0.1f);
-        default:
-            return glm::vec3(0.5f, 0.7f, 1.0f);
-    }
-}
-
-glm::vec3 Skybox::GetHorizonColor() const {
-    switch (skyType) {
-        case SkyType::CLEAR_DAY:
-            return glm::vec3(0.8f, 0.9f, 1.0f);
-        case SkyType::CLOUDY_DAY:
-            return glm::vec3(0.7f, 0.8f, 0.9f);
-        case SkyType::SUNSET:
-            return glm::vec3(1.0f, 0.4f, 0.2f);
-        case SkyType::NIGHT:
-            return glm::vec3(0.1f, 0.1f, 0.2f);
-        default:
-            return glm::vec3(0.8f, 0.9f, 1.0f);
-    }
-}
-
-glm::vec3 Skybox::GetZenithColor() const {
-    switch (skyType) {
-        case SkyType::CLEAR_DAY:
-            return glm::vec3(0.3f, 0.5f, 0.8f);
-        case SkyType::CLOUDY_DAY:
-            return glm::vec3(0.4f, 0.5f, 0.6f);
-        case SkyType::SUNSET:
-            return glm::vec3(0.8f, 0.3f, 0.1f);
-        case SkyType::NIGHT:
-            return glm::vec3(0.02f, 0.02f, 0.05f);
-        default:
-            return glm::vec3(0.3f, 0.5f, 0.8f);
-    }
-}
-
-glm::vec3 Skybox::CalculateSkyColor(const glm::vec3& direction, const glm::vec3& skyColor, 
-                                   const glm::vec3& horizonColor, const glm::vec3& zenithColor) const {
-    // Calculate elevation angle (0 = horizon, 1 = zenith)
-    float elevation = (direction.y + 1.0f) * 0.5f;
-    
-    // Interpolate between horizon and zenith colors
-    glm::vec3 baseColor = glm::mix(horizonColor, zenithColor, elevation);
-    
-    // Add time of day variation
-    float timeVariation = sin(timeOfDay * 2.0f * M_PI);
-    baseColor += glm::vec3(timeVariation * 0.1f);
-    
-    // Add atmospheric scattering effect
-    float scattering = 1.0f - elevation * 0.3f;
-    baseColor *= scattering;
-    
-    // Clamp to valid range
-    baseColor = glm::clamp(baseColor, 0.0f, 1.0f);
-    
-    return baseColor;
-}
-
-void Skybox::UpdateCubemap() {
-    // Regenerate cubemap with new time of day
-    for (unsigned int i = 0; i < 6; ++i) {
-        GenerateCubemapFace(static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i));
-    }
-}
@@ -2,28 +2,39 @@
 #include "Engine/Model.h"
 #include "Engine/Mesh.h"
 #include "Engine/Material.h"
+#include "Engine/TraceRecorder.h"
 #include "Utils/MathUtils.h"
 #include <GL/glew.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <limits>
 
 SolarPanel::SolarPanel(PanelType type, const glm::vec3& position, const glm::vec2& size)
     : panelType(type), position(position), size(size),
       tilt(30.0f), azimuth(180.0f), efficiency(0.22f),
       powerOutput(400.0f), temperature(25.0f),
-      arrayRows(1), arrayCols(1), spacing(3.0f),
+      dirtLevel(0.0f), timeOfDay(0.5f), arrayRows(1), arrayCols(1), arraySpacing(3.0f),
       energyGenerated(0.0f), currentPower(0.0f),
       shadingFactor(1.0f), soilingFactor(0.95f),
-      model(nullptr) {
+      model(nullptr), instanceVBO(0), instanceDirtyBegin(0), instanceDirtyEnd(0) {
     
     // Set material properties based on panel type
     SetupMaterial();
     
+    // A single panel is a 1x1 array
+    CalculatePanelTransforms();
+    
     // Generate geometry
     GenerateGeometry();
 }
 
 SolarPanel::~SolarPanel() {
+    if (instanceVBO != 0) {
+        glDeleteBuffers(1, &instanceVBO);
+    }
 }
 
 void SolarPanel::SetPosition(const glm::vec3& pos) {
@@ -58,17 +69,129 @@ void SolarPanel::SetTemperature(float temp) {
 void SolarPanel::CreateArray(int rows, int cols, float spacing) {
     arrayRows = rows;
     arrayCols = cols;
-    this->spacing = spacing;
+    arraySpacing = spacing;
     
     // Recalculate total size
     totalSize.x = size.x * cols + spacing * (cols - 1);
     totalSize.y = size.y * rows + spacing * (rows - 1);
     
+    // One instance per panel
+    CalculatePanelTransforms();
+    
     // Regenerate geometry for array
     GenerateGeometry();
 }
 
+void SolarPanel::CalculatePanelTransforms() {
+    // Every panel in the array shares the same orientation
+    glm::mat4 orientation = glm::mat4(1.0f);
+    orientation = glm::rotate(orientation, glm::radians(azimuth), glm::vec3(0.0f, 1.0f, 0.0f));
+    orientation = glm::rotate(orientation, glm::radians(tilt), glm::vec3(1.0f, 0.0f, 0.0f));
+    
+    size_t count = static_cast<size_t>(arrayRows) * static_cast<size_t>(arrayCols);
+    bool layoutChanged = instances.size() != count;
+    instances.resize(count);
+    
+    // Rows run along Z, columns along X, centered on the array position
+    glm::vec2 pitch(size.x + arraySpacing, size.y + arraySpacing);
+    glm::vec2 origin = -0.5f * pitch * glm::vec2(arrayCols - 1, arrayRows - 1);
+    
+    for (int row = 0; row < arrayRows; ++row) {
+        for (int col = 0; col < arrayCols; ++col) {
+            InstanceData& instance = instances[row * arrayCols + col];
+            glm::vec3 offset(origin.x + col * pitch.x, 0.0f, origin.y + row * pitch.y);
+            instance.transform = glm::translate(glm::mat4(1.0f), offset) * orientation;
+            
+            if (layoutChanged) {
+                instance.state = glm::vec4(efficiency, temperature, dirtLevel, 0.0f);
+            }
+        }
+    }
+    
+    MarkInstanceDirty(0, count);
+}
+
+void SolarPanel::UpdateInstanceBounds() {
+    if (!model || instances.empty()) return;
+    
+    // Conservative model-space box: instance origins padded by the panel's bounding radius
+    float radius = model->GetMeshes().empty() ? 0.0f : model->GetMeshes()[0]->GetBoundingRadius();
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+    for (const auto& instance : instances) {
+        glm::vec3 origin(instance.transform[3]);
+        boundsMin = glm::min(boundsMin, origin);
+        boundsMax = glm::max(boundsMax, origin);
+    }
+    
+    model->SetInstanceBounds(boundsMin - glm::vec3(radius), boundsMax + glm::vec3(radius));
+}
+
+void SolarPanel::SetPanelState(int index, float panelEfficiency, float panelTemperature, float panelDirt) {
+    if (index < 0 || index >= GetPanelCount()) return;
+    
+    glm::vec4& state = instances[index].state;
+    state.x = panelEfficiency;
+    state.y = panelTemperature;
+    state.z = std::clamp(panelDirt, 0.0f, 1.0f);
+    MarkInstanceDirty(index, index + 1);
+}
+
+void SolarPanel::SetPanelSelected(int index, bool selected) {
+    if (index < 0 || index >= GetPanelCount()) return;
+    
+    instances[index].state.w = selected ? 1.0f : 0.0f;
+    MarkInstanceDirty(index, index + 1);
+}
+
+void SolarPanel::SetPanelTransform(int index, const glm::mat4& transform) {
+    if (index < 0 || index >= GetPanelCount()) return;
+    
+    instances[index].transform = transform;
+    UpdateInstanceBounds();
+    
+    // Just this panel's matrix; its state keeps riding the dirty range
+    if (instanceVBO != 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        index * sizeof(InstanceData) + offsetof(InstanceData, transform),
+                        sizeof(glm::mat4),
+                        &instances[index].transform);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+glm::vec4 SolarPanel::GetPanelState(int index) const {
+    if (index < 0 || index >= GetPanelCount()) return glm::vec4(0.0f);
+    return instances[index].state;
+}
+
+void SolarPanel::MarkInstanceDirty(size_t begin, size_t end) {
+    if (instanceDirtyBegin >= instanceDirtyEnd) {
+        instanceDirtyBegin = begin;
+        instanceDirtyEnd = end;
+    } else {
+        instanceDirtyBegin = std::min(instanceDirtyBegin, begin);
+        instanceDirtyEnd = std::max(instanceDirtyEnd, end);
+    }
+}
+
+void SolarPanel::UploadInstanceData() {
+    if (instanceVBO == 0 || instanceDirtyBegin >= instanceDirtyEnd) return;
+    
+    // Only the dirty range; selecting one panel in a 500k array uploads 80 bytes
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER,
+                    instanceDirtyBegin * sizeof(InstanceData),
+                    (instanceDirtyEnd - instanceDirtyBegin) * sizeof(InstanceData),
+                    &instances[instanceDirtyBegin]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    instanceDirtyBegin = instanceDirtyEnd = 0;
+}
+
 void SolarPanel::GenerateGeometry() {
+    TRACE_SCOPE("SolarPanel::GenerateGeometry");
     // Create vertices for a single panel
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
@@ -116,12 +239,23 @@ void SolarPanel::GenerateGeometry() {
     indices.push_back(0); indices.push_back(1); indices.push_back(5);
     indices.push_back(5); indices.push_back(4); indices.push_back(0);
     
-    // Create mesh
+    // Create mesh (shared by every panel in the array)
     auto mesh = std::make_shared<Mesh>(vertices, indices);
     
+    // Per-panel instance buffer, attached to the shared mesh's VAO
+    if (instanceVBO == 0) {
+        glGenBuffers(1, &instanceVBO);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceData), instances.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    instanceDirtyBegin = instanceDirtyEnd = 0;
+    mesh->SetInstanceBuffer(instanceVBO);
+    
     // Create model
     model = std::make_shared<Model>();
     model->AddMesh(mesh);
+    model->SetInstanceCount(static_cast<unsigned int>(instances.size()));
     model->SetPosition(position);
     model->SetMaterial(material);
     
@@ -159,14 +293,13 @@ void SolarPanel::SetupMaterial() {
 void SolarPanel::UpdateTransform() {
     if (!model) return;
     
-    // Create transformation matrix
-    glm::mat4 transform = glm::mat4(1.0f);
-    
-    // Apply tilt and azimuth
-    transform = glm::rotate(transform, glm::radians(azimuth), glm::vec3(0.0f, 1.0f, 0.0f));
-    transform = glm::rotate(transform, glm::radians(tilt), glm::vec3(1.0f, 0.0f, 0.0f));
+    // Tilt and azimuth are baked into the per-panel instance transforms, so
+    // the model transform only places the array
+    CalculatePanelTransforms();
+    UpdateInstanceBounds();
+    UploadInstanceData();
     
-    model->SetTransform(transform);
+    model->SetPosition(position);
 }
 
 void SolarPanel::Update(float deltaTime) {
@@ -178,6 +311,13 @@ void SolarPanel::Update(float deltaTime) {
     
     // Update shading analysis
     UpdateShadingAnalysis();
+    
+    // Flush per-panel state changes
+    UploadInstanceData();
+}
+
+void SolarPanel::SetTimeOfDay(float t) {
+    timeOfDay = t - std::floor(t);
 }
 
 void SolarPanel::UpdateEnergyGeneration(float deltaTime) {
@@ -205,10 +345,6 @@ float SolarPanel::CalculateSolarIrradiance() {
     // Simplified solar irradiance calculation
     // In a real implementation, this would use actual solar position and weather data
     
-    // Get current time (simplified)
-    float timeOfDay = static_cast<float>(glfwGetTime()) / 86400.0f; // 0-1 over 24 hours
-    timeOfDay = fmod(timeOfDay, 1.0f);
-    
     // Solar noon is at 0.5
     float solarNoon = 0.5f;
     float timeFromNoon = abs(timeOfDay - solarNoon);
@@ -258,9 +394,6 @@ void SolarPanel::UpdateShadingAnalysis() {
     // In a real implementation, this would use ray tracing to detect shadows
     
     // For now, use a simple time-based shading factor
-    float timeOfDay = static_cast<float>(glfwGetTime()) / 86400.0f;
-    timeOfDay = fmod(timeOfDay, 1.0f);
-    
     // Simulate shading in morning and evening
     if (timeOfDay < 0.25f || timeOfDay > 0.75f) {
         shadingFactor = 0.3f; // Heavy shading
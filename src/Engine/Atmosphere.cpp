@@ -0,0 +1,362 @@
+#include "Engine/Atmosphere.h"
+#include "Engine/TraceRecorder.h"
+#include "Utils/FileUtils.h"
+#include "Utils/Hash.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    // Earth-like atmosphere, lengths in km
+    const float GROUND_RADIUS = 6360.0f;
+    const float TOP_RADIUS = 6460.0f;
+    const float OBSERVER_HEIGHT = 0.2f;
+
+    const float RAYLEIGH_SCATTERING[3] = { 5.802e-3f, 13.558e-3f, 33.1e-3f };
+    const float RAYLEIGH_SCALE_HEIGHT = 8.0f;
+    const float MIE_SCATTERING = 3.996e-3f;
+    const float MIE_EXTINCTION = 4.40e-3f;
+    const float MIE_SCALE_HEIGHT = 1.2f;
+    const float MIE_G = 0.8f;
+    // Ozone only absorbs; a tent profile peaking at 25 km
+    const float OZONE_ABSORPTION[3] = { 0.650e-3f, 1.881e-3f, 0.085e-3f };
+    const float OZONE_CENTER = 25.0f;
+    const float OZONE_HALF_WIDTH = 15.0f;
+
+    const int TRANSMITTANCE_STEPS = 40;
+    const int SKY_STEPS = 32;
+    const float PI = 3.14159265358979f;
+
+    const char CACHE_MAGIC[4] = { 'S', 'K', 'Y', 'L' };
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+    };
+
+    struct Medium {
+        float scattering[3];
+        float extinction[3];
+        float mie;
+    };
+
+    Medium SampleMedium(float height) {
+        float rayleigh = std::exp(-height / RAYLEIGH_SCALE_HEIGHT);
+        float mie = std::exp(-height / MIE_SCALE_HEIGHT);
+        float ozone = std::max(0.0f, 1.0f - std::abs(height - OZONE_CENTER) / OZONE_HALF_WIDTH);
+
+        Medium medium;
+        medium.mie = MIE_SCATTERING * mie;
+        for (int c = 0; c < 3; ++c) {
+            medium.scattering[c] = RAYLEIGH_SCATTERING[c] * rayleigh;
+            medium.extinction[c] = medium.scattering[c] + MIE_EXTINCTION * mie + OZONE_ABSORPTION[c] * ozone;
+        }
+        return medium;
+    }
+
+    // Distance along a ray from radius r with cos zenith mu to a sphere, or
+    // -1 when it misses (only the far hit for the top, near hit for ground)
+    float DistanceToGround(float r, float mu) {
+        float discriminant = r * r * (mu * mu - 1.0f) + GROUND_RADIUS * GROUND_RADIUS;
+        if (mu >= 0.0f || discriminant < 0.0f) {
+            return -1.0f;
+        }
+        return std::max(0.0f, -r * mu - std::sqrt(discriminant));
+    }
+
+    float DistanceToTop(float r, float mu) {
+        float discriminant = r * r * (mu * mu - 1.0f) + TOP_RADIUS * TOP_RADIUS;
+        return std::max(0.0f, -r * mu + std::sqrt(std::max(0.0f, discriminant)));
+    }
+
+    float RayleighPhase(float cosTheta) {
+        return 3.0f / (16.0f * PI) * (1.0f + cosTheta * cosTheta);
+    }
+
+    // Cornette-Shanks
+    float MiePhase(float cosTheta) {
+        float g2 = MIE_G * MIE_G;
+        float denominator = 1.0f + g2 - 2.0f * MIE_G * cosTheta;
+        return 3.0f / (8.0f * PI) * (1.0f - g2) * (1.0f + cosTheta * cosTheta) /
+               ((2.0f + g2) * denominator * std::sqrt(denominator));
+    }
+
+    // View elevation mapping shared with skybox.frag: half the rows cover
+    // each hemisphere, packed quadratically towards the horizon
+    float ViewElevation(float v) {
+        float x = 2.0f * v - 1.0f;
+        return (x < 0.0f ? -1.0f : 1.0f) * x * x * PI * 0.5f;
+    }
+
+    GLuint CreateTexture(GLenum target, int width, int height, int depth, const std::vector<float>& data) {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(target, texture);
+        if (target == GL_TEXTURE_3D) {
+            glTexImage3D(target, 0, GL_RGB16F, width, height, depth, 0, GL_RGB, GL_FLOAT, data.data());
+            glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        } else {
+            glTexImage2D(target, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data.data());
+        }
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(target, 0);
+        return texture;
+    }
+}
+
+Atmosphere& Atmosphere::Instance() {
+    static Atmosphere atmosphere;
+    return atmosphere;
+}
+
+Atmosphere::Atmosphere()
+    : cachePath("sky_cache/atmosphere.bin"), built(false), transmittanceTexture(0), skyTexture(0) {
+}
+
+Atmosphere::~Atmosphere() {
+    // Textures are released by Shutdown while the context is current
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void Atmosphere::SetCachePath(const std::string& path) {
+    cachePath = path;
+}
+
+void Atmosphere::Prepare() {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    if (built || worker.joinable()) {
+        return;
+    }
+    worker = std::thread(&Atmosphere::Build, this);
+}
+
+void Atmosphere::Wait() {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool Atmosphere::Upload() {
+    if (skyTexture != 0) {
+        return true;
+    }
+    if (!built) {
+        return false;
+    }
+    Wait();
+
+    transmittanceTexture = CreateTexture(GL_TEXTURE_2D, TRANSMITTANCE_WIDTH, TRANSMITTANCE_HEIGHT, 1, transmittance);
+    skyTexture = CreateTexture(GL_TEXTURE_3D, SKY_WIDTH, SKY_HEIGHT, SKY_DEPTH, sky);
+
+    // The GPU copy is all the renderer needs from here on
+    std::vector<float>().swap(transmittance);
+    std::vector<float>().swap(sky);
+    return true;
+}
+
+void Atmosphere::Shutdown() {
+    Wait();
+    if (transmittanceTexture != 0) {
+        glDeleteTextures(1, &transmittanceTexture);
+        transmittanceTexture = 0;
+    }
+    if (skyTexture != 0) {
+        glDeleteTextures(1, &skyTexture);
+        skyTexture = 0;
+    }
+    transmittance.clear();
+    sky.clear();
+    built = false;
+}
+
+void Atmosphere::Build() {
+    TraceRecorder::Instance().SetThreadName("Atmosphere");
+    if (!LoadCache()) {
+        auto start = std::chrono::steady_clock::now();
+        ComputeTransmittance();
+        ComputeSky();
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        std::cout << "Atmosphere LUTs built in " << static_cast<int>(elapsed.count()) << " ms" << std::endl;
+        StoreCache();
+    }
+    built = true;
+}
+
+void Atmosphere::ComputeTransmittance() {
+    transmittance.assign(TRANSMITTANCE_WIDTH * TRANSMITTANCE_HEIGHT * 3, 0.0f);
+    for (int y = 0; y < TRANSMITTANCE_HEIGHT; ++y) {
+        // Row v holds altitude h = H * v^2 (H the atmosphere thickness), which
+        // keeps rows dense in the lower atmosphere; lookups use v = sqrt(h / H)
+        float v = static_cast<float>(y) / (TRANSMITTANCE_HEIGHT - 1);
+        float r = GROUND_RADIUS + v * v * (TOP_RADIUS - GROUND_RADIUS);
+        for (int x = 0; x < TRANSMITTANCE_WIDTH; ++x) {
+            float mu = -1.0f + 2.0f * x / (TRANSMITTANCE_WIDTH - 1);
+            float* texel = &transmittance[(y * TRANSMITTANCE_WIDTH + x) * 3];
+            if (DistanceToGround(r, mu) >= 0.0f) {
+                continue;   // The planet blocks the sun
+            }
+
+            float distance = DistanceToTop(r, mu);
+            float step = distance / TRANSMITTANCE_STEPS;
+            float depth[3] = { 0.0f, 0.0f, 0.0f };
+            for (int i = 0; i < TRANSMITTANCE_STEPS; ++i) {
+                float t = (i + 0.5f) * step;
+                float height = std::sqrt(r * r + t * t + 2.0f * r * mu * t) - GROUND_RADIUS;
+                Medium medium = SampleMedium(height);
+                for (int c = 0; c < 3; ++c) {
+                    depth[c] += medium.extinction[c] * step;
+                }
+            }
+            for (int c = 0; c < 3; ++c) {
+                texel[c] = std::exp(-depth[c]);
+            }
+        }
+    }
+}
+
+void Atmosphere::SampleTransmittance(float height, float cosZenith, float result[3]) const {
+    float u = (std::clamp(cosZenith, -1.0f, 1.0f) + 1.0f) * 0.5f * (TRANSMITTANCE_WIDTH - 1);
+    float v = std::sqrt(std::clamp(height / (TOP_RADIUS - GROUND_RADIUS), 0.0f, 1.0f)) * (TRANSMITTANCE_HEIGHT - 1);
+    int x0 = std::min(static_cast<int>(u), TRANSMITTANCE_WIDTH - 2);
+    int y0 = std::min(static_cast<int>(v), TRANSMITTANCE_HEIGHT - 2);
+    float fx = u - x0;
+    float fy = v - y0;
+
+    const float* t00 = &transmittance[(y0 * TRANSMITTANCE_WIDTH + x0) * 3];
+    const float* t10 = t00 + 3;
+    const float* t01 = t00 + TRANSMITTANCE_WIDTH * 3;
+    const float* t11 = t01 + 3;
+    for (int c = 0; c < 3; ++c) {
+        float top = t00[c] + (t10[c] - t00[c]) * fx;
+        float bottom = t01[c] + (t11[c] - t01[c]) * fx;
+        result[c] = top + (bottom - top) * fy;
+    }
+}
+
+void Atmosphere::ComputeSky() {
+    sky.assign(SKY_WIDTH * SKY_HEIGHT * SKY_DEPTH * 3, 0.0f);
+    const float observerRadius = GROUND_RADIUS + OBSERVER_HEIGHT;
+
+    for (int z = 0; z < SKY_DEPTH; ++z) {
+        float sunElevation = MIN_SUN_ELEVATION + (PI * 0.5f - MIN_SUN_ELEVATION) * z / (SKY_DEPTH - 1);
+        float sunDirection[3] = { std::cos(sunElevation), std::sin(sunElevation), 0.0f };
+
+        for (int y = 0; y < SKY_HEIGHT; ++y) {
+            float elevation = ViewElevation(static_cast<float>(y) / (SKY_HEIGHT - 1));
+            float mu = std::sin(elevation);
+            float ground = DistanceToGround(observerRadius, mu);
+            float distance = ground >= 0.0f ? ground : DistanceToTop(observerRadius, mu);
+            float step = distance / SKY_STEPS;
+
+            for (int x = 0; x < SKY_WIDTH; ++x) {
+                float azimuth = PI * x / (SKY_WIDTH - 1);
+                float view[3] = { std::cos(elevation) * std::cos(azimuth), mu, std::cos(elevation) * std::sin(azimuth) };
+                float cosTheta = view[0] * sunDirection[0] + view[1] * sunDirection[1];
+                float rayleighPhase = RayleighPhase(cosTheta);
+                float miePhase = MiePhase(cosTheta);
+
+                float radiance[3] = { 0.0f, 0.0f, 0.0f };
+                float throughput[3] = { 1.0f, 1.0f, 1.0f };
+                for (int i = 0; i < SKY_STEPS; ++i) {
+                    float t = (i + 0.5f) * step;
+                    float position[3] = { view[0] * t, observerRadius + view[1] * t, view[2] * t };
+                    float r = std::sqrt(position[0] * position[0] + position[1] * position[1] + position[2] * position[2]);
+                    float height = r - GROUND_RADIUS;
+                    float sunCosZenith = (position[0] * sunDirection[0] + position[1] * sunDirection[1]) / r;
+
+                    float sunTransmittance[3];
+                    SampleTransmittance(height, sunCosZenith, sunTransmittance);
+                    Medium medium = SampleMedium(height);
+
+                    for (int c = 0; c < 3; ++c) {
+                        float scattered = (medium.scattering[c] * rayleighPhase + medium.mie * miePhase) * sunTransmittance[c];
+                        // Analytic integral of the in-scattering over the step
+                        float stepTransmittance = std::exp(-medium.extinction[c] * step);
+                        radiance[c] += throughput[c] * scattered * (1.0f - stepTransmittance) / medium.extinction[c];
+                        throughput[c] *= stepTransmittance;
+                    }
+                }
+
+                float* texel = &sky[((z * SKY_HEIGHT + y) * SKY_WIDTH + x) * 3];
+                std::copy(radiance, radiance + 3, texel);
+            }
+        }
+    }
+}
+
+uint64_t Atmosphere::GetCacheKey() {
+    // Any change to the model or the table layout invalidates the cache
+    std::ostringstream description;
+    description << GROUND_RADIUS << ' ' << TOP_RADIUS << ' ' << OBSERVER_HEIGHT << ' '
+                << RAYLEIGH_SCATTERING[0] << ' ' << RAYLEIGH_SCATTERING[1] << ' ' << RAYLEIGH_SCATTERING[2] << ' '
+                << RAYLEIGH_SCALE_HEIGHT << ' ' << MIE_SCATTERING << ' ' << MIE_EXTINCTION << ' '
+                << MIE_SCALE_HEIGHT << ' ' << MIE_G << ' ' << OZONE_ABSORPTION[0] << ' ' << OZONE_ABSORPTION[1] << ' '
+                << OZONE_ABSORPTION[2] << ' ' << OZONE_CENTER << ' ' << OZONE_HALF_WIDTH << ' '
+                << TRANSMITTANCE_WIDTH << ' ' << TRANSMITTANCE_HEIGHT << ' ' << SKY_WIDTH << ' ' << SKY_HEIGHT << ' '
+                << SKY_DEPTH << ' ' << MIN_SUN_ELEVATION << ' ' << TRANSMITTANCE_STEPS << ' ' << SKY_STEPS;
+
+    std::string text = description.str();
+    return HashBytes(text.data(), text.size());
+}
+
+bool Atmosphere::LoadCache() {
+    if (cachePath.empty()) {
+        return false;
+    }
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    CacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    bool valid = file && std::equal(header.magic, header.magic + 4, CACHE_MAGIC) &&
+                 header.version == CACHE_VERSION && header.key == GetCacheKey();
+    if (valid) {
+        transmittance.resize(TRANSMITTANCE_WIDTH * TRANSMITTANCE_HEIGHT * 3);
+        sky.resize(SKY_WIDTH * SKY_HEIGHT * SKY_DEPTH * 3);
+        file.read(reinterpret_cast<char*>(transmittance.data()), transmittance.size() * sizeof(float));
+        file.read(reinterpret_cast<char*>(sky.data()), sky.size() * sizeof(float));
+        valid = static_cast<bool>(file);
+    }
+
+    if (!valid) {
+        // Truncated or from an older model; rebuilt and rewritten below
+        transmittance.clear();
+        sky.clear();
+        return false;
+    }
+    return true;
+}
+
+void Atmosphere::StoreCache() const {
+    if (cachePath.empty()) {
+        return;
+    }
+
+    bool written = FileUtils::WriteFileAtomic(cachePath, [&](std::ostream& file) {
+        CacheHeader header;
+        std::copy(CACHE_MAGIC, CACHE_MAGIC + 4, header.magic);
+        header.version = CACHE_VERSION;
+        header.key = GetCacheKey();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(transmittance.data()), transmittance.size() * sizeof(float));
+        file.write(reinterpret_cast<const char*>(sky.data()), sky.size() * sizeof(float));
+        return true;
+    });
+    if (!written) {
+        std::cerr << "Failed to write atmosphere cache: " << cachePath << std::endl;
+    }
+}
@@ -0,0 +1,172 @@
+#include "Engine/GeometryArena.h"
+#include "Engine/Mesh.h"
+#include <numeric>
+
+bool GeometryArena::FreeList::Allocate(GLuint count, GLuint& offset) {
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        Range& range = ranges[i];
+        if (range.count < count) {
+            continue;
+        }
+
+        offset = range.offset;
+        range.offset += count;
+        range.count -= count;
+        if (range.count == 0) {
+            ranges.erase(ranges.begin() + i);
+        }
+        return true;
+    }
+    return false;
+}
+
+void GeometryArena::FreeList::Free(GLuint offset, GLuint count) {
+    // Ranges are kept sorted by offset so neighbours can be merged
+    auto it = ranges.begin();
+    while (it != ranges.end() && it->offset < offset) {
+        ++it;
+    }
+    it = ranges.insert(it, { offset, count });
+
+    auto next = it + 1;
+    if (next != ranges.end() && it->offset + it->count == next->offset) {
+        it->count += next->count;
+        ranges.erase(next);
+    }
+    if (it != ranges.begin()) {
+        auto prev = it - 1;
+        if (prev->offset + prev->count == it->offset) {
+            prev->count += it->count;
+            ranges.erase(it);
+        }
+    }
+}
+
+GeometryArena::GeometryArena(GLuint verticesPerPage, GLuint indicesPerPage)
+    : verticesPerPage(verticesPerPage), indicesPerPage(indicesPerPage), drawIdBuffer(0), usedBytes(0) {
+    std::vector<GLuint> drawIds(MAX_DRAWS);
+    std::iota(drawIds.begin(), drawIds.end(), 0u);
+
+    glGenBuffers(1, &drawIdBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+    glBufferData(GL_ARRAY_BUFFER, drawIds.size() * sizeof(GLuint), drawIds.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+GeometryArena::~GeometryArena() {
+    for (auto& page : pages) {
+        DeletePage(*page);
+    }
+    if (drawIdBuffer != 0) {
+        glDeleteBuffers(1, &drawIdBuffer);
+    }
+}
+
+GeometryArena::Allocation GeometryArena::Allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    Allocation allocation;
+    GLuint vertexCount = static_cast<GLuint>(vertices.size());
+    GLuint indexCount = static_cast<GLuint>(indices.size());
+    if (vertexCount == 0 || indexCount == 0 || vertexCount > verticesPerPage || indexCount > indicesPerPage) {
+        return allocation;
+    }
+
+    for (size_t i = 0; i <= pages.size(); ++i) {
+        Page& page = i < pages.size() ? *pages[i] : CreatePage();
+
+        GLuint baseVertex, firstIndex;
+        if (!page.freeVertices.Allocate(vertexCount, baseVertex)) {
+            continue;
+        }
+        if (!page.freeIndices.Allocate(indexCount, firstIndex)) {
+            page.freeVertices.Free(baseVertex, vertexCount);
+            continue;
+        }
+
+        // Indices stay mesh-relative; the indirect command supplies baseVertex
+        glBindBuffer(GL_ARRAY_BUFFER, page.vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, baseVertex * sizeof(Vertex), vertexCount * sizeof(Vertex), vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page.ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, firstIndex * sizeof(unsigned int), indexCount * sizeof(unsigned int), indices.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        allocation.page = static_cast<int>(i);
+        allocation.baseVertex = baseVertex;
+        allocation.vertexCount = vertexCount;
+        allocation.firstIndex = firstIndex;
+        allocation.indexCount = indexCount;
+        usedBytes += vertexCount * sizeof(Vertex) + indexCount * sizeof(unsigned int);
+        return allocation;
+    }
+
+    return allocation;
+}
+
+void GeometryArena::Free(const Allocation& allocation) {
+    if (!allocation.IsValid() || allocation.page >= static_cast<int>(pages.size())) {
+        return;
+    }
+
+    Page& page = *pages[allocation.page];
+    page.freeVertices.Free(allocation.baseVertex, allocation.vertexCount);
+    page.freeIndices.Free(allocation.firstIndex, allocation.indexCount);
+    usedBytes -= allocation.vertexCount * sizeof(Vertex) + allocation.indexCount * sizeof(unsigned int);
+}
+
+void GeometryArena::Update(const Allocation& allocation, GLuint firstVertex, GLuint count, const Vertex* vertices) {
+    if (!allocation.IsValid() || allocation.page >= static_cast<int>(pages.size()) ||
+        firstVertex + count > allocation.vertexCount) {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, pages[allocation.page]->vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, (allocation.baseVertex + firstVertex) * sizeof(Vertex), count * sizeof(Vertex), vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryArena::BindPage(int page) const {
+    glBindVertexArray(pages[page]->vao);
+}
+
+GeometryArena::Page& GeometryArena::CreatePage() {
+    auto page = std::make_unique<Page>();
+    page->freeVertices.ranges.push_back({ 0, verticesPerPage });
+    page->freeIndices.ranges.push_back({ 0, indicesPerPage });
+
+    glGenVertexArrays(1, &page->vao);
+    glGenBuffers(1, &page->vbo);
+    glGenBuffers(1, &page->ebo);
+
+    glBindVertexArray(page->vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, page->vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(verticesPerPage) * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indicesPerPage) * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+    // Same layout as Mesh::SetupMesh
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+
+    // Draw ID, advanced once per instance starting at the command's baseInstance
+    glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+    glEnableVertexAttribArray(DRAW_ID_LOCATION);
+    glVertexAttribIPointer(DRAW_ID_LOCATION, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+    glVertexAttribDivisor(DRAW_ID_LOCATION, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    pages.push_back(std::move(page));
+    return *pages.back();
+}
+
+void GeometryArena::DeletePage(Page& page) {
+    glDeleteVertexArrays(1, &page.vao);
+    glDeleteBuffers(1, &page.vbo);
+    glDeleteBuffers(1, &page.ebo);
+}
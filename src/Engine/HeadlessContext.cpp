@@ -0,0 +1,122 @@
+#include "Engine/HeadlessContext.h"
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+HeadlessContext::HeadlessContext()
+    : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT), surface(EGL_NO_SURFACE) {
+}
+
+HeadlessContext::~HeadlessContext() {
+    Destroy();
+}
+
+EGLDisplay HeadlessContext::OpenDisplay() {
+    // Mesa's surfaceless platform needs no X or Wayland server at all
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+    if (getPlatformDisplay && clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        EGLDisplay surfaceless = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (surfaceless != EGL_NO_DISPLAY && eglInitialize(surfaceless, nullptr, nullptr)) {
+            description = "EGL surfaceless platform";
+            return surfaceless;
+        }
+    }
+
+    EGLDisplay defaultDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (defaultDisplay != EGL_NO_DISPLAY && eglInitialize(defaultDisplay, nullptr, nullptr)) {
+        description = "EGL default display";
+        return defaultDisplay;
+    }
+
+    return EGL_NO_DISPLAY;
+}
+
+bool HeadlessContext::Initialize() {
+    display = OpenDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        std::cerr << "Failed to open an EGL display" << std::endl;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL does not support desktop OpenGL" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        std::cerr << "No suitable EGL config found" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "Failed to create an OpenGL 4.3 core context via EGL" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    // Without EGL_KHR_surfaceless_context a dummy pbuffer has to be current
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (!extensions || !std::strstr(extensions, "EGL_KHR_surfaceless_context")) {
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
+        if (surface == EGL_NO_SURFACE) {
+            std::cerr << "Failed to create an EGL pbuffer surface" << std::endl;
+            Destroy();
+            return false;
+        }
+        description += " (pbuffer)";
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        std::cerr << "Failed to make the EGL context current" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    return true;
+}
+
+void HeadlessContext::Destroy() {
+    if (display == EGL_NO_DISPLAY) {
+        return;
+    }
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != EGL_NO_SURFACE) {
+        eglDestroySurface(display, surface);
+        surface = EGL_NO_SURFACE;
+    }
+    if (context != EGL_NO_CONTEXT) {
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+}
@@ -9,7 +9,7 @@ Light::Light(LightType type, const glm::vec3& pos, const glm::vec3& dir)
       constant(1.0f), linear(0.09f), quadratic(0.032f),
       cutOff(12.5f), outerCutOff(17.5f),
       shadowsEnabled(false), shadowMapSize(1024),
-      shadowMapFBO(0), shadowMapTexture(0) {
+      shadowMapFBO(0), shadowMapTexture(0), dirty(true) {
     
     // Initialize shadow mapping for directional and spot lights
     if (type == LightType::DIRECTIONAL || type == LightType::SPOT) {
@@ -28,18 +28,22 @@ Light::~Light() {
 
 void Light::SetPosition(const glm::vec3& pos) {
     position = pos;
+    dirty = true;
 }
 
 void Light::SetDirection(const glm::vec3& dir) {
     direction = glm::normalize(dir);
+    dirty = true;
 }
 
 void Light::SetColor(const glm::vec3& col) {
     color = col;
+    dirty = true;
 }
 
 void Light::SetIntensity(float inten) {
     intensity = inten;
+    dirty = true;
 }
 
 void Light::SetAmbient(float amb) {
@@ -58,11 +62,13 @@ void Light::SetAttenuation(float c, float l, float q) {
     constant = c;
     linear = l;
     quadratic = q;
+    dirty = true;
 }
 
 void Light::SetSpotAngles(float cutoff, float outerCutoff) {
     cutOff = cutoff;
     outerCutOff = outerCutoff;
+    dirty = true;
 }
 
 void Light::EnableShadows(bool enable) {
@@ -118,9 +124,20 @@ void Light::Update(float deltaTime) {
             position.y = radius * sin(sunAngle);
             direction = glm::normalize(-position);
         }
+        dirty = true;
     }
 }
 
+void Light::WriteGPUData(GPULight& data) const {
+    data.positionType = glm::vec4(position, static_cast<float>(type));
+    data.direction = glm::vec4(direction, 0.0f);
+    data.colorIntensity = glm::vec4(color, intensity);
+    data.attenuation = glm::vec4(constant, linear, quadratic, 0.0f);
+    
+    // The shader compares against dot products, so store cosines
+    data.spot = glm::vec4(cos(glm::radians(cutOff)), cos(glm::radians(outerCutOff)), 0.0f, 0.0f);
+}
+
 void Light::InitializeShadowMapping() {
     // Create shadow map texture
     glGenTextures(1, &shadowMapTexture);
@@ -1,13 +1,18 @@
 #include "Engine/Mesh.h"
+#include "Engine/GeometryArena.h"
 #include <GL/glew.h>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
 
 Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
-    : vertices(vertices), indices(indices), vao(0), vbo(0), ebo(0) {
+    : vertices(vertices), indices(indices), vao(0), vbo(0), ebo(0), arena(nullptr) {
     SetupMesh();
 }
 
 Mesh::~Mesh() {
+    if (arena) {
+        arena->Free(arenaAllocation);
+    }
     if (vao != 0) {
         glDeleteVertexArrays(1, &vao);
     }
@@ -20,6 +25,9 @@ Mesh::~Mesh() {
 }
 
 void Mesh::SetupMesh() {
+    // Local-space bounds are computed once here; Model transforms them on demand
+    CalculateBoundingBox();
+    
     // Create vertex array object
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
@@ -51,6 +59,24 @@ void Mesh::SetupMesh() {
     glBindVertexArray(0);
 }
 
+void Mesh::CalculateBoundingBox() {
+    if (vertices.empty()) {
+        boundingBoxMin = glm::vec3(0.0f);
+        boundingBoxMax = glm::vec3(0.0f);
+        boundingRadius = 0.0f;
+        return;
+    }
+    
+    boundingBoxMin = vertices[0].position;
+    boundingBoxMax = vertices[0].position;
+    for (const auto& vertex : vertices) {
+        boundingBoxMin = glm::min(boundingBoxMin, vertex.position);
+        boundingBoxMax = glm::max(boundingBoxMax, vertex.position);
+    }
+    
+    boundingRadius = glm::length(boundingBoxMax - boundingBoxMin) * 0.5f;
+}
+
 void Mesh::Draw() const {
     glBindVertexArray(vao);
     glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
@@ -63,6 +89,108 @@ void Mesh::DrawInstanced(unsigned int instanceCount) const {
     glBindVertexArray(0);
 }
 
+void Mesh::DrawBound(GLuint drawId, unsigned int instanceCount) const {
+    GLsizei count = static_cast<GLsizei>(indices.size());
+    if (arena) {
+        const void* firstIndex = (void*)(arenaAllocation.firstIndex * sizeof(unsigned int));
+        if (drawId < GeometryArena::MAX_DRAWS) {
+            // The page's draw ID attribute has divisor 1 and holds 0, 1, 2, ...
+            glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, count, GL_UNSIGNED_INT, firstIndex,
+                                                          std::max(instanceCount, 1u), arenaAllocation.baseVertex, drawId);
+            return;
+        }
+        
+        // Past the end of the draw ID buffer: switch the page's array off for
+        // this draw so the generic attribute value is read instead
+        glDisableVertexAttribArray(GeometryArena::DRAW_ID_LOCATION);
+        glVertexAttribI1ui(GeometryArena::DRAW_ID_LOCATION, drawId);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, firstIndex,
+                                          std::max(instanceCount, 1u), arenaAllocation.baseVertex);
+        glEnableVertexAttribArray(GeometryArena::DRAW_ID_LOCATION);
+        return;
+    }
+    
+    // Our own VAO leaves the draw ID array disabled, so the current generic
+    // attribute value is read instead
+    glVertexAttribI1ui(GeometryArena::DRAW_ID_LOCATION, drawId);
+    if (instanceCount > 0) {
+        glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, 0, instanceCount);
+    } else {
+        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, 0);
+    }
+}
+
+void Mesh::Bind() const {
+    if (arena) {
+        arena->BindPage(arenaAllocation.page);
+    } else {
+        glBindVertexArray(vao);
+    }
+}
+
+GLuint Mesh::GetBindKey() const {
+    return arena ? arena->GetPageVAO(arenaAllocation.page) : vao;
+}
+
+void Mesh::Unbind() const {
+    glBindVertexArray(0);
+}
+
+bool Mesh::MoveToArena(GeometryArena& geometryArena) {
+    if (arena) {
+        return true;
+    }
+    
+    arenaAllocation = geometryArena.Allocate(vertices, indices);
+    if (!arenaAllocation.IsValid()) {
+        return false;
+    }
+    arena = &geometryArena;
+    
+    // The CPU copy is kept for bounds and picking
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+    vao = vbo = ebo = 0;
+    return true;
+}
+
+void Mesh::UpdateVertexBuffer(size_t first, size_t count, const Vertex* data) {
+    if (count == 0 || first + count > vertices.size()) {
+        return;
+    }
+    std::copy(data, data + count, vertices.begin() + first);
+    CalculateBoundingBox();
+    
+    if (arena) {
+        arena->Update(arenaAllocation, static_cast<GLuint>(first), static_cast<GLuint>(count), &vertices[first]);
+    } else if (vbo != 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(Vertex), count * sizeof(Vertex), &vertices[first]);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void Mesh::SetInstanceBuffer(GLuint instanceBuffer) {
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    
+    // Instance transform (a mat4 occupies four consecutive vec4 slots)
+    for (GLuint i = 0; i < 4; ++i) {
+        glEnableVertexAttribArray(3 + i);
+        glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(offsetof(InstanceData, transform) + i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + i, 1);
+    }
+    
+    // Instance state
+    glEnableVertexAttribArray(7);
+    glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, state));
+    glVertexAttribDivisor(7, 1);
+    
+    glBindVertexArray(0);
+}
+
 const std::vector<Vertex>& Mesh::GetVertices() const {
     return vertices;
 }
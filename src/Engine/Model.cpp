@@ -3,8 +3,12 @@
 #include "Engine/Material.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <cmath>
+#include <limits>
 
-Model::Model() : position(0.0f), rotation(0.0f), scale(1.0f) {
+Model::Model() : position(0.0f), rotation(0.0f), scale(1.0f), boundsDirty(true),
+                 instanceCount(0), hasInstanceBounds(false), instanceBoundsMin(0.0f), instanceBoundsMax(0.0f),
+                 visible(true), isStatic(false) {
     transform = glm::mat4(1.0f);
     UpdateTransform();
 }
@@ -14,6 +18,7 @@ Model::~Model() {
 
 void Model::AddMesh(std::shared_ptr<Mesh> mesh) {
     meshes.push_back(mesh);
+    boundsDirty = true;
 }
 
 void Model::SetPosition(const glm::vec3& pos) {
@@ -33,6 +38,15 @@ void Model::SetScale(const glm::vec3& scl) {
 
 void Model::SetTransform(const glm::mat4& trans) {
     transform = trans;
+    boundsDirty = true;
+}
+
+void Model::SetInstanceBounds(const glm::vec3& localMin, const glm::vec3& localMax) {
+    // Model-space box around every instance; replaces the per-mesh boxes in UpdateBounds()
+    instanceBoundsMin = localMin;
+    instanceBoundsMax = localMax;
+    hasInstanceBounds = true;
+    boundsDirty = true;
 }
 
 void Model::SetMaterial(const Material& mat) {
@@ -56,6 +70,7 @@ void Model::UpdateTransform() {
     transform = glm::rotate(transform, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
     transform = glm::rotate(transform, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
     transform = glm::scale(transform, scale);
+    boundsDirty = true;
 }
 
 glm::mat4 Model::GetTransform() const {
@@ -83,35 +98,63 @@ const std::vector<std::shared_ptr<Mesh>>& Model::GetMeshes() const {
 }
 
 glm::vec3 Model::GetBoundingBoxMin() const {
-    if (meshes.empty()) return glm::vec3(0.0f);
-    
-    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
-    for (const auto& mesh : meshes) {
-        for (const auto& vertex : mesh->GetVertices()) {
-            glm::vec3 worldPos = glm::vec3(transform * glm::vec4(vertex.position, 1.0f));
-            min = glm::min(min, worldPos);
-        }
-    }
-    return min;
+    if (boundsDirty) UpdateBounds();
+    return boundingBoxMin;
 }
 
 glm::vec3 Model::GetBoundingBoxMax() const {
-    if (meshes.empty()) return glm::vec3(0.0f);
-    
-    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
-    for (const auto& mesh : meshes) {
-        for (const auto& vertex : mesh->GetVertices()) {
-            glm::vec3 worldPos = glm::vec3(transform * glm::vec4(vertex.position, 1.0f));
-            max = glm::max(max, worldPos);
-        }
-    }
-    return max;
+    if (boundsDirty) UpdateBounds();
+    return boundingBoxMax;
+}
+
+glm::vec3 Model::GetBoundingSphereCenter() const {
+    if (boundsDirty) UpdateBounds();
+    return boundingSphereCenter;
 }
 
 float Model::GetBoundingSphereRadius() const {
-    glm::vec3 min = GetBoundingBoxMin();
-    glm::vec3 max = GetBoundingBoxMax();
-    glm::vec3 center = (min + max) * 0.5f;
-    float radius = glm::length(max - center);
-    return radius;
+    if (boundsDirty) UpdateBounds();
+    return boundingRadius;
+}
+
+void Model::UpdateBounds() const {
+    boundsDirty = false;
+    
+    if (meshes.empty()) {
+        boundingBoxMin = boundingBoxMax = boundingSphereCenter = glm::vec3(transform[3]);
+        boundingRadius = 0.0f;
+        return;
+    }
+    
+    boundingBoxMin = glm::vec3(std::numeric_limits<float>::max());
+    boundingBoxMax = glm::vec3(-std::numeric_limits<float>::max());
+    
+    // Transform each local AABB as center + extents (Arvo's method), so the
+    // cost is per mesh rather than per vertex
+    auto addLocalBox = [this](const glm::vec3& localMin, const glm::vec3& localMax) {
+        glm::vec3 center = (localMin + localMax) * 0.5f;
+        glm::vec3 extent = (localMax - localMin) * 0.5f;
+        
+        glm::vec3 worldCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+        glm::vec3 worldExtent;
+        for (int row = 0; row < 3; ++row) {
+            worldExtent[row] = std::abs(transform[0][row]) * extent.x +
+                               std::abs(transform[1][row]) * extent.y +
+                               std::abs(transform[2][row]) * extent.z;
+        }
+        
+        boundingBoxMin = glm::min(boundingBoxMin, worldCenter - worldExtent);
+        boundingBoxMax = glm::max(boundingBoxMax, worldCenter + worldExtent);
+    };
+    
+    if (hasInstanceBounds) {
+        addLocalBox(instanceBoundsMin, instanceBoundsMax);
+    } else {
+        for (const auto& mesh : meshes) {
+            addLocalBox(mesh->GetBoundingBoxMin(), mesh->GetBoundingBoxMax());
+        }
+    }
+    
+    boundingSphereCenter = (boundingBoxMin + boundingBoxMax) * 0.5f;
+    boundingRadius = glm::length(boundingBoxMax - boundingSphereCenter);
 }
@@ -0,0 +1,232 @@
+#include "Engine/Profiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+void Profiler::History::Add(float ms) {
+    samples[next] = ms;
+    next = (next + 1) % HISTORY_SIZE;
+    count = std::min(count + 1, HISTORY_SIZE);
+}
+
+Profiler::Stats Profiler::History::Compute() const {
+    Stats stats = { 0.0f, 0.0f, 0.0f };
+    if (count == 0) {
+        return stats;
+    }
+
+    float sorted[HISTORY_SIZE];
+    std::copy(samples, samples + count, sorted);
+    std::sort(sorted, sorted + count);
+
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        sum += sorted[i];
+    }
+    stats.minMs = sorted[0];
+    stats.avgMs = sum / count;
+    stats.p99Ms = sorted[std::min(count - 1, static_cast<int>(count * 0.99f))];
+    return stats;
+}
+
+Profiler& Profiler::Instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : enabled(true), inFrame(false), frameIndex(0) {
+}
+
+Profiler::~Profiler() {
+    // GL objects are released in Shutdown(); the context is gone by now
+}
+
+void Profiler::Shutdown() {
+    for (Section& section : sections) {
+        if (section.hasGpu) {
+            glDeleteQueries(QUERY_RING_SIZE, section.queries);
+            section.hasGpu = false;
+        }
+    }
+}
+
+void Profiler::BeginFrame() {
+    if (!enabled) return;
+
+    // Frame time is start-to-start, so it includes present and event handling
+    Clock::time_point now = Clock::now();
+    if (frameIndex > 0) {
+        frameTimes.Add(std::chrono::duration<float, std::milli>(now - frameStart).count());
+    }
+    frameStart = now;
+    frameIndex++;
+    inFrame = true;
+
+    CollectGpuResults();
+    for (Section& section : sections) {
+        section.cpuFrameMs = -1.0f;
+        section.gpuUsedThisFrame = false;
+    }
+}
+
+void Profiler::EndFrame() {
+    if (!enabled || !inFrame) return;
+    inFrame = false;
+
+    for (Section& section : sections) {
+        if (section.cpuFrameMs >= 0.0f) {
+            section.cpu.Add(section.cpuFrameMs);
+        }
+    }
+}
+
+int Profiler::FindOrCreateSection(const char* name) {
+    auto cached = sectionByPointer.find(name);
+    if (cached != sectionByPointer.end()) {
+        return cached->second;
+    }
+    auto it = sectionIndex.find(name);
+    if (it != sectionIndex.end()) {
+        sectionByPointer.emplace(name, it->second);
+        return it->second;
+    }
+
+    Section section;
+    section.name = name;
+    section.cpuFrameMs = -1.0f;
+    section.gpuUsedThisFrame = false;
+    section.hasGpu = false;
+    std::fill(section.queries, section.queries + QUERY_RING_SIZE, 0u);
+    std::fill(section.queryPending, section.queryPending + QUERY_RING_SIZE, false);
+
+    int index = static_cast<int>(sections.size());
+    sections.push_back(section);
+    sectionIndex.emplace(name, index);
+    sectionByPointer.emplace(name, index);
+    return index;
+}
+
+int Profiler::BeginCpu(const char* name) {
+    if (!enabled) return -1;
+
+    int index = FindOrCreateSection(name);
+    sections[index].cpuStart = Clock::now();
+    return index;
+}
+
+void Profiler::EndCpu(int index) {
+    if (index < 0) return;
+
+    Section& section = sections[index];
+    float ms = std::chrono::duration<float, std::milli>(Clock::now() - section.cpuStart).count();
+    section.cpuFrameMs = std::max(section.cpuFrameMs, 0.0f) + ms;
+}
+
+int Profiler::BeginGpu(const char* name) {
+    if (!enabled) return -1;
+
+    int index = FindOrCreateSection(name);
+    Section& section = sections[index];
+    if (!section.hasGpu) {
+        glGenQueries(QUERY_RING_SIZE, section.queries);
+        section.hasGpu = true;
+    }
+
+    // One query per section per frame, and never reuse a query whose result
+    // has not been collected yet (the GPU is more than a ring behind)
+    int slot = static_cast<int>(frameIndex % QUERY_RING_SIZE);
+    if (section.gpuUsedThisFrame || section.queryPending[slot]) {
+        return -1;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, section.queries[slot]);
+    return index;
+}
+
+void Profiler::EndGpu(int index) {
+    if (index < 0) return;
+
+    Section& section = sections[index];
+    int slot = static_cast<int>(frameIndex % QUERY_RING_SIZE);
+    glEndQuery(GL_TIME_ELAPSED);
+    section.queryPending[slot] = true;
+    section.gpuUsedThisFrame = true;
+}
+
+void Profiler::CollectGpuResults() {
+    for (Section& section : sections) {
+        if (!section.hasGpu) continue;
+
+        // Oldest slot first so samples enter the history in frame order
+        for (int i = 1; i <= QUERY_RING_SIZE; ++i) {
+            int slot = static_cast<int>((frameIndex + i) % QUERY_RING_SIZE);
+            if (!section.queryPending[slot]) continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(section.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(section.queries[slot], GL_QUERY_RESULT, &elapsedNs);
+            section.gpu.Add(static_cast<float>(elapsedNs) / 1.0e6f);
+            section.queryPending[slot] = false;
+        }
+    }
+}
+
+void Profiler::SetCounter(const char* name, long long value) {
+    if (!enabled) return;
+
+    for (auto& counter : counters) {
+        if (counter.first == name) {
+            counter.second = value;
+            return;
+        }
+    }
+    counters.emplace_back(name, value);
+}
+
+Profiler::FrameReport Profiler::GetReport() const {
+    FrameReport report;
+    report.frame = frameTimes.Compute();
+    report.fps = report.frame.avgMs > 0.0f ? 1000.0f / report.frame.avgMs : 0.0f;
+    report.counters = counters;
+
+    for (const Section& section : sections) {
+        SectionReport sectionReport;
+        sectionReport.name = section.name;
+        sectionReport.cpu = section.cpu.Compute();
+        sectionReport.gpu = section.gpu.Compute();
+        sectionReport.hasGpu = section.gpu.count > 0;
+        report.sections.push_back(sectionReport);
+    }
+    return report;
+}
+
+std::string Profiler::FormatReport() const {
+    FrameReport report = GetReport();
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+
+    out << "Frame: " << report.fps << " FPS | avg " << report.frame.avgMs << " ms, min "
+        << report.frame.minMs << " ms, p99 " << report.frame.p99Ms << " ms\n";
+
+    for (const SectionReport& section : report.sections) {
+        out << "  " << std::left << std::setw(16) << section.name << std::right
+            << " CPU avg " << std::setw(6) << section.cpu.avgMs << " p99 " << std::setw(6) << section.cpu.p99Ms;
+        if (section.hasGpu) {
+            out << " | GPU avg " << std::setw(6) << section.gpu.avgMs << " p99 " << std::setw(6) << section.gpu.p99Ms;
+        }
+        out << " ms\n";
+    }
+
+    if (!report.counters.empty()) {
+        const char* separator = "  ";
+        for (const auto& counter : report.counters) {
+            out << separator << counter.first << ": " << counter.second;
+            separator = " | ";
+        }
+        out << "\n";
+    }
+    return out.str();
+}
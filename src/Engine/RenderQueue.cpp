@@ -0,0 +1,202 @@
+#include "Engine/RenderQueue.h"
+#include "Engine/Shader.h"
+#include "Engine/Model.h"
+#include "Engine/Mesh.h"
+#include "Engine/UniformRing.h"
+#include "Engine/TraceRecorder.h"
+#include "Utils/Hash.h"
+#include <algorithm>
+
+bool RenderQueue::MaterialKey::operator==(const MaterialKey& other) const {
+    return albedo == other.albedo && metallic == other.metallic &&
+           roughness == other.roughness && ao == other.ao &&
+           std::equal(textures, textures + Material::TEXTURE_UNIT_COUNT, other.textures);
+}
+
+size_t RenderQueue::MaterialKeyHash::operator()(const MaterialKey& key) const {
+    // Raw float bits, then the texture pointers
+    const float values[6] = { key.albedo.x, key.albedo.y, key.albedo.z, key.metallic, key.roughness, key.ao };
+    uint64_t hash = HashBytes(values, sizeof(values));
+    hash = HashBytes(key.textures, sizeof(key.textures), hash);
+    return static_cast<size_t>(hash);
+}
+
+RenderQueue::RenderQueue() {
+    ResetStats();
+}
+
+void RenderQueue::Clear() {
+    items.clear();
+    materialIds.clear();
+}
+
+void RenderQueue::ResetStats() {
+    stats = {};
+}
+
+void RenderQueue::Add(Pass pass, uint8_t shaderIndex, const Model& model, float depth, float maxDepth) {
+    uint64_t materialId = 0;
+    if (pass == Pass::MAIN) {
+        materialId = InternMaterial(model.GetMaterial());
+    }
+
+    float normalizedDepth = maxDepth > 0.0f ? std::clamp(depth / maxDepth, 0.0f, 1.0f) : 0.0f;
+    uint64_t depthBits = static_cast<uint64_t>(normalizedDepth * DEPTH_MASK);
+
+    uint64_t baseKey = (static_cast<uint64_t>(pass) << PASS_SHIFT) |
+                       (static_cast<uint64_t>(shaderIndex) << SHADER_SHIFT) |
+                       (materialId << MATERIAL_SHIFT) |
+                       depthBits;
+
+    for (const auto& mesh : model.GetMeshes()) {
+        // Arena meshes sort by their page, the VAO they are drawn with
+        uint64_t meshId = mesh->GetBindKey() & 0xFFFF;
+        items.push_back({ baseKey | (meshId << MESH_SHIFT), &model, mesh.get() });
+    }
+}
+
+void RenderQueue::Sort() {
+    TRACE_SCOPE("RenderQueue::Sort");
+    RadixSort();
+}
+
+void RenderQueue::Submit(Shader* const* shaders, const ShaderSetup& setup, UniformRing& ring,
+                         const MaterialSetup& materialSetup) {
+    if (items.empty()) {
+        return;
+    }
+
+    // One draw data entry per run of items from the same model
+    UniformRing::Allocation allocation = ring.Allocate(items.size() * sizeof(GPUDrawData));
+    GPUDrawData* data = static_cast<GPUDrawData*>(allocation.data);
+
+    drawIds.resize(items.size());
+    GLuint drawCount = 0;
+    const Model* lastModel = nullptr;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (items[i].model != lastModel) {
+            WriteDrawData(*items[i].model, data[drawCount++]);
+            lastModel = items[i].model;
+        }
+        drawIds[i] = drawCount - 1;
+    }
+
+    GLsizeiptr size = drawCount * sizeof(GPUDrawData);
+    ring.Commit(allocation, size);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, allocation.buffer, allocation.offset, size);
+
+    Shader* shader = nullptr;
+    uint64_t lastShader = ~0ull;
+    GLuint lastVAO = 0;
+    uint64_t lastMaterial = ~0ull;
+
+    stats.items += static_cast<int>(items.size());
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        const DrawItem& item = items[i];
+        uint64_t shaderIndex = (item.key >> SHADER_SHIFT) & 0xFF;
+        if (shaderIndex != lastShader) {
+            shader = shaders[shaderIndex];
+            shader->Use();
+            setup(*shader);
+            lastShader = shaderIndex;
+            stats.programBinds++;
+        } else {
+            stats.programBindsSkipped++;
+        }
+
+        // Items sharing material values and maps are adjacent and share an
+        // interned id, so texture binds follow the material runs
+        uint64_t materialId = (item.key >> MATERIAL_SHIFT) & 0xFFFF;
+        if (materialSetup) {
+            if (materialId != lastMaterial || materialId == UNBATCHED_MATERIAL) {
+                materialSetup(item.model->GetMaterial());
+                lastMaterial = materialId;
+                stats.materialBinds++;
+            } else {
+                stats.materialBindsSkipped++;
+            }
+        }
+
+        // Static meshes the shadow pass moved into the arena come through here
+        // too (textured ones in the main pass), so compare what Bind() binds
+        GLuint bindKey = item.mesh->GetBindKey();
+        if (bindKey != lastVAO) {
+            item.mesh->Bind();
+            lastVAO = bindKey;
+            stats.vaoBinds++;
+        } else {
+            stats.vaoBindsSkipped++;
+        }
+
+        item.mesh->DrawBound(drawIds[i], item.model->GetInstanceCount());
+    }
+
+    glBindVertexArray(0);
+    shader->Unuse();
+}
+
+void RenderQueue::WriteDrawData(const Model& model, GPUDrawData& data) {
+    const Material& material = model.GetMaterial();
+    data.model = model.GetTransform();
+    data.albedoMetallic = glm::vec4(material.albedo, material.metallic);
+    data.roughnessAo = glm::vec4(material.roughness, material.ao, 0.0f, 0.0f);
+}
+
+uint16_t RenderQueue::InternMaterial(const Material& material) {
+    MaterialKey key{ material.albedo, material.metallic, material.roughness, material.ao, {} };
+    for (int unit = 0; unit < Material::TEXTURE_UNIT_COUNT; ++unit) {
+        key.textures[unit] = material.GetTextureForUnit(unit);
+    }
+    auto it = materialIds.find(key);
+    if (it != materialIds.end()) {
+        return it->second;
+    }
+
+    // Materials past the id space share UNBATCHED_MATERIAL and are not
+    // interned, so Submit binds them per draw
+    if (materialIds.size() >= UNBATCHED_MATERIAL) {
+        return UNBATCHED_MATERIAL;
+    }
+    uint16_t id = static_cast<uint16_t>(materialIds.size());
+    materialIds.emplace(key, id);
+    return id;
+}
+
+void RenderQueue::RadixSort() {
+    const size_t count = items.size();
+    if (count < 2) {
+        return;
+    }
+    sortScratch.resize(count);
+
+    DrawItem* src = items.data();
+    DrawItem* dst = sortScratch.data();
+
+    // LSD radix sort, one byte per pass. A pass where every key shares the
+    // same byte would be a plain copy, so it is skipped.
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t histogram[256] = {};
+        for (size_t i = 0; i < count; ++i) {
+            histogram[(src[i].key >> shift) & 0xFF]++;
+        }
+        if (histogram[(src[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram) {
+            size_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != items.data()) {
+        std::copy(src, src + count, items.data());
+    }
+}
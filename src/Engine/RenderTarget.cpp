@@ -0,0 +1,90 @@
+#include "Engine/RenderTarget.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+RenderTarget::RenderTarget()
+    : framebuffer(0), colorTexture(0), depthBuffer(0), width(0), height(0) {
+}
+
+RenderTarget::~RenderTarget() {
+    Destroy();
+}
+
+bool RenderTarget::Create(int w, int h) {
+    Destroy();
+    width = w;
+    height = h;
+
+    glGenTextures(1, &colorTexture);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete) {
+        std::cerr << "Render target " << width << "x" << height << " is incomplete" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void RenderTarget::Destroy() {
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if (colorTexture != 0) {
+        glDeleteTextures(1, &colorTexture);
+        colorTexture = 0;
+    }
+    if (depthBuffer != 0) {
+        glDeleteRenderbuffers(1, &depthBuffer);
+        depthBuffer = 0;
+    }
+}
+
+void RenderTarget::ReadPixels(std::vector<unsigned char>& rgb) const {
+    size_t rowSize = static_cast<size_t>(width) * 3;
+    readBuffer.resize(rowSize * height);
+    rgb.resize(rowSize * height);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, readBuffer.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    // GL rows start at the bottom
+    for (int y = 0; y < height; ++y) {
+        std::memcpy(&rgb[y * rowSize], &readBuffer[(height - 1 - y) * rowSize], rowSize);
+    }
+}
+
+bool RenderTarget::WritePPM(const std::string& filePath) const {
+    std::vector<unsigned char> rgb;
+    ReadPixels(rgb);
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+    return static_cast<bool>(file);
+}
@@ -6,15 +6,46 @@
 #include "Engine/Model.h"
 #include "Engine/Mesh.h"
 #include "Engine/Texture.h"
+#include "Engine/TextureStreamer.h"
+#include "Engine/Profiler.h"
+#include "Utils/FileUtils.h"
 #include <GL/glew.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
 #include <iostream>
 
+namespace {
+    // Remaining per-program uniforms; everything else is in FrameBlock/DrawBlock
+    const UniformId SHADOW_MAP_UNIFORM("shadowMap");
+    const UniformId LIGHT_SPACE_MATRIX_UNIFORM("lightSpaceMatrix");
+    const UniformId VIEW_UNIFORM("view");
+    const UniformId PROJECTION_UNIFORM("projection");
+    
+    // Indexed by texture unit (Material::GetTextureForUnit)
+    const UniformId MATERIAL_MAP_UNIFORMS[Material::TEXTURE_UNIT_COUNT] = {
+        UniformId("material.albedoMap"),
+        UniformId("material.normalMap"),
+        UniformId("material.metallicMap"),
+        UniformId("material.roughnessMap"),
+        UniformId("material.aoMap"),
+    };
+}
+
 Renderer::Renderer(int width, int height) 
-    : width(width), height(height), fps(0.0f), drawCalls(0), lastFrameTime(0.0),
+    : width(width), height(height), fps(0.0f), drawCalls(0), lastFrameTime(0.0), framesSinceFpsUpdate(0),
       depthTestEnabled(true), cullingEnabled(true), blendingEnabled(true),
-      shadowMapFBO(0), shadowMap(0) {
+      shadowMapFBO(0), shadowMap(0), staticShadowMap(0), cascadeCount(4), shadowMapResolution(2048),
+      shadowDistance(500.0f), cascadeSplitLambda(0.75f), shadowsRendered(false),
+      shadowLightDirection(0.0f, -1.0f, 0.0f), shadowCacheCosThreshold(std::cos(glm::radians(0.5f))),
+      shadowStaticVersion(0), shadowCacheRebuilds(0), lightUBO(0), uploadedAmbient(-1.0f),
+      lightBucketBits(0), shaderStartupReported(false), indirectDataSize(0), indirectDraws(0), indirectSubmits(0),
+      mainCullStats{0, 0}, shadowCullStats{0, 0}, targetFramebuffer(0) {
+    std::fill(std::begin(boundMaterialTextures), std::end(boundMaterialTextures), 0);
 }
 
 Renderer::~Renderer() {
@@ -24,12 +55,26 @@ Renderer::~Renderer() {
     if (shadowMap != 0) {
         glDeleteTextures(1, &shadowMap);
     }
+    if (staticShadowMap != 0) {
+        glDeleteTextures(1, &staticShadowMap);
+    }
+    if (lightUBO != 0) {
+        glDeleteBuffers(1, &lightUBO);
+    }
 }
 
 void Renderer::Initialize() {
     // Initialize GLEW
     glewExperimental = GL_TRUE;
-    if (glewInit() != GLEW_OK) {
+    GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLX-built GLEW reports this under a headless EGL context even though
+    // the core entry points were loaded
+    if (glewStatus == GLEW_ERROR_NO_GLX_DISPLAY) {
+        glewStatus = GLEW_OK;
+    }
+#endif
+    if (glewStatus != GLEW_OK) {
         std::cerr << "Failed to initialize GLEW" << std::endl;
         return;
     }
@@ -45,14 +90,20 @@ void Renderer::Initialize() {
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     
     // Load shaders
-    mainShader = std::make_unique<Shader>();
-    if (!mainShader->LoadFromFiles("shaders/vertex/main.vert", "shaders/fragment/main.frag")) {
+    // Variants of these are built on first use (see SelectShader)
+    if (!mainVariants.LoadFromFiles("shaders/vertex/main.vert", "shaders/fragment/main.frag")) {
         std::cerr << "Failed to load main shader" << std::endl;
         return;
     }
+    // Sampler units never change, so they are set once per program
+    mainVariants.SetInitializer([](Shader& shader) {
+        shader.SetInt(SHADOW_MAP_UNIFORM, SHADOW_MAP_UNIT);
+        for (int unit = 0; unit < Material::TEXTURE_UNIT_COUNT; ++unit) {
+            shader.SetInt(MATERIAL_MAP_UNIFORMS[unit], unit);
+        }
+    });
     
-    shadowShader = std::make_unique<Shader>();
-    if (!shadowShader->LoadFromFiles("shaders/vertex/shadow.vert", "shaders/fragment/shadow.frag")) {
+    if (!shadowVariants.LoadFromFiles("shaders/vertex/shadow.vert", "shaders/fragment/shadow.frag")) {
         std::cerr << "Failed to load shadow shader" << std::endl;
         return;
     }
@@ -66,9 +117,41 @@ void Renderer::Initialize() {
     // Setup shadow mapping
     SetupShadowMapping();
     
+    // Setup light table
+    SetupLightBuffer();
+    
+    // Neutral material maps
+    SetupDefaultTextures();
+    
+    // Setup static geometry arena and indirect draw buffers
+    SetupIndirectBuffers();
+    
+    // Streaming ring for per-frame and per-draw data
+    if (!frameRing.Create(FRAME_RING_SIZE)) {
+        std::cerr << "Failed to create uniform ring" << std::endl;
+        return;
+    }
+    
     std::cout << "Renderer initialized successfully" << std::endl;
 }
 
+void Renderer::ReserveFrameData(const Scene& scene) {
+    size_t models = scene.GetModels().size();
+    size_t meshes = 0;
+    for (const auto& model : scene.GetModels()) {
+        meshes += model->GetMeshes().size();
+    }
+    
+    // The main pass, then a static and a dynamic pass per cascade. Each pass
+    // streams indirect commands and draw data for its static models and queue
+    // draw data for the rest; assume every model takes both paths.
+    const GLsizeiptr padding = 256;
+    GLsizeiptr perPass = meshes * sizeof(DrawElementsIndirectCommand) + models * sizeof(GPUDrawData) +
+                         meshes * sizeof(GPUDrawData) + 3 * padding;
+    GLsizeiptr size = sizeof(GPUFrameData) + padding + perPass * (1 + 2 * cascadeCount);
+    frameRing.Reserve(std::max(size, FRAME_RING_SIZE));
+}
+
 void Renderer::SetViewport(int w, int h) {
     width = w;
     height = h;
@@ -83,213 +166,755 @@ void Renderer::DisableFeature(GLenum feature) {
     glDisable(feature);
 }
 
+void Renderer::SetRenderTarget(GLuint framebuffer) {
+    targetFramebuffer = framebuffer;
+}
+
 void Renderer::BeginFrame() {
+    frameRing.BeginFrame();
+    {
+        PROFILE_CPU("Texture streaming");
+        TextureStreamer::Instance().Update();
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     drawCalls = 0;
+    mainCullStats = {0, 0};
+    shadowCullStats = {0, 0};
+    renderQueue.ResetStats();
+    indirectDraws = 0;
+    indirectSubmits = 0;
+    shadowCacheRebuilds = 0;
+}
+
+void Renderer::EnableHotReload() {
+    // Shader pointers stay valid across a reload, so slots and cached draw
+    // state need no invalidation
+    for (const std::string& path : mainVariants.GetSourcePaths()) {
+        FileUtils::WatchFile(path, [this]() { mainVariants.Reload(); });
+    }
+    for (const std::string& path : shadowVariants.GetSourcePaths()) {
+        FileUtils::WatchFile(path, [this]() { shadowVariants.Reload(); });
+    }
+    if (skyboxShader) {
+        for (const std::string& path : skyboxShader->GetSourcePaths()) {
+            FileUtils::WatchFile(path, [this]() { skyboxShader->Reload(); });
+        }
+    }
 }
 
 void Renderer::Render(const Scene& scene, const Camera& camera) {
-    // Get view and projection matrices
-    glm::mat4 viewMatrix = camera.GetViewMatrix();
-    glm::mat4 projectionMatrix = camera.GetProjectionMatrix();
-    
-    // Render shadow maps first
-    const auto& lights = scene.GetLights();
-    if (!lights.empty()) {
-        RenderShadowMap(scene, *lights[0]);
+    // Cull against the camera frustum; the shadow pass culls per cascade
+    {
+        PROFILE_CPU("Culling");
+        UpdateFrustum(camera);
+        CullModels(scene, frustumPlanes, true, visibleModels, mainCullStats);
     }
     
-    // Use main shader for scene rendering
-    mainShader->Use();
-    
-    // Set camera matrices
-    mainShader->SetMat4("view", viewMatrix);
-    mainShader->SetMat4("projection", projectionMatrix);
-    mainShader->SetVec3("viewPos", camera.GetPosition());
-    
-    // Set lighting
-    mainShader->SetVec3("ambientLight", scene.GetAmbientLight());
-    mainShader->SetInt("numLights", static_cast<int>(lights.size()));
-    
-    for (size_t i = 0; i < lights.size() && i < 16; ++i) {
-        const auto& light = lights[i];
-        std::string prefix = "lights[" + std::to_string(i) + "].";
-        
-        mainShader->SetInt(prefix + "type", static_cast<int>(light->GetType()));
-        mainShader->SetVec3(prefix + "position", light->GetPosition());
-        mainShader->SetVec3(prefix + "direction", light->GetDirection());
-        mainShader->SetVec3(prefix + "color", light->GetColor());
-        mainShader->SetFloat(prefix + "intensity", light->GetIntensity());
+    // Render shadow cascades first, for the first directional light
+    shadowsRendered = false;
+    for (const auto& light : scene.GetLights()) {
+        if (light->GetType() == Light::LightType::DIRECTIONAL) {
+            PROFILE_GPU("Shadow pass");
+            RenderShadowMap(scene, *light, camera);
+            break;
+        }
     }
     
-    // Render all models in the scene
-    for (const auto& model : scene.GetModels()) {
-        // Set model matrix
-        glm::mat4 modelMatrix = model->GetTransform();
-        mainShader->SetMat4("model", modelMatrix);
+    {
+        PROFILE_GPU("Main pass");
         
-        // Set material properties
-        const auto& material = model->GetMaterial();
-        mainShader->SetVec3("material.albedo", material.albedo);
-        mainShader->SetFloat("material.metallic", material.metallic);
-        mainShader->SetFloat("material.roughness", material.roughness);
-        mainShader->SetFloat("material.ao", material.ao);
+        // Set lighting. The light loop bound is part of the variant.
+        lightBucketBits = ShaderVariants::LightBucketBits(static_cast<int>(scene.GetLights().size()));
+        UpdateLightBuffer(scene);
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, lightUBO);
         
-        // Render meshes
-        for (const auto& mesh : model->GetMeshes()) {
-            mesh->Render();
-            drawCalls++;
+        // Camera and shadow data for every program in the pass
+        UploadFrameData(camera);
+        
+        // Untextured draws (and the indirect path) sample the defaults
+        std::fill(std::begin(boundMaterialTextures), std::end(boundMaterialTextures), 0);
+        BindMaterialTextures(nullptr);
+        
+        // Static geometry in one indirect submit per arena page and variant
+        BuildIndirectDraws(visibleModels, dynamicModels, false);
+        SubmitIndirectDraws([](Shader&) {});
+        
+        // Build, sort and submit everything else. Instanced arrays use their own
+        // variant (one draw per mesh for the whole array).
+        renderQueue.Clear();
+        for (const Model* model : dynamicModels) {
+            int slot = GetShaderSlot(SelectShader(*model, false));
+            if (slot < 0) continue;
+            float depth = glm::length(model->GetBoundingSphereCenter() - camera.GetPosition());
+            renderQueue.Add(RenderQueue::Pass::MAIN, static_cast<uint8_t>(slot), *model, depth, camera.GetFarPlane());
         }
+        renderQueue.Sort();
+        renderQueue.Submit(shaderSlots.data(), [](Shader&) {}, frameRing,
+                           [this](const Material& material) { BindMaterialTextures(&material); });
+        drawCalls += renderQueue.GetDrawCount();
     }
     
-    mainShader->Unuse();
-    
     // Render skybox
-    RenderSkybox(scene, camera);
+    {
+        PROFILE_GPU("Skybox");
+        RenderSkybox(scene, camera);
+    }
 }
 
 void Renderer::EndFrame() {
-    // Update FPS counter
-    double currentTime = glfwGetTime();
-    if (currentTime - lastFrameTime >= 1.0) {
-        fps = 1.0f / (currentTime - lastFrameTime);
+    frameRing.EndFrame();
+    
+    // Update FPS counter: frames completed over the last (roughly one second) window
+    double currentTime = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    framesSinceFpsUpdate++;
+    if (lastFrameTime == 0.0) {
+        lastFrameTime = currentTime;
+        framesSinceFpsUpdate = 0;
+    } else if (currentTime - lastFrameTime >= 1.0) {
+        fps = static_cast<float>(framesSinceFpsUpdate / (currentTime - lastFrameTime));
         lastFrameTime = currentTime;
+        framesSinceFpsUpdate = 0;
+    }
+    
+    // Per-frame counters shown next to the profiler timings
+    Profiler& profiler = Profiler::Instance();
+    profiler.SetCounter("Draw calls", drawCalls);
+    profiler.SetCounter("Visible", mainCullStats.visible);
+    profiler.SetCounter("Culled", mainCullStats.culled);
+    profiler.SetCounter("Shadow casters", shadowCullStats.visible);
+    profiler.SetCounter("Static draws", indirectDraws);
+    profiler.SetCounter("Indirect submits", indirectSubmits);
+    profiler.SetCounter("Shadow cache rebuilds", shadowCacheRebuilds);
+    const RenderQueue::Stats& queueStats = renderQueue.GetStats();
+    profiler.SetCounter("Skipped binds", queueStats.programBindsSkipped + queueStats.vaoBindsSkipped +
+                                         queueStats.materialBindsSkipped);
+    profiler.SetCounter("Ring KB", frameRing.GetBytesUsed() / 1024);
+    profiler.SetCounter("Shader variants", mainVariants.GetVariantCount() + shadowVariants.GetVariantCount());
+    TextureStreamer::Stats streamStats = TextureStreamer::Instance().GetStats();
+    profiler.SetCounter("Texture upload KB", static_cast<long long>(streamStats.uploadedBytes / 1024));
+    profiler.SetCounter("Textures pending", streamStats.pendingDecodes + streamStats.pendingUploads);
+    
+    // Variants are built lazily, so the first frame completes the startup set
+    if (!shaderStartupReported) {
+        const ShaderCache& shaderCache = ShaderCache::Instance();
+        std::cout << "Shader programs: " << shaderCache.GetHits() << " from cache, "
+                  << shaderCache.GetCompiles() << " compiled";
+        if (shaderCache.GetRejected() > 0) {
+            std::cout << " (" << shaderCache.GetRejected() << " cached binaries rejected)";
+        }
+        std::cout << std::endl;
+        shaderStartupReported = true;
     }
 }
 
 void Renderer::SetupShadowMapping() {
-    // Create shadow map texture
-    glGenTextures(1, &shadowMap);
-    glBindTexture(GL_TEXTURE_2D, shadowMap);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, 1024, 1024, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    if (shadowMapFBO == 0) {
+        glGenFramebuffers(1, &shadowMapFBO);
+    }
+    CreateShadowTexture(shadowMap);
+    CreateShadowTexture(staticShadowMap);
+    for (auto& cascade : cascades) {
+        cascade.staticValid = false;
+    }
     
-    // Create framebuffer for shadow mapping
-    glGenFramebuffers(1, &shadowMapFBO);
+    // Layers are attached per cascade in RenderShadowMap
     glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowMap, 0);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMap, 0, 0);
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Shadow map framebuffer is incomplete" << std::endl;
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void Renderer::RenderShadowMap(const Scene& scene, const Light& light) {
-    // For now, just render a simple shadow map
-    glViewport(0, 0, 1024, 1024);
-    glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-    glClear(GL_DEPTH_BUFFER_BIT);
+void Renderer::CreateShadowTexture(GLuint& texture) {
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+    }
     
-    shadowShader->Use();
+    // One depth layer per cascade, sampled with hardware depth comparison
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, shadowMapResolution, shadowMapResolution,
+                 cascadeCount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void Renderer::SetShadowCascades(int count) {
+    count = std::clamp(count, 1, MAX_SHADOW_CASCADES);
+    if (count == cascadeCount) return;
     
-    // Calculate light space matrix
-    glm::mat4 lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 0.1f, 100.0f);
-    glm::mat4 lightView = glm::lookAt(
-        glm::vec3(0.0f, 10.0f, 0.0f),
-        glm::vec3(0.0f, 0.0f, 0.0f),
-        glm::vec3(0.0f, 0.0f, 1.0f)
-    );
-    glm::mat4 lightSpaceMatrix = lightProjection * lightView;
+    cascadeCount = count;
+    if (shadowMapFBO != 0) {
+        SetupShadowMapping();
+    }
+}
+
+void Renderer::SetShadowMapResolution(int resolution) {
+    resolution = std::max(resolution, 64);
+    if (resolution == shadowMapResolution) return;
     
-    shadowShader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
+    shadowMapResolution = resolution;
+    if (shadowMapFBO != 0) {
+        SetupShadowMapping();
+    }
+}
+
+void Renderer::SetShadowDistance(float distance) {
+    shadowDistance = std::max(distance, 1.0f);
+}
+
+void Renderer::SetShadowCacheThreshold(float degrees) {
+    shadowCacheCosThreshold = std::cos(glm::radians(std::max(degrees, 0.0f)));
+}
+
+void Renderer::UpdateCascades(const Camera& camera, const glm::vec3& lightDirection) {
+    float nearPlane = camera.GetNearPlane();
+    float cameraFar = camera.GetFarPlane();
+    float farPlane = std::min(cameraFar, shadowDistance);
     
-    // Render scene to shadow map
-    for (const auto& model : scene.GetModels()) {
-        glm::mat4 modelMatrix = model->GetTransform();
-        shadowShader->SetMat4("model", modelMatrix);
+    // Frustum corners at the camera's near and far planes; slice corners are
+    // interpolated along these edges since view depth is linear along them
+    glm::mat4 inverseViewProjection = glm::inverse(camera.GetProjectionMatrix() * camera.GetViewMatrix());
+    glm::vec3 nearCorners[4], farCorners[4];
+    for (int i = 0; i < 4; ++i) {
+        float x = (i & 1) ? 1.0f : -1.0f;
+        float y = (i & 2) ? 1.0f : -1.0f;
+        glm::vec4 nearCorner = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+        glm::vec4 farCorner = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+        nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+        farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+    }
+    
+    glm::vec3 direction = glm::normalize(lightDirection);
+    glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    
+    float sliceNear = nearPlane;
+    for (int c = 0; c < cascadeCount; ++c) {
+        // Practical split scheme: blend of logarithmic and uniform splits
+        float p = static_cast<float>(c + 1) / cascadeCount;
+        float logSplit = nearPlane * std::pow(farPlane / nearPlane, p);
+        float uniformSplit = nearPlane + (farPlane - nearPlane) * p;
+        float sliceFar = cascadeSplitLambda * logSplit + (1.0f - cascadeSplitLambda) * uniformSplit;
         
-        for (const auto& mesh : model->GetMeshes()) {
-            mesh->Render();
+        float t0 = (sliceNear - nearPlane) / (cameraFar - nearPlane);
+        float t1 = (sliceFar - nearPlane) / (cameraFar - nearPlane);
+        glm::vec3 corners[8];
+        glm::vec3 center(0.0f);
+        for (int i = 0; i < 4; ++i) {
+            corners[i] = glm::mix(nearCorners[i], farCorners[i], t0);
+            corners[i + 4] = glm::mix(nearCorners[i], farCorners[i], t1);
+            center += corners[i] + corners[i + 4];
+        }
+        center /= 8.0f;
+        
+        // A bounding sphere keeps the projection size constant as the camera
+        // rotates; rounding the radius avoids size changes from float noise
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners) {
+            radius = std::max(radius, glm::length(corner - center));
         }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+        
+        // Snap the center to a coarse grid (growing the sphere to still cover
+        // the slice) so small camera moves keep the cascade matrix, and with
+        // it the cached static layer, unchanged
+        float snapStep = radius / 8.0f;
+        center = glm::round(center / snapStep) * snapStep;
+        radius += snapStep;
+        
+        // Casters outside [0, 2r] along the light are depth-clamped during the shadow pass
+        glm::mat4 lightView = glm::lookAt(center - direction * radius, center, up);
+        glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+        
+        // Snap the projection to whole shadow-map texels so edges do not
+        // shimmer when the camera translates
+        glm::mat4 shadowMatrix = lightProjection * lightView;
+        float halfResolution = shadowMapResolution * 0.5f;
+        glm::vec2 origin = glm::vec2(shadowMatrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)) * halfResolution;
+        glm::vec2 offset = (glm::round(origin) - origin) / halfResolution;
+        lightProjection[3][0] += offset.x;
+        lightProjection[3][1] += offset.y;
+        
+        cascades[c].lightSpaceMatrix = lightProjection * lightView;
+        cascades[c].splitDepth = sliceFar;
+        ExtractFrustumPlanes(cascades[c].lightSpaceMatrix, cascades[c].planes);
+        
+        sliceNear = sliceFar;
     }
+}
+
+void Renderer::UploadFrameData(const Camera& camera) {
+    glActiveTexture(GL_TEXTURE0 + SHADOW_MAP_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMap);
+    glActiveTexture(GL_TEXTURE0);
     
-    shadowShader->Unuse();
+    UniformRing::Allocation allocation = frameRing.Allocate(sizeof(GPUFrameData));
+    GPUFrameData* data = static_cast<GPUFrameData*>(allocation.data);
+    
+    data->view = camera.GetViewMatrix();
+    data->projection = camera.GetProjectionMatrix();
+    data->viewPos = glm::vec4(camera.GetPosition(), 1.0f);
+    data->shadowLightDirection = glm::vec4(shadowLightDirection, 0.0f);
+    data->cascadeCount = glm::ivec4(shadowsRendered ? cascadeCount : 0, 0, 0, 0);
+    for (int c = 0; c < MAX_SHADOW_CASCADES; ++c) {
+        bool used = c < cascadeCount;
+        data->cascadeSplits[c] = used ? cascades[c].splitDepth : 0.0f;
+        data->lightSpaceMatrices[c] = used ? cascades[c].lightSpaceMatrix : glm::mat4(1.0f);
+    }
+    
+    frameRing.Commit(allocation, sizeof(GPUFrameData));
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, allocation.buffer, allocation.offset, sizeof(GPUFrameData));
+}
+
+void Renderer::SetupDefaultTextures() {
+    const unsigned char white[4] = { 255, 255, 255, 255 };
+    const unsigned char flatNormal[4] = { 128, 128, 255, 255 };
+    defaultTexture = std::make_unique<Texture>(1, 1, TextureFormat::RGBA);
+    defaultTexture->UpdateData(white);
+    defaultNormalMap = std::make_unique<Texture>(1, 1, TextureFormat::RGBA, TextureType::NORMAL);
+    defaultNormalMap->UpdateData(flatNormal);
+}
+
+void Renderer::BindMaterialTextures(const Material* material) {
+    for (int unit = 0; unit < Material::TEXTURE_UNIT_COUNT; ++unit) {
+        const Texture* texture = material ? material->GetTextureForUnit(unit) : nullptr;
+        if (!texture || !texture->IsValid()) {
+            texture = unit == 1 ? defaultNormalMap.get() : defaultTexture.get();
+        }
+        if (!texture || boundMaterialTextures[unit] == texture->GetID()) {
+            continue;
+        }
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture->GetID());
+        boundMaterialTextures[unit] = texture->GetID();
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void Renderer::SetupLightBuffer() {
+    // Layout matches LightBlock: vec4 ambientLight, ivec4 lightCount, GPULight lights[MAX_LIGHTS]
+    GLsizeiptr size = 2 * sizeof(glm::vec4) + MAX_LIGHTS * sizeof(GPULight);
+    
+    glGenBuffers(1, &lightUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void Renderer::UpdateLightBuffer(const Scene& scene) {
+    const auto& lights = scene.GetLights();
+    size_t count = std::min(lights.size(), static_cast<size_t>(MAX_LIGHTS));
+    const GLintptr lightsOffset = 2 * sizeof(glm::vec4);
+    
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+    
+    if (scene.GetAmbientLight() != uploadedAmbient) {
+        uploadedAmbient = scene.GetAmbientLight();
+        glm::vec4 ambient(uploadedAmbient, 0.0f);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::vec4), glm::value_ptr(ambient));
+    }
+    
+    // A changed light list invalidates every slot; otherwise only dirty lights are rewritten
+    bool listChanged = uploadedLights.size() != count;
+    for (size_t i = 0; i < count && !listChanged; ++i) {
+        listChanged = uploadedLights[i] != lights[i].get();
+    }
+    
+    if (listChanged) {
+        std::vector<GPULight> data(count);
+        uploadedLights.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            lights[i]->WriteGPUData(data[i]);
+            lights[i]->ClearDirty();
+            uploadedLights[i] = lights[i].get();
+        }
+        
+        glm::ivec4 lightCount(static_cast<int>(count), 0, 0, 0);
+        glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::vec4), sizeof(glm::ivec4), glm::value_ptr(lightCount));
+        if (count > 0) {
+            glBufferSubData(GL_UNIFORM_BUFFER, lightsOffset, count * sizeof(GPULight), data.data());
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            if (!lights[i]->IsDirty()) continue;
+            
+            GPULight data;
+            lights[i]->WriteGPUData(data);
+            lights[i]->ClearDirty();
+            glBufferSubData(GL_UNIFORM_BUFFER, lightsOffset + i * sizeof(GPULight), sizeof(GPULight), &data);
+        }
+    }
+    
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void Renderer::RenderShadowMap(const Scene& scene, const Light& light, const Camera& camera) {
+    // The sun moves a fraction of a degree per frame; only follow it once it
+    // has moved far enough to matter, so the cascades (and the cached static
+    // layers) stay put in between
+    glm::vec3 direction = glm::normalize(light.GetDirection());
+    if (glm::dot(direction, shadowLightDirection) < shadowCacheCosThreshold) {
+        shadowLightDirection = direction;
+    }
+    UpdateCascades(camera, shadowLightDirection);
+    
+    // Static changes only invalidate the cascades they overlap, so terrain
+    // chunks swapping LOD in the distance leave the near layers alone
+    bool staticChanged = scene.GetStaticVersion() != shadowStaticVersion;
+    bool staticBounded = staticChanged && scene.GetStaticChanges(shadowStaticVersion, staticChanges);
+    shadowStaticVersion = scene.GetStaticVersion();
+    
+    glViewport(0, 0, shadowMapResolution, shadowMapResolution);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
+    
+    // Casters in front of a cascade's near plane still shadow the scene;
+    // depth clamping pins them to the near plane instead of clipping them
+    glEnable(GL_DEPTH_CLAMP);
+    
+    // Most casters land in several cascades; count each model once
+    uniqueShadowCasters.clear();
+    
+    for (int c = 0; c < cascadeCount; ++c) {
+        ShadowCascade& cascade = cascades[c];
+        
+        // Only the side and far planes are tested for the same reason
+        CullStats cascadeStats = {0, 0};
+        CullModels(scene, cascade.planes, false, shadowCasters, cascadeStats);
+        uniqueShadowCasters.insert(uniqueShadowCasters.end(), shadowCasters.begin(), shadowCasters.end());
+        staticCasters.clear();
+        dynamicCasters.clear();
+        for (const Model* model : shadowCasters) {
+            (model->IsStatic() ? staticCasters : dynamicCasters).push_back(model);
+        }
+        
+        bool staticStale = staticChanged && !staticBounded;
+        for (size_t i = 0; staticChanged && !staticStale && i < staticChanges.size(); ++i) {
+            staticStale = IsInFrustum(cascade.planes, staticChanges[i].first, staticChanges[i].second, false);
+        }
+        
+        // Rebuild the static layer when its inputs changed
+        if (!cascade.staticValid || staticStale || cascade.staticMatrix != cascade.lightSpaceMatrix) {
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticShadowMap, 0, c);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            RenderShadowCasters(staticCasters, cascade.lightSpaceMatrix);
+            
+            cascade.staticValid = true;
+            cascade.staticMatrix = cascade.lightSpaceMatrix;
+            shadowCacheRebuilds++;
+        }
+        
+        // Start from the cached static depth and draw dynamic casters on top
+        glCopyImageSubData(staticShadowMap, GL_TEXTURE_2D_ARRAY, 0, 0, 0, c,
+                           shadowMap, GL_TEXTURE_2D_ARRAY, 0, 0, 0, c,
+                           shadowMapResolution, shadowMapResolution, 1);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMap, 0, c);
+        RenderShadowCasters(dynamicCasters, cascade.lightSpaceMatrix);
+    }
+    
+    glDisable(GL_DEPTH_CLAMP);
+    shadowsRendered = true;
+    
+    // Every visible model is a candidate; those in no cascade were culled
+    std::sort(uniqueShadowCasters.begin(), uniqueShadowCasters.end());
+    uniqueShadowCasters.erase(std::unique(uniqueShadowCasters.begin(), uniqueShadowCasters.end()),
+                              uniqueShadowCasters.end());
+    int candidates = static_cast<int>(std::count_if(scene.GetModels().begin(), scene.GetModels().end(),
+                                                    [](const auto& model) { return model->IsVisible(); }));
+    shadowCullStats.visible = static_cast<int>(uniqueShadowCasters.size());
+    shadowCullStats.culled = candidates - shadowCullStats.visible;
     
     // Restore viewport
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
     glViewport(0, 0, width, height);
 }
 
+void Renderer::RenderShadowCasters(const std::vector<const Model*>& casters, const glm::mat4& lightSpaceMatrix) {
+    if (casters.empty()) {
+        return;
+    }
+    
+    // Depth only, so items are grouped by program and mesh and no material
+    // state is bound
+    auto setupShadow = [&](Shader& shader) {
+        shader.SetMat4(LIGHT_SPACE_MATRIX_UNIFORM, lightSpaceMatrix);
+    };
+    
+    BuildIndirectDraws(casters, dynamicModels, true);
+    SubmitIndirectDraws(setupShadow);
+    
+    renderQueue.Clear();
+    for (const Model* model : dynamicModels) {
+        int slot = GetShaderSlot(SelectShader(*model, true));
+        if (slot < 0) continue;
+        renderQueue.Add(RenderQueue::Pass::SHADOW, static_cast<uint8_t>(slot), *model, 0.0f, 0.0f);
+    }
+    renderQueue.Sort();
+    renderQueue.Submit(shaderSlots.data(), setupShadow, frameRing);
+    drawCalls += renderQueue.GetDrawCount();
+}
+
+void Renderer::SetupIndirectBuffers() {
+    geometryArena = std::make_unique<GeometryArena>();
+}
+
+uint32_t Renderer::SelectVariant(const Model& model, bool shadowPass) const {
+    uint32_t features = model.GetInstanceCount() > 0 ? static_cast<uint32_t>(ShaderVariants::INSTANCING) : 0u;
+    if (shadowPass) {
+        return features;
+    }
+    
+    // Cheapest variant that still renders the material correctly
+    const Material& material = model.GetMaterial();
+    if (material.unlit) {
+        return features | ShaderVariants::UNLIT;
+    }
+    features |= lightBucketBits;
+    if (shadowsRendered && material.receiveShadows) {
+        features |= ShaderVariants::SHADOWS;
+    }
+    if (material.normalMap) {
+        features |= ShaderVariants::NORMAL_MAP;
+    }
+    return features;
+}
+
+Shader* Renderer::SelectShader(const Model& model, bool shadowPass) {
+    uint32_t features = SelectVariant(model, shadowPass);
+    return shadowPass ? shadowVariants.Get(features) : mainVariants.Get(features);
+}
+
+int Renderer::GetShaderSlot(Shader* shader) {
+    if (!shader) {
+        return -1;
+    }
+    auto it = std::find(shaderSlots.begin(), shaderSlots.end(), shader);
+    if (it != shaderSlots.end()) {
+        return static_cast<int>(it - shaderSlots.begin());
+    }
+    
+    // The slot is 8 bits of the sort key
+    if (shaderSlots.size() > 0xFF) {
+        std::cerr << "Too many shader variants for the render queue" << std::endl;
+        return -1;
+    }
+    shaderSlots.push_back(shader);
+    return static_cast<int>(shaderSlots.size() - 1);
+}
+
+void Renderer::BuildIndirectDraws(const std::vector<const Model*>& models, std::vector<const Model*>& remaining,
+                                  bool shadowPass) {
+    TRACE_SCOPE("Renderer::BuildIndirectDraws");
+    remaining.clear();
+    indirectCommands.clear();
+    drawData.clear();
+    indirectBatches.clear();
+    
+    // Commands are bucketed per shader variant and arena page, since each
+    // page has its own VAO
+    keyedCommands.clear();
+    
+    for (const Model* model : models) {
+        // Indirect draws share one set of material maps per submit
+        bool indirect = model->IsStatic() && model->GetInstanceCount() == 0 &&
+                        (shadowPass || !model->GetMaterial().HasTextures()) &&
+                        drawData.size() < GeometryArena::MAX_DRAWS;
+        for (const auto& mesh : model->GetMeshes()) {
+            indirect = indirect && mesh->MoveToArena(*geometryArena);
+        }
+        if (!indirect) {
+            remaining.push_back(model);
+            continue;
+        }
+        
+        int slot = GetShaderSlot(SelectShader(*model, shadowPass));
+        if (slot < 0) {
+            continue;
+        }
+        
+        // One draw data entry per model, shared by all of its meshes
+        GLuint drawIndex = static_cast<GLuint>(drawData.size());
+        drawData.emplace_back();
+        RenderQueue::WriteDrawData(*model, drawData.back());
+        
+        for (const auto& mesh : model->GetMeshes()) {
+            const auto& allocation = mesh->GetArenaAllocation();
+            uint64_t key = (static_cast<uint64_t>(slot) << 32) | static_cast<uint32_t>(allocation.page);
+            keyedCommands.push_back({ key, { allocation.indexCount, 1, allocation.firstIndex,
+                                             allocation.baseVertex, drawIndex } });
+        }
+    }
+    
+    std::stable_sort(keyedCommands.begin(), keyedCommands.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < keyedCommands.size(); ++i) {
+        uint64_t key = keyedCommands[i].first;
+        if (i == 0 || key != keyedCommands[i - 1].first) {
+            indirectBatches.push_back({ shaderSlots[key >> 32], static_cast<int>(key & 0xFFFFFFFF),
+                                        static_cast<GLsizei>(indirectCommands.size()), 0 });
+        }
+        indirectBatches.back().count++;
+        indirectCommands.push_back(keyedCommands[i].second);
+    }
+    
+    if (indirectCommands.empty()) {
+        return;
+    }
+    
+    // Both passes rebuild these every frame, so they are streamed through the ring
+    GLsizeiptr commandSize = indirectCommands.size() * sizeof(DrawElementsIndirectCommand);
+    indirectDataSize = drawData.size() * sizeof(GPUDrawData);
+    indirectCommandAllocation = frameRing.Allocate(commandSize);
+    indirectDataAllocation = frameRing.Allocate(indirectDataSize);
+    
+    std::memcpy(indirectCommandAllocation.data, indirectCommands.data(), commandSize);
+    std::memcpy(indirectDataAllocation.data, drawData.data(), indirectDataSize);
+    frameRing.Commit(indirectCommandAllocation, commandSize);
+    frameRing.Commit(indirectDataAllocation, indirectDataSize);
+}
+
+void Renderer::SubmitIndirectDraws(const RenderQueue::ShaderSetup& setup) {
+    if (indirectBatches.empty()) {
+        return;
+    }
+    
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, indirectDataAllocation.buffer,
+                      indirectDataAllocation.offset, indirectDataSize);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectCommandAllocation.buffer);
+    
+    Shader* shader = nullptr;
+    for (const IndirectBatch& batch : indirectBatches) {
+        if (batch.shader != shader) {
+            shader = batch.shader;
+            shader->Use();
+            setup(*shader);
+        }
+        geometryArena->BindPage(batch.page);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                    (void*)(indirectCommandAllocation.offset + batch.first * sizeof(DrawElementsIndirectCommand)),
+                                    batch.count, 0);
+        drawCalls++;
+        indirectSubmits++;
+    }
+    indirectDraws += static_cast<int>(indirectCommands.size());
+    
+    glBindVertexArray(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    shader->Unuse();
+}
+
 void Renderer::RenderScene(const Scene& scene, const Camera& camera, const Light& light) {
     // This is handled in the main Render method
 }
 
 void Renderer::RenderSkybox(const Scene& scene, const Camera& camera) {
-    // For now, just render a simple skybox
     if (scene.GetSkybox()) {
         skyboxShader->Use();
         
         // Remove translation from view matrix for skybox
         glm::mat4 viewMatrix = camera.GetViewMatrix();
         glm::mat4 skyboxView = glm::mat4(glm::mat3(viewMatrix));
-        skyboxShader->SetMat4("view", skyboxView);
-        skyboxShader->SetMat4("projection", camera.GetProjectionMatrix());
+        skyboxShader->SetMat4(VIEW_UNIFORM, skyboxView);
+        skyboxShader->SetMat4(PROJECTION_UNIFORM, camera.GetProjectionMatrix());
         
         // Render skybox
-        scene.GetSkybox()->Render(camera.GetProjectionMatrix() * skyboxView);
+        scene.GetSkybox()->Render(*skyboxShader);
         
         skyboxShader->Unuse();
     }
 }
 
-bool Renderer::IsInFrustum(const glm::vec3& position, float radius) {
-    // Simple frustum culling check
+bool Renderer::IsInFrustum(const glm::vec4 planes[6], const glm::vec3& min, const glm::vec3& max, bool testNearPlane) {
     for (int i = 0; i < 6; ++i) {
-        if (glm::dot(glm::vec3(frustumPlanes[i]), position) + frustumPlanes[i].w < -radius) {
+        if (i == 4 && !testNearPlane) {
+            continue;
+        }
+        
+        // Test the AABB corner furthest along the plane normal (the "positive vertex")
+        glm::vec3 normal(planes[i]);
+        glm::vec3 positive(normal.x >= 0.0f ? max.x : min.x,
+                           normal.y >= 0.0f ? max.y : min.y,
+                           normal.z >= 0.0f ? max.z : min.z);
+        if (glm::dot(normal, positive) + planes[i].w < 0.0f) {
             return false;
         }
     }
     return true;
 }
 
-void Renderer::UpdateFrustum(const Camera& camera) {
-    // Calculate frustum planes from camera
-    glm::mat4 viewProjection = camera.GetProjectionMatrix() * camera.GetViewMatrix();
+void Renderer::CullModels(const Scene& scene, const glm::vec4 planes[6], bool testNearPlane,
+                          std::vector<const Model*>& visible, CullStats& stats) {
+    visible.clear();
     
+    for (const auto& model : scene.GetModels()) {
+        if (!model->IsVisible()) {
+            continue;
+        }
+        
+        if (IsInFrustum(planes, model->GetBoundingBoxMin(), model->GetBoundingBoxMax(), testNearPlane)) {
+            visible.push_back(model.get());
+            stats.visible++;
+        } else {
+            stats.culled++;
+        }
+    }
+}
+
+void Renderer::UpdateFrustum(const Camera& camera) {
+    ExtractFrustumPlanes(camera.GetProjectionMatrix() * camera.GetViewMatrix(), frustumPlanes);
+}
+
+void Renderer::ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]) {
     // Extract frustum planes
     // Left plane
-    frustumPlanes[0].x = viewProjection[0][3] + viewProjection[0][0];
-    frustumPlanes[0].y = viewProjection[1][3] + viewProjection[1][0];
-    frustumPlanes[0].z = viewProjection[2][3] + viewProjection[2][0];
-    frustumPlanes[0].w = viewProjection[3][3] + viewProjection[3][0];
+    planes[0].x = viewProjection[0][3] + viewProjection[0][0];
+    planes[0].y = viewProjection[1][3] + viewProjection[1][0];
+    planes[0].z = viewProjection[2][3] + viewProjection[2][0];
+    planes[0].w = viewProjection[3][3] + viewProjection[3][0];
     
     // Right plane
-    frustumPlanes[1].x = viewProjection[0][3] - viewProjection[0][0];
-    frustumPlanes[1].y = viewProjection[1][3] - viewProjection[1][0];
-    frustumPlanes[1].z = viewProjection[2][3] - viewProjection[2][0];
-    frustumPlanes[1].w = viewProjection[3][3] - viewProjection[3][0];
+    planes[1].x = viewProjection[0][3] - viewProjection[0][0];
+    planes[1].y = viewProjection[1][3] - viewProjection[1][0];
+    planes[1].z = viewProjection[2][3] - viewProjection[2][0];
+    planes[1].w = viewProjection[3][3] - viewProjection[3][0];
     
     // Bottom plane
-    frustumPlanes[2].x = viewProjection[0][3] + viewProjection[0][1];
-    frustumPlanes[2].y = viewProjection[1][3] + viewProjection[1][1];
-    frustumPlanes[2].z = viewProjection[2][3] + viewProjection[2][1];
-    frustumPlanes[2].w = viewProjection[3][3] + viewProjection[3][1];
+    planes[2].x = viewProjection[0][3] + viewProjection[0][1];
+    planes[2].y = viewProjection[1][3] + viewProjection[1][1];
+    planes[2].z = viewProjection[2][3] + viewProjection[2][1];
+    planes[2].w = viewProjection[3][3] + viewProjection[3][1];
     
     // Top plane
-    frustumPlanes[3].x = viewProjection[0][3] - viewProjection[0][1];
-    frustumPlanes[3].y = viewProjection[1][3] - viewProjection[1][1];
-    frustumPlanes[3].z = viewProjection[2][3] - viewProjection[2][1];
-    frustumPlanes[3].w = viewProjection[3][3] - viewProjection[3][1];
+    planes[3].x = viewProjection[0][3] - viewProjection[0][1];
+    planes[3].y = viewProjection[1][3] - viewProjection[1][1];
+    planes[3].z = viewProjection[2][3] - viewProjection[2][1];
+    planes[3].w = viewProjection[3][3] - viewProjection[3][1];
     
     // Near plane
-    frustumPlanes[4].x = viewProjection[0][3] + viewProjection[0][2];
-    frustumPlanes[4].y = viewProjection[1][3] + viewProjection[1][2];
-    frustumPlanes[4].z = viewProjection[2][3] + viewProjection[2][2];
-    frustumPlanes[4].w = viewProjection[3][3] + viewProjection[3][2];
+    planes[4].x = viewProjection[0][3] + viewProjection[0][2];
+    planes[4].y = viewProjection[1][3] + viewProjection[1][2];
+    planes[4].z = viewProjection[2][3] + viewProjection[2][2];
+    planes[4].w = viewProjection[3][3] + viewProjection[3][2];
     
     // Far plane
-    frustumPlanes[5].x = viewProjection[0][3] - viewProjection[0][2];
-    frustumPlanes[5].y = viewProjection[1][3] - viewProjection[1][2];
-    frustumPlanes[5].z = viewProjection[2][3] - viewProjection[2][2];
-    frustumPlanes[5].w = viewProjection[3][3] - viewProjection[3][2];
+    planes[5].x = viewProjection[0][3] - viewProjection[0][2];
+    planes[5].y = viewProjection[1][3] - viewProjection[1][2];
+    planes[5].z = viewProjection[2][3] - viewProjection[2][2];
+    planes[5].w = viewProjection[3][3] - viewProjection[3][2];
     
     // Normalize planes
     for (int i = 0; i < 6; ++i) {
-        float length = glm::length(glm::vec3(frustumPlanes[i]));
-        frustumPlanes[i] /= length;
+        float length = glm::length(glm::vec3(planes[i]));
+        planes[i] /= length;
     }
 }
@@ -4,11 +4,9 @@
 #include "Components/Skybox.h"
 #include <algorithm>
 
-Scene::Scene() : ambientLight(0.1f, 0.1f, 0.1f) {
-    octree = std::make_unique<OctreeNode>();
-    octree->center = glm::vec3(0.0f, 0.0f, 0.0f);
-    octree->size = 1000.0f;
-    octree->isLeaf = true;
+Scene::Scene() : ambientLight(0.1f, 0.1f, 0.1f), staticVersion(0) {
+    staticChanges.resize(STATIC_CHANGE_HISTORY, StaticChange{ 0, false, glm::vec3(0.0f), glm::vec3(0.0f) });
+    BuildOctree();
 }
 
 Scene::~Scene() {
@@ -16,19 +14,72 @@ Scene::~Scene() {
 }
 
 void Scene::AddModel(std::shared_ptr<Model> model) {
+    if (!model || modelIndices.count(model.get()) != 0) {
+        return;
+    }
+    modelIndices[model.get()] = models.size();
     models.push_back(model);
     InsertModelInOctree(model, octree.get());
+    if (model->IsStatic()) {
+        MarkStaticGeometryChanged(model->GetBoundingBoxMin(), model->GetBoundingBoxMax());
+    }
 }
 
 void Scene::RemoveModel(std::shared_ptr<Model> model) {
-    auto it = std::find(models.begin(), models.end(), model);
-    if (it != models.end()) {
-        models.erase(it);
-        // Rebuild octree
-        BuildOctree();
+    auto it = model ? modelIndices.find(model.get()) : modelIndices.end();
+    if (it == modelIndices.end()) {
+        return;
+    }
+    
+    // Order does not matter, so the last model takes its place
+    size_t index = it->second;
+    modelIndices.erase(it);
+    if (index + 1 != models.size()) {
+        models[index] = std::move(models.back());
+        modelIndices[models[index].get()] = index;
+    }
+    models.pop_back();
+    
+    auto leaf = octreeLeaves.find(model.get());
+    if (leaf != octreeLeaves.end()) {
+        std::vector<std::shared_ptr<Model>>& leafModels = leaf->second->models;
+        leafModels.erase(std::find(leafModels.begin(), leafModels.end(), model));
+        octreeLeaves.erase(leaf);
+    }
+    
+    if (model->IsStatic()) {
+        MarkStaticGeometryChanged(model->GetBoundingBoxMin(), model->GetBoundingBoxMax());
     }
 }
 
+void Scene::MarkStaticGeometryChanged() {
+    RecordStaticChange(false, glm::vec3(0.0f), glm::vec3(0.0f));
+}
+
+void Scene::MarkStaticGeometryChanged(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    RecordStaticChange(true, boundsMin, boundsMax);
+}
+
+void Scene::RecordStaticChange(bool bounded, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    staticVersion++;
+    staticChanges[staticVersion % STATIC_CHANGE_HISTORY] = { staticVersion, bounded, boundsMin, boundsMax };
+}
+
+bool Scene::GetStaticChanges(uint64_t sinceVersion, std::vector<std::pair<glm::vec3, glm::vec3>>& bounds) const {
+    bounds.clear();
+    if (staticVersion - sinceVersion > STATIC_CHANGE_HISTORY) {
+        return false;
+    }
+    for (uint64_t version = sinceVersion + 1; version <= staticVersion; ++version) {
+        const StaticChange& change = staticChanges[version % STATIC_CHANGE_HISTORY];
+        if (change.version != version || !change.bounded) {
+            return false;
+        }
+        bounds.emplace_back(change.boundsMin, change.boundsMax);
+    }
+    return true;
+}
+
 void Scene::AddLight(std::shared_ptr<Light> light) {
     lights.push_back(light);
 }
@@ -87,18 +138,15 @@ void Scene::Update(float deltaTime) {
     for (auto& light : lights) {
         light->Update(deltaTime);
     }
-    
-    // Update skybox
-    if (skybox) {
-        skybox->Update(deltaTime);
-    }
 }
 
 void Scene::Clear() {
     models.clear();
+    modelIndices.clear();
     lights.clear();
     skybox.reset();
-    octree.reset();
+    BuildOctree();
+    MarkStaticGeometryChanged();
 }
 
 void Scene::BuildOctree() {
@@ -107,6 +155,7 @@ void Scene::BuildOctree() {
     octree->center = glm::vec3(0.0f, 0.0f, 0.0f);
     octree->size = 1000.0f;
     octree->isLeaf = true;
+    octreeLeaves.clear();
     
     // Insert all models
     for (const auto& model : models) {
@@ -118,7 +167,7 @@ void Scene::InsertModelInOctree(std::shared_ptr<Model> model, OctreeNode* node)
     if (!node) return;
     
     // Check if model fits in this node
-    glm::vec3 modelCenter = model->GetPosition();
+    glm::vec3 modelCenter = model->GetBoundingSphereCenter();
     float modelRadius = model->GetBoundingSphereRadius();
     
     if (glm::distance(modelCenter, node->center) + modelRadius > node->size * 0.5f) {
@@ -129,6 +178,7 @@ void Scene::InsertModelInOctree(std::shared_ptr<Model> model, OctreeNode* node)
     if (node->isLeaf) {
         // Add to leaf node
         node->models.push_back(model);
+        octreeLeaves[model.get()] = node;
         
         // Split if too many models
         if (node->models.size() > 8 && node->size > 10.0f) {
@@ -173,7 +223,7 @@ void Scene::SplitOctreeNode(OctreeNode* node) {
     
     // Redistribute models to children
     for (const auto& model : node->models) {
-        glm::vec3 modelCenter = model->GetPosition();
+        glm::vec3 modelCenter = model->GetBoundingSphereCenter();
         glm::vec3 direction = modelCenter - node->center;
         
         int childIndex = 0;
@@ -182,6 +232,7 @@ void Scene::SplitOctreeNode(OctreeNode* node) {
         if (direction.z > 0) childIndex |= 4;
         
         node->children[childIndex]->models.push_back(model);
+        octreeLeaves[model.get()] = node->children[childIndex].get();
     }
     
     // Clear parent node models
@@ -202,7 +253,7 @@ std::vector<std::shared_ptr<Model>> Scene::QueryOctree(const glm::vec3& position
     if (node->isLeaf) {
         // Check models in leaf node
         for (const auto& model : node->models) {
-            glm::vec3 modelCenter = model->GetPosition();
+            glm::vec3 modelCenter = model->GetBoundingSphereCenter();
             float modelRadius = model->GetBoundingSphereRadius();
             
             if (glm::distance(position, modelCenter) <= radius + modelRadius) {
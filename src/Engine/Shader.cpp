@@ -1,10 +1,50 @@
 #include "Engine/Shader.h"
+#include "Engine/TraceRecorder.h"
+#include <deque>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <mutex>
 #include <vector>
 #include <glm/gtc/type_ptr.hpp>
 
+namespace {
+    // Placeholder for a location that has not been queried yet
+    const GLint UNRESOLVED_LOCATION = -2;
+
+    struct UniformRegistry {
+        std::mutex mutex;
+        std::deque<std::string> names;   // Stable references as it grows
+        std::unordered_map<std::string, uint32_t> indices;
+    };
+
+    // Function-local so file-scope UniformIds in other translation units can
+    // intern during static initialisation
+    UniformRegistry& GetUniformRegistry() {
+        static UniformRegistry registry;
+        return registry;
+    }
+}
+
+UniformId::UniformId(const char* name) {
+    UniformRegistry& registry = GetUniformRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.indices.find(name);
+    if (it != registry.indices.end()) {
+        index = it->second;
+        return;
+    }
+    index = static_cast<uint32_t>(registry.names.size());
+    registry.names.push_back(name);
+    registry.indices.emplace(name, index);
+}
+
+const std::string& UniformId::GetName() const {
+    UniformRegistry& registry = GetUniformRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.names[index];
+}
+
 Shader::Shader() : programID(0) {
 }
 
@@ -15,6 +55,7 @@ Shader::~Shader() {
 }
 
 bool Shader::LoadFromFiles(const std::string& vertexPath, const std::string& fragmentPath) {
+    TRACE_SCOPE("Shader::LoadFromFiles");
     std::string vertexCode = ReadFile(vertexPath);
     std::string fragmentCode = ReadFile(fragmentPath);
     
@@ -22,87 +63,167 @@ bool Shader::LoadFromFiles(const std::string& vertexPath, const std::string& fra
         return false;
     }
     
-    GLuint vertexShader, fragmentShader;
+    sourceFiles = { { GL_VERTEX_SHADER, vertexPath }, { GL_FRAGMENT_SHADER, fragmentPath } };
+    return BuildProgram({ { GL_VERTEX_SHADER, vertexCode }, { GL_FRAGMENT_SHADER, fragmentCode } }, {});
+}
+
+bool Shader::LoadFromFiles(const std::string& vertexPath, const std::string& geometryPath, const std::string& fragmentPath) {
+    TRACE_SCOPE("Shader::LoadFromFiles");
+    std::string vertexCode = ReadFile(vertexPath);
+    std::string geometryCode = ReadFile(geometryPath);
+    std::string fragmentCode = ReadFile(fragmentPath);
     
-    // Compile vertex shader
-    if (!CompileShader(vertexShader, GL_VERTEX_SHADER, vertexCode)) {
+    if (vertexCode.empty() || geometryCode.empty() || fragmentCode.empty()) {
         return false;
     }
     
-    // Compile fragment shader
-    if (!CompileShader(fragmentShader, GL_FRAGMENT_SHADER, fragmentCode)) {
-        glDeleteShader(vertexShader);
-        return false;
+    sourceFiles = { { GL_VERTEX_SHADER, vertexPath }, { GL_GEOMETRY_SHADER, geometryPath },
+                    { GL_FRAGMENT_SHADER, fragmentPath } };
+    return BuildProgram({ { GL_VERTEX_SHADER, vertexCode }, { GL_GEOMETRY_SHADER, geometryCode },
+                          { GL_FRAGMENT_SHADER, fragmentCode } }, {});
+}
+
+bool Shader::LoadFromSources(const std::string& vertexCode, const std::string& fragmentCode,
+                             const std::vector<std::string>& defines) {
+    TRACE_SCOPE("Shader::LoadFromSources");
+    sourceFiles.clear();
+    return BuildProgram({ { GL_VERTEX_SHADER, vertexCode }, { GL_FRAGMENT_SHADER, fragmentCode } }, defines);
+}
+
+std::string Shader::InjectDefines(const std::string& source, const std::vector<std::string>& defines) {
+    if (defines.empty()) {
+        return source;
     }
     
-    // Create program
-    programID = glCreateProgram();
-    glAttachShader(programID, vertexShader);
-    glAttachShader(programID, fragmentShader);
-    
-    if (!LinkProgram()) {
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return false;
+    // Defines must follow #version; #line keeps compiler messages on the
+    // original line numbers
+    size_t versionLine = source.find("#version");
+    size_t insertAt = versionLine == std::string::npos ? 0 : source.find('\n', versionLine);
+    if (insertAt == std::string::npos) {
+        return source;
+    }
+    if (versionLine != std::string::npos) {
+        insertAt++;
     }
     
-    // Clean up shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    int nextLine = 1;
+    for (size_t i = 0; i < insertAt; ++i) {
+        nextLine += source[i] == '\n';
+    }
     
-    return true;
+    std::string block;
+    for (const std::string& define : defines) {
+        block += "#define " + define + "\n";
+    }
+    block += "#line " + std::to_string(nextLine) + "\n";
+    return source.substr(0, insertAt) + block + source.substr(insertAt);
 }
 
-bool Shader::LoadFromFiles(const std::string& vertexPath, const std::string& geometryPath, const std::string& fragmentPath) {
-    std::string vertexCode = ReadFile(vertexPath);
-    std::string geometryCode = ReadFile(geometryPath);
-    std::string fragmentCode = ReadFile(fragmentPath);
+bool Shader::BuildProgram(const ShaderCache::StageSources& sources, const std::vector<std::string>& defines) {
+    ShaderCache::StageSources stages = sources;
+    std::string defineKey;
+    for (auto& stage : stages) {
+        stage.second = InjectDefines(stage.second, defines);
+    }
+    for (const std::string& define : defines) {
+        defineKey += define + ";";
+    }
     
-    if (vertexCode.empty() || geometryCode.empty() || fragmentCode.empty()) {
-        return false;
+    ShaderCache& cache = ShaderCache::Instance();
+    uint64_t key = cache.MakeKey(stages, defineKey);
+    
+    // Built into a new program so a failed rebuild (e.g. a hot reload with
+    // a typo) leaves the current one in place
+    GLuint program = glCreateProgram();
+    
+    // Try the linked binary from a previous run first
+    if (cache.Load(key, program)) {
+        AdoptProgram(program);
+        return true;
     }
+    glDeleteProgram(program);
     
-    GLuint vertexShader, geometryShader, fragmentShader;
+    std::vector<GLuint> shaders;
+    for (const auto& stage : stages) {
+        GLuint shaderID;
+        if (!CompileShader(shaderID, stage.first, stage.second)) {
+            glDeleteShader(shaderID);
+            for (GLuint shader : shaders) {
+                glDeleteShader(shader);
+            }
+            return false;
+        }
+        shaders.push_back(shaderID);
+    }
     
-    // Compile vertex shader
-    if (!CompileShader(vertexShader, GL_VERTEX_SHADER, vertexCode)) {
-        return false;
+    // Create program
+    program = glCreateProgram();
+    for (GLuint shader : shaders) {
+        glAttachShader(program, shader);
+    }
+    if (cache.IsEnabled()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     }
     
-    // Compile geometry shader
-    if (!CompileShader(geometryShader, GL_GEOMETRY_SHADER, geometryCode)) {
-        glDeleteShader(vertexShader);
-        return false;
+    bool linked = LinkProgram(program);
+    
+    // Clean up shaders
+    for (GLuint shader : shaders) {
+        glDetachShader(program, shader);
+        glDeleteShader(shader);
     }
     
-    // Compile fragment shader
-    if (!CompileShader(fragmentShader, GL_FRAGMENT_SHADER, fragmentCode)) {
-        glDeleteShader(vertexShader);
-        glDeleteShader(geometryShader);
+    if (!linked) {
+        glDeleteProgram(program);
         return false;
     }
     
-    // Create program
-    programID = glCreateProgram();
-    glAttachShader(programID, vertexShader);
-    glAttachShader(programID, geometryShader);
-    glAttachShader(programID, fragmentShader);
-    
-    if (!LinkProgram()) {
-        glDeleteShader(vertexShader);
-        glDeleteShader(geometryShader);
-        glDeleteShader(fragmentShader);
+    cache.RecordCompile();
+    cache.Store(key, program);
+    AdoptProgram(program);
+    return true;
+}
+
+void Shader::AdoptProgram(GLuint program) {
+    if (programID != 0) {
+        glDeleteProgram(programID);
+    }
+    programID = program;
+    uniformCache.clear();
+    ResolveUniforms();
+}
+
+bool Shader::Reload() {
+    if (sourceFiles.empty()) {
         return false;
     }
     
-    // Clean up shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(geometryShader);
-    glDeleteShader(fragmentShader);
+    TRACE_SCOPE("Shader::Reload");
+    ShaderCache::StageSources sources;
+    for (const auto& file : sourceFiles) {
+        std::string code = ReadFile(file.second);
+        if (code.empty()) {
+            return false;
+        }
+        sources.push_back({ file.first, code });
+    }
     
+    if (!BuildProgram(sources, {})) {
+        std::cerr << "Shader reload failed, keeping the previous program: " << sourceFiles.back().second << std::endl;
+        return false;
+    }
+    std::cout << "Reloaded shader: " << sourceFiles.back().second << std::endl;
     return true;
 }
 
+std::vector<std::string> Shader::GetSourcePaths() const {
+    std::vector<std::string> paths;
+    for (const auto& file : sourceFiles) {
+        paths.push_back(file.second);
+    }
+    return paths;
+}
+
 void Shader::Use() {
     glUseProgram(programID);
 }
@@ -151,22 +272,51 @@ void Shader::SetVec3Array(const std::string& name, const std::vector<glm::vec3>&
     glUniform3fv(GetUniformLocation(name), values.size(), glm::value_ptr(values[0]));
 }
 
+void Shader::SetBool(const UniformId& id, bool value) {
+    glUniform1i(GetUniformLocation(id), (int)value);
+}
+
+void Shader::SetInt(const UniformId& id, int value) {
+    glUniform1i(GetUniformLocation(id), value);
+}
+
+void Shader::SetFloat(const UniformId& id, float value) {
+    glUniform1f(GetUniformLocation(id), value);
+}
+
+void Shader::SetVec2(const UniformId& id, const glm::vec2& value) {
+    glUniform2fv(GetUniformLocation(id), 1, glm::value_ptr(value));
+}
+
+void Shader::SetVec3(const UniformId& id, const glm::vec3& value) {
+    glUniform3fv(GetUniformLocation(id), 1, glm::value_ptr(value));
+}
+
+void Shader::SetVec4(const UniformId& id, const glm::vec4& value) {
+    glUniform4fv(GetUniformLocation(id), 1, glm::value_ptr(value));
+}
+
+void Shader::SetMat3(const UniformId& id, const glm::mat3& value) {
+    glUniformMatrix3fv(GetUniformLocation(id), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::SetMat4(const UniformId& id, const glm::mat4& value) {
+    glUniformMatrix4fv(GetUniformLocation(id), 1, GL_FALSE, glm::value_ptr(value));
+}
+
 bool Shader::CompileShader(GLuint& shaderID, GLenum shaderType, const std::string& source) {
     shaderID = glCreateShader(shaderType);
     const char* src = source.c_str();
     glShaderSource(shaderID, 1, &src, nullptr);
     glCompileShader(shaderID);
     
-    CheckCompileErrors(shaderID, shaderType == GL_VERTEX_SHADER ? "VERTEX" : 
-                      shaderType == GL_FRAGMENT_SHADER ? "FRAGMENT" : "GEOMETRY");
-    
-    return true;
+    return CheckCompileErrors(shaderID, shaderType == GL_VERTEX_SHADER ? "VERTEX" : 
+                             shaderType == GL_FRAGMENT_SHADER ? "FRAGMENT" : "GEOMETRY");
 }
 
-bool Shader::LinkProgram() {
-    glLinkProgram(programID);
-    CheckCompileErrors(programID, "PROGRAM");
-    return true;
+bool Shader::LinkProgram(GLuint program) {
+    glLinkProgram(program);
+    return CheckCompileErrors(program, "PROGRAM");
 }
 
 GLint Shader::GetUniformLocation(const std::string& name) {
@@ -179,6 +329,30 @@ GLint Shader::GetUniformLocation(const std::string& name) {
     return location;
 }
 
+GLint Shader::GetUniformLocation(const UniformId& id) {
+    uint32_t index = id.GetIndex();
+    if (index < uniformLocations.size() && uniformLocations[index] != UNRESOLVED_LOCATION) {
+        return uniformLocations[index];
+    }
+    
+    // Interned after this program was linked
+    if (index >= uniformLocations.size()) {
+        uniformLocations.resize(index + 1, UNRESOLVED_LOCATION);
+    }
+    uniformLocations[index] = glGetUniformLocation(programID, id.GetName().c_str());
+    return uniformLocations[index];
+}
+
+void Shader::ResolveUniforms() {
+    // Every name interned so far, so setters never query the driver
+    UniformRegistry& registry = GetUniformRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    uniformLocations.resize(registry.names.size());
+    for (size_t index = 0; index < registry.names.size(); ++index) {
+        uniformLocations[index] = glGetUniformLocation(programID, registry.names[index].c_str());
+    }
+}
+
 std::string Shader::ReadFile(const std::string& filePath) {
     std::ifstream file(filePath);
     if (!file.is_open()) {
@@ -191,7 +365,7 @@ std::string Shader::ReadFile(const std::string& filePath) {
     return buffer.str();
 }
 
-void Shader::CheckCompileErrors(GLuint shader, const std::string& type) {
+bool Shader::CheckCompileErrors(GLuint shader, const std::string& type) {
     GLint success;
     GLchar infoLog[1024];
     
@@ -210,4 +384,5 @@ void Shader::CheckCompileErrors(GLuint shader, const std::string& type) {
                       << infoLog << std::endl;
         }
     }
+    return success == GL_TRUE;
 }
@@ -0,0 +1,147 @@
+#include "Engine/ShaderCache.h"
+#include "Utils/FileUtils.h"
+#include "Utils/Hash.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const char CACHE_MAGIC[4] = { 'S', 'P', 'B', 'C' };
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    std::string GetGLString(GLenum name) {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+ShaderCache& ShaderCache::Instance() {
+    static ShaderCache cache;
+    return cache;
+}
+
+ShaderCache::ShaderCache()
+    : directory("shader_cache"), enabled(true), binaryFormats(-1), hits(0), compiles(0), rejected(0) {
+}
+
+void ShaderCache::SetDirectory(const std::string& dir) {
+    directory = dir;
+}
+
+bool ShaderCache::IsEnabled() const {
+    return enabled && binaryFormats > 0;
+}
+
+uint64_t ShaderCache::MakeKey(const StageSources& stages, const std::string& defines) {
+    if (binaryFormats < 0) {
+        // First program: the context is current from here on
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+        driverId = GetGLString(GL_VENDOR) + "|" + GetGLString(GL_RENDERER) + "|" + GetGLString(GL_VERSION);
+        if (binaryFormats == 0) {
+            std::cout << "Driver exposes no program binary formats; shader cache disabled" << std::endl;
+        }
+    }
+
+    uint64_t hash = HashBytes(driverId.data(), driverId.size());
+    hash = HashBytes(defines.data(), defines.size(), hash);
+    for (const auto& stage : stages) {
+        hash = HashBytes(&stage.first, sizeof(stage.first), hash);
+        hash = HashBytes(stage.second.data(), stage.second.size(), hash);
+    }
+    return hash;
+}
+
+std::string ShaderCache::GetEntryPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+bool ShaderCache::Load(uint64_t key, GLuint program) {
+    if (!IsEnabled()) {
+        return false;
+    }
+
+    std::string path = GetEntryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    // The length must match what is actually left in the file
+    std::error_code sizeError;
+    uintmax_t fileSize = std::filesystem::file_size(path, sizeError);
+    CacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    bool valid = file && !sizeError && std::equal(header.magic, header.magic + 4, CACHE_MAGIC) &&
+                 header.version == CACHE_VERSION && header.key == key && header.length > 0 &&
+                 header.length == fileSize - sizeof(header);
+
+    std::vector<char> binary;
+    if (valid) {
+        binary.resize(header.length);
+        file.read(binary.data(), binary.size());
+        valid = static_cast<bool>(file);
+    }
+
+    if (valid) {
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        valid = linked == GL_TRUE;
+    }
+
+    if (!valid) {
+        // Truncated, from another build, or refused by the driver
+        file.close();
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        rejected++;
+        return false;
+    }
+
+    hits++;
+    return true;
+}
+
+void ShaderCache::Store(uint64_t key, GLuint program) {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    std::string path = GetEntryPath(key);
+    bool written = FileUtils::WriteFileAtomic(path, [&](std::ostream& file) {
+        CacheHeader header;
+        std::copy(CACHE_MAGIC, CACHE_MAGIC + 4, header.magic);
+        header.version = CACHE_VERSION;
+        header.key = key;
+        header.format = format;
+        header.length = static_cast<uint32_t>(length);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), binary.size());
+        return true;
+    });
+    if (!written) {
+        std::cerr << "Failed to write shader cache entry: " << path << std::endl;
+    }
+}
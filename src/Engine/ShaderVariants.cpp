@@ -0,0 +1,120 @@
+#include "Engine/ShaderVariants.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    std::string ReadSource(const std::string& filePath) {
+        std::ifstream file(filePath);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open shader file: " << filePath << std::endl;
+            return "";
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+}
+
+uint32_t ShaderVariants::LightBucketBits(int lightCount) {
+    int bucket = LIGHT_BUCKET_COUNT - 1;
+    for (int i = 0; i < LIGHT_BUCKET_COUNT; ++i) {
+        if (lightCount <= LIGHT_BUCKETS[i]) {
+            bucket = i;
+            break;
+        }
+    }
+    return static_cast<uint32_t>(bucket) << LIGHT_BUCKET_SHIFT;
+}
+
+ShaderVariants::ShaderVariants() {
+}
+
+bool ShaderVariants::LoadFromFiles(const std::string& vertexPath, const std::string& fragmentPath) {
+    this->vertexPath = vertexPath;
+    this->fragmentPath = fragmentPath;
+    vertexSource = ReadSource(vertexPath);
+    fragmentSource = ReadSource(fragmentPath);
+    name = vertexPath + " + " + fragmentPath;
+    variants.clear();
+    return !vertexSource.empty() && !fragmentSource.empty();
+}
+
+std::vector<std::string> ShaderVariants::GetDefines(uint32_t features) {
+    std::vector<std::string> defines;
+    if (features & INSTANCING) defines.push_back("INSTANCING");
+    if (features & SHADOWS) defines.push_back("SHADOWS");
+    if (features & NORMAL_MAP) defines.push_back("NORMAL_MAP");
+    if (features & UNLIT) defines.push_back("UNLIT");
+
+    int bucket = std::min<int>((features >> LIGHT_BUCKET_SHIFT) & 0xFF, LIGHT_BUCKET_COUNT - 1);
+    defines.push_back("LIGHT_COUNT " + std::to_string(LIGHT_BUCKETS[bucket]));
+    return defines;
+}
+
+Shader* ShaderVariants::Get(uint32_t features) {
+    auto it = variants.find(features);
+    if (it != variants.end()) {
+        return it->second.get();
+    }
+
+    // A failed build is remembered as nullptr so it is not retried every frame
+    auto shader = std::make_unique<Shader>();
+    if (!shader->LoadFromSources(vertexSource, fragmentSource, GetDefines(features))) {
+        std::cerr << "Failed to build variant 0x" << std::hex << features << std::dec
+                  << " of " << name << std::endl;
+        variants.emplace(features, nullptr);
+        return nullptr;
+    }
+
+    Initialize(*shader);
+
+    Shader* result = shader.get();
+    variants.emplace(features, std::move(shader));
+    return result;
+}
+
+bool ShaderVariants::Reload() {
+    std::string newVertexSource = ReadSource(vertexPath);
+    std::string newFragmentSource = ReadSource(fragmentPath);
+    if (newVertexSource.empty() || newFragmentSource.empty()) {
+        return false;
+    }
+    vertexSource = newVertexSource;
+    fragmentSource = newFragmentSource;
+
+    int rebuilt = 0;
+    int failed = 0;
+    for (auto it = variants.begin(); it != variants.end();) {
+        if (!it->second) {
+            // Failed before; try again with the new sources on next use
+            it = variants.erase(it);
+            continue;
+        }
+        if (it->second->LoadFromSources(vertexSource, fragmentSource, GetDefines(it->first))) {
+            // Relinking resets uniform values such as sampler units
+            Initialize(*it->second);
+            rebuilt++;
+        } else {
+            failed++;
+        }
+        ++it;
+    }
+
+    std::cout << "Reloaded " << name << ": " << rebuilt << " variants rebuilt";
+    if (failed > 0) {
+        std::cout << ", " << failed << " failed and kept their previous program";
+    }
+    std::cout << std::endl;
+    return failed == 0;
+}
+
+void ShaderVariants::Initialize(Shader& shader) {
+    if (initializer) {
+        shader.Use();
+        initializer(shader);
+        shader.Unuse();
+    }
+}
@@ -0,0 +1,204 @@
+#include "Engine/TerrainTileCache.h"
+#include "Engine/TraceRecorder.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+TerrainTileCache::TerrainTileCache(std::shared_ptr<const TerrainPyramid> source, int workerCount)
+    : pyramid(std::move(source)), memoryBudget(DEFAULT_MEMORY_BUDGET), rootKey(0), residentBytes(0), frame(0),
+      stopping(false), activeReads(0) {
+    int count = workerCount;
+    if (count <= 0) {
+        // Reads mostly wait on the disk; a couple of threads keep it busy
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        count = std::clamp(cores - 1, 1, 2);
+    }
+    for (int i = 0; i < count; ++i) {
+        workers.emplace_back(&TerrainTileCache::WorkerLoop, this);
+    }
+
+    rootKey = GetKey(pyramid->GetRootLevel(), 0, 0);
+    Request(pyramid->GetRootLevel(), 0, 0);
+    Flush();
+}
+
+TerrainTileCache::~TerrainTileCache() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobCondition.notify_all();
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+uint64_t TerrainTileCache::GetKey(int level, int x, int z) {
+    return (static_cast<uint64_t>(level) << 56) | (static_cast<uint64_t>(x) << 28) | static_cast<uint64_t>(z);
+}
+
+const float* TerrainTileCache::Find(int level, int x, int z) {
+    auto it = tiles.find(GetKey(level, x, z));
+    if (it == tiles.end()) {
+        return nullptr;
+    }
+    it->second.lastUsed = frame;
+    return it->second.samples.data();
+}
+
+void TerrainTileCache::Request(int level, int x, int z) {
+    uint64_t key = GetKey(level, x, z);
+    if (tiles.count(key) || failed.count(key)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if (reading.count(key)) {
+            return;
+        }
+        auto it = queued.find(key);
+        if (it != queued.end()) {
+            it->second.frame = frame;
+            return;
+        }
+        queued[key] = { level, x, z, frame };
+        jobOrder.push_back(key);
+    }
+    jobCondition.notify_one();
+}
+
+void TerrainTileCache::WorkerLoop() {
+    TraceRecorder::Instance().SetThreadName("Terrain I/O");
+    std::ifstream file(pyramid->GetFilePath(), std::ios::binary);
+
+    while (true) {
+        uint64_t key;
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCondition.wait(lock, [this]() { return stopping || !jobOrder.empty(); });
+            if (stopping) {
+                return;
+            }
+            key = jobOrder.front();
+            jobOrder.pop_front();
+            auto it = queued.find(key);
+            if (it == queued.end()) {
+                continue;   // Dropped by Update
+            }
+            job = it->second;
+            queued.erase(it);
+            reading.insert(key);
+            activeReads++;
+        }
+
+        Result result{ key, std::vector<float>(pyramid->GetTileBytes() / sizeof(float)) };
+        {
+            TRACE_SCOPE("TerrainTileCache::Read");
+            if (!file || !pyramid->ReadTile(file, job.level, job.x, job.z, result.samples.data())) {
+                result.samples.clear();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            results.push_back(std::move(result));
+        }
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            activeReads--;
+        }
+        idleCondition.notify_all();
+    }
+}
+
+void TerrainTileCache::AdoptResults() {
+    std::vector<Result> finished;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        finished.swap(results);
+    }
+    if (finished.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(jobMutex);
+    for (Result& result : finished) {
+        reading.erase(result.key);
+        if (result.samples.empty()) {
+            std::cerr << "Failed to read terrain tile from " << pyramid->GetFilePath() << std::endl;
+            failed.insert(result.key);
+            continue;
+        }
+        if (tiles.count(result.key)) {
+            continue;
+        }
+        residentBytes += result.samples.size() * sizeof(float);
+        tiles[result.key] = { std::move(result.samples), frame };
+    }
+}
+
+void TerrainTileCache::Update() {
+    TRACE_SCOPE("TerrainTileCache::Update");
+    frame++;
+    AdoptResults();
+
+    // Reads the camera has moved away from are not worth the disk time
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        for (auto it = queued.begin(); it != queued.end();) {
+            if (it->second.frame + 1 < frame) {
+                it = queued.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        jobOrder.erase(std::remove_if(jobOrder.begin(), jobOrder.end(),
+                                      [this](uint64_t key) { return queued.count(key) == 0; }),
+                       jobOrder.end());
+    }
+
+    Evict();
+}
+
+void TerrainTileCache::Evict() {
+    if (residentBytes <= memoryBudget) {
+        return;
+    }
+
+    // Least recently used first; anything touched last frame stays
+    std::vector<std::pair<uint64_t, uint64_t>> candidates;
+    for (const auto& entry : tiles) {
+        if (entry.first != rootKey && entry.second.lastUsed + 1 < frame) {
+            candidates.push_back({ entry.second.lastUsed, entry.first });
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    const size_t tileBytes = pyramid->GetTileBytes();
+    for (const auto& candidate : candidates) {
+        if (residentBytes <= memoryBudget) {
+            break;
+        }
+        tiles.erase(candidate.second);
+        residentBytes -= tileBytes;
+    }
+}
+
+void TerrainTileCache::Flush() {
+    {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        idleCondition.wait(lock, [this]() { return stopping || (queued.empty() && activeReads == 0); });
+    }
+    AdoptResults();
+}
+
+TerrainTileCache::Stats TerrainTileCache::GetStats() const {
+    Stats stats;
+    stats.resident = static_cast<int>(tiles.size());
+    stats.residentBytes = residentBytes;
+    std::lock_guard<std::mutex> lock(jobMutex);
+    stats.pending = static_cast<int>(queued.size() + reading.size());
+    return stats;
+}
@@ -1,80 +1,484 @@
 #include "Engine/Texture.h"
+#include "Engine/TraceRecorder.h"
+#include "Utils/FileUtils.h"
+#include "Utils/ImageLoader.h"
 #include <GL/glew.h>
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 
-Texture::Texture() : id(0), width(0), height(0), channels(0) {
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+Texture::Texture()
+    : textureID(0), target(GL_TEXTURE_2D), framebuffer(0), width(0), height(0), type(TextureType::DIFFUSE),
+      format(TextureFormat::RGBA), channels(0), hasMipmaps(false), resident(true), watchId(0) {
+}
+
+Texture::Texture(const std::string& filePath, TextureType type) : Texture() {
+    this->type = type;
+    LoadFromFile(filePath);
+}
+
+Texture::Texture(int width, int height, TextureFormat format, TextureType type) : Texture() {
+    this->type = type;
+    Create(width, height, format);
 }
 
 Texture::~Texture() {
-    if (id != 0) {
-        glDeleteTextures(1, &id);
+    if (watchId != 0) {
+        FileUtils::UnwatchFile(watchId);
     }
+    DeleteTexture();
 }
 
 bool Texture::LoadFromFile(const std::string& path) {
-    // For now, create a simple 1x1 texture
-    // In a full implementation, this would load from file using stb_image
-    
-    unsigned char data[] = {255, 255, 255, 255}; // White texture
-    
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
-    
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    width = 1;
-    height = 1;
-    channels = 4;
-    
+    TRACE_SCOPE("Texture::LoadFromFile");
+    // Synchronous; TextureStreamer decodes and uploads without stalling
+    Image image;
+    std::string error;
+    if (!ImageLoader::Load(path, image, error)) {
+        std::cerr << error << std::endl;
+        return false;
+    }
+
+    if (image.IsCompressed() || image.levels.size() > 1) {
+        if (!LoadLevels(image)) {
+            std::cerr << "Failed to upload texture: " << path << std::endl;
+            return false;
+        }
+    } else {
+        if (!LoadFromMemory(image.pixels.data(), image.width, image.height, image.channels)) {
+            return false;
+        }
+        GenerateMipmaps();
+    }
+
+    filePath = path;
+    if (watchId == 0 && FileUtils::IsWatchingFiles()) {
+        watchId = FileUtils::WatchFile(path, [this]() { Reload(); });
+    }
+    return true;
+}
+
+bool Texture::Reload() {
+    if (filePath.empty()) {
+        return false;
+    }
+    std::string path = filePath;
+    if (!LoadFromFile(path)) {
+        std::cerr << "Texture reload failed: " << path << std::endl;
+        return false;
+    }
+    std::cout << "Reloaded texture: " << path << std::endl;
     return true;
 }
 
-bool Texture::CreateFromData(unsigned char* data, int w, int h, int c) {
-    if (id != 0) {
-        glDeleteTextures(1, &id);
-    }
-    
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
-    
-    GLenum format = (c == 4) ? GL_RGBA : (c == 3) ? GL_RGB : GL_RED;
-    
-    glTexImage2D(GL_TEXTURE_2D, 0, format, w, h, 0, format, GL_UNSIGNED_BYTE, data);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
+bool Texture::LoadFromMemory(const unsigned char* data, int w, int h, int c) {
+    static const GLenum DATA_FORMATS[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+    if (!data || w <= 0 || h <= 0 || c < 1 || c > 4) {
+        std::cerr << "Invalid texture data: " << w << "x" << h << "x" << c << std::endl;
+        return false;
+    }
+
+    // Reloads reuse the texture object, so materials sharing it see the change
+    target = GL_TEXTURE_2D;
+    InitializeTexture();
+
+    format = ChooseFormat(c);
     width = w;
     height = h;
     channels = c;
-    
+    hasMipmaps = false;
+    resident = true;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GetGLInternalFormat(format), w, h, 0, DATA_FORMATS[c - 1], GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // LoadLevels may have capped the level range of this texture object
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+
+    SetTextureParameters();
     return true;
 }
 
-void Texture::Bind(unsigned int slot) const {
+bool Texture::LoadLevels(const Image& image) {
+    TextureFormat levelFormat = GetImageFormat(image, type);
+    if (!IsFormatSupported(levelFormat)) {
+        std::cerr << "Texture format not supported by the driver (internal format 0x" << std::hex
+                  << GetGLInternalFormat(levelFormat) << std::dec << ")" << std::endl;
+        return false;
+    }
+
+    target = GL_TEXTURE_2D;
+    InitializeTexture();
+
+    format = levelFormat;
+    width = image.width;
+    height = image.height;
+    channels = image.channels;
+    hasMipmaps = image.levels.size() > 1;
+    resident = true;
+
+    GLenum internalFormat = GetGLInternalFormat(format);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t level = 0; level < image.levels.size(); ++level) {
+        const Image::Level& source = image.levels[level];
+        const unsigned char* data = image.pixels.data() + source.offset;
+        if (image.IsCompressed()) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internalFormat, source.width, source.height,
+                                   0, static_cast<GLsizei>(source.size), data);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internalFormat, source.width, source.height, 0,
+                         GetGLFormat(format), GL_UNSIGNED_BYTE, data);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size()) - 1);
+
+    SetTextureParameters();
+    return true;
+}
+
+void Texture::Create(int w, int h, TextureFormat textureFormat) {
+    target = GL_TEXTURE_2D;
+    InitializeTexture();
+
+    width = w;
+    height = h;
+    format = textureFormat;
+    hasMipmaps = false;
+    resident = true;
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GetGLInternalFormat(format), w, h, 0, GetGLFormat(format),
+                 GetGLDataType(format), nullptr);
+    SetTextureParameters();
+}
+
+void Texture::CreateCubemap(const std::vector<std::string>& facePaths) {
+    TRACE_SCOPE("Texture::CreateCubemap");
+    if (facePaths.size() != 6) {
+        std::cerr << "A cubemap needs 6 faces, got " << facePaths.size() << std::endl;
+        return;
+    }
+
+    DeleteTexture();
+    target = GL_TEXTURE_CUBE_MAP;
+    type = TextureType::CUBEMAP;
+    InitializeTexture();
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t face = 0; face < facePaths.size(); ++face) {
+        Image image;
+        std::string error;
+        if (!ImageLoader::Load(facePaths[face], image, error)) {
+            std::cerr << error << std::endl;
+            continue;
+        }
+        GLenum dataFormat = image.channels == 4 ? GL_RGBA : image.channels == 2 ? GL_RG : GL_RED;
+        format = image.channels == 4 ? TextureFormat::RGBA : image.channels == 2 ? TextureFormat::RG : TextureFormat::R;
+        width = image.width;
+        height = image.height;
+        channels = image.channels;
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(face), 0, GetGLInternalFormat(format),
+                     image.width, image.height, 0, dataFormat, GL_UNSIGNED_BYTE, image.pixels.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    hasMipmaps = false;
+    resident = true;
+    SetTextureParameters();
+    SetWrap(TextureWrap::CLAMP_TO_EDGE, TextureWrap::CLAMP_TO_EDGE, TextureWrap::CLAMP_TO_EDGE);
+}
+
+void Texture::CreateShadowMap(int w, int h) {
+    type = TextureType::SHADOW_MAP;
+    Create(w, h, TextureFormat::DEPTH);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    SetWrap(TextureWrap::CLAMP_TO_BORDER, TextureWrap::CLAMP_TO_BORDER);
+    SetBorderColor(glm::vec4(1.0f));
+}
+
+void Texture::AdoptStorage(GLuint texture, int w, int h, int c, TextureFormat textureFormat, bool mipmaps) {
+    DeleteTexture();
+    textureID = texture;
+    target = GL_TEXTURE_2D;
+    width = w;
+    height = h;
+    channels = c;
+    format = textureFormat;
+    hasMipmaps = mipmaps;
+    resident = true;
+}
+
+void Texture::SetFilter(TextureFilter minFilter, TextureFilter magFilter) {
+    glBindTexture(target, textureID);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GetGLFilter(minFilter));
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GetGLFilter(magFilter));
+}
+
+void Texture::SetWrap(TextureWrap sWrap, TextureWrap tWrap, TextureWrap rWrap) {
+    glBindTexture(target, textureID);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GetGLWrap(sWrap));
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GetGLWrap(tWrap));
+    glTexParameteri(target, GL_TEXTURE_WRAP_R, GetGLWrap(rWrap));
+}
+
+void Texture::SetBorderColor(const glm::vec4& color) {
+    glBindTexture(target, textureID);
+    glTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, &color[0]);
+}
+
+void Texture::GenerateMipmaps() {
+    // Block-compressed levels come from the file; drivers cannot build them
+    if (textureID == 0 || IsCompressed(format)) {
+        return;
+    }
+    glBindTexture(target, textureID);
+    glGenerateMipmap(target);
+    hasMipmaps = true;
+    SetTextureParameters();
+}
+
+void Texture::SetAnisotropicFiltering(float maxAnisotropy) {
+    GLfloat supported = 1.0f;
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &supported);
+    glBindTexture(target, textureID);
+    glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(maxAnisotropy, supported));
+}
+
+void Texture::Bind(unsigned int slot) {
     glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, id);
+    glBindTexture(target, textureID);
+}
+
+void Texture::Unbind() {
+    glBindTexture(target, 0);
+}
+
+void Texture::BindAsRenderTarget() {
+    if (framebuffer == 0) {
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        bool depth = format == TextureFormat::DEPTH || format == TextureFormat::DEPTH_STENCIL;
+        GLenum attachment = format == TextureFormat::DEPTH_STENCIL ? GL_DEPTH_STENCIL_ATTACHMENT :
+                            depth ? GL_DEPTH_ATTACHMENT : GL_COLOR_ATTACHMENT0;
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, textureID, 0);
+        if (depth) {
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Texture render target is incomplete" << std::endl;
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+void Texture::UnbindRenderTarget() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Texture::UpdateData(const unsigned char* data) {
+    if (textureID == 0 || target != GL_TEXTURE_2D) {
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GetGLFormat(format), GetGLDataType(format), data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (hasMipmaps) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+void Texture::Resize(int newWidth, int newHeight) {
+    // Contents are discarded
+    bool mipmaps = hasMipmaps;
+    Create(newWidth, newHeight, format);
+    if (mipmaps) {
+        GenerateMipmaps();
+    }
+}
+
+void Texture::SaveToFile(const std::string& path) {
+    // Binary PPM of the first level
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+    glBindTexture(target, textureID);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : target, 0, GL_RGBA,
+                  GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to write texture: " << path << std::endl;
+        return;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (int y = height - 1; y >= 0; --y) {
+        for (int x = 0; x < width; ++x) {
+            file.write(reinterpret_cast<const char*>(&pixels[(static_cast<size_t>(y) * width + x) * 4]), 3);
+        }
+    }
+}
+
+void Texture::GetData(unsigned char* data) {
+    glBindTexture(target, textureID);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(target, 0, GetGLFormat(format), GetGLDataType(format), data);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+}
+
+void Texture::InitializeTexture() {
+    if (textureID == 0) {
+        glGenTextures(1, &textureID);
+    }
+    glBindTexture(target, textureID);
+}
+
+void Texture::SetTextureParameters() {
+    glBindTexture(target, textureID);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, hasMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+TextureFormat Texture::ChooseFormat(int c) const {
+    if (c == 1) return TextureFormat::R;
+    if (c == 2) return TextureFormat::RG;
+    if (type == TextureType::DIFFUSE) return TextureFormat::SRGB_ALPHA;
+    return c == 3 ? TextureFormat::RGB : TextureFormat::RGBA;
 }
 
-GLuint Texture::GetID() const {
-    return id;
+GLenum Texture::GetGLFormat(TextureFormat textureFormat) {
+    switch (textureFormat) {
+        case TextureFormat::R: return GL_RED;
+        case TextureFormat::RG: return GL_RG;
+        case TextureFormat::RGB:
+        case TextureFormat::RGB16F:
+        case TextureFormat::RGB32F: return GL_RGB;
+        case TextureFormat::DEPTH: return GL_DEPTH_COMPONENT;
+        case TextureFormat::DEPTH_STENCIL: return GL_DEPTH_STENCIL;
+        default: return GL_RGBA;
+    }
 }
 
-int Texture::GetWidth() const {
-    return width;
+GLenum Texture::GetGLInternalFormat(TextureFormat textureFormat) {
+    switch (textureFormat) {
+        case TextureFormat::RGB: return GL_RGB8;
+        case TextureFormat::RGBA: return GL_RGBA8;
+        case TextureFormat::SRGB_ALPHA: return GL_SRGB8_ALPHA8;
+        case TextureFormat::DEPTH: return GL_DEPTH_COMPONENT24;
+        case TextureFormat::DEPTH_STENCIL: return GL_DEPTH24_STENCIL8;
+        case TextureFormat::R: return GL_R8;
+        case TextureFormat::RG: return GL_RG8;
+        case TextureFormat::RGB16F: return GL_RGB16F;
+        case TextureFormat::RGBA16F: return GL_RGBA16F;
+        case TextureFormat::RGB32F: return GL_RGB32F;
+        case TextureFormat::RGBA32F: return GL_RGBA32F;
+        case TextureFormat::BC1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case TextureFormat::BC1_SRGB: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        case TextureFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TextureFormat::BC3_SRGB: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case TextureFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+        case TextureFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+        case TextureFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case TextureFormat::BC7_SRGB: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+    }
+    return GL_RGBA8;
 }
 
-int Texture::GetHeight() const {
-    return height;
+bool Texture::IsCompressed(TextureFormat textureFormat) {
+    switch (textureFormat) {
+        case TextureFormat::BC1:
+        case TextureFormat::BC1_SRGB:
+        case TextureFormat::BC3:
+        case TextureFormat::BC3_SRGB:
+        case TextureFormat::BC4:
+        case TextureFormat::BC5:
+        case TextureFormat::BC7:
+        case TextureFormat::BC7_SRGB: return true;
+        default: return false;
+    }
 }
 
-int Texture::GetChannels() const {
-    return channels;
+bool Texture::IsFormatSupported(TextureFormat textureFormat) {
+    GLint supported = GL_FALSE;
+    glGetInternalformativ(GL_TEXTURE_2D, GetGLInternalFormat(textureFormat), GL_INTERNALFORMAT_SUPPORTED, 1, &supported);
+    return supported == GL_TRUE;
+}
+
+TextureFormat Texture::GetImageFormat(const Image& image, TextureType textureType) {
+    switch (image.blockFormat) {
+        case BlockFormat::BC1: return image.srgb ? TextureFormat::BC1_SRGB : TextureFormat::BC1;
+        case BlockFormat::BC3: return image.srgb ? TextureFormat::BC3_SRGB : TextureFormat::BC3;
+        case BlockFormat::BC4: return TextureFormat::BC4;
+        case BlockFormat::BC5: return TextureFormat::BC5;
+        case BlockFormat::BC7: return image.srgb ? TextureFormat::BC7_SRGB : TextureFormat::BC7;
+        case BlockFormat::NONE: break;
+    }
+    if (image.channels == 1) return TextureFormat::R;
+    if (image.channels == 2) return TextureFormat::RG;
+    return image.srgb || textureType == TextureType::DIFFUSE ? TextureFormat::SRGB_ALPHA : TextureFormat::RGBA;
+}
+
+GLenum Texture::GetGLDataType(TextureFormat textureFormat) {
+    switch (textureFormat) {
+        case TextureFormat::DEPTH: return GL_FLOAT;
+        case TextureFormat::DEPTH_STENCIL: return GL_UNSIGNED_INT_24_8;
+        case TextureFormat::RGB16F:
+        case TextureFormat::RGBA16F: return GL_HALF_FLOAT;
+        case TextureFormat::RGB32F:
+        case TextureFormat::RGBA32F: return GL_FLOAT;
+        default: return GL_UNSIGNED_BYTE;
+    }
+}
+
+GLenum Texture::GetGLFilter(TextureFilter filter) {
+    switch (filter) {
+        case TextureFilter::NEAREST: return GL_NEAREST;
+        case TextureFilter::LINEAR: return GL_LINEAR;
+        case TextureFilter::NEAREST_MIPMAP_NEAREST: return GL_NEAREST_MIPMAP_NEAREST;
+        case TextureFilter::LINEAR_MIPMAP_NEAREST: return GL_LINEAR_MIPMAP_NEAREST;
+        case TextureFilter::NEAREST_MIPMAP_LINEAR: return GL_NEAREST_MIPMAP_LINEAR;
+        case TextureFilter::LINEAR_MIPMAP_LINEAR: return GL_LINEAR_MIPMAP_LINEAR;
+    }
+    return GL_LINEAR;
+}
+
+GLenum Texture::GetGLWrap(TextureWrap wrap) {
+    switch (wrap) {
+        case TextureWrap::REPEAT: return GL_REPEAT;
+        case TextureWrap::MIRRORED_REPEAT: return GL_MIRRORED_REPEAT;
+        case TextureWrap::CLAMP_TO_EDGE: return GL_CLAMP_TO_EDGE;
+        case TextureWrap::CLAMP_TO_BORDER: return GL_CLAMP_TO_BORDER;
+    }
+    return GL_REPEAT;
+}
+
+void Texture::DeleteTexture() {
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if (textureID != 0) {
+        glDeleteTextures(1, &textureID);
+        textureID = 0;
+    }
 }
@@ -0,0 +1,403 @@
+#include "Engine/TextureStreamer.h"
+#include "Engine/TraceRecorder.h"
+#include "Utils/FileUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace {
+    // Chunks start on 16-byte boundaries inside a PBO
+    size_t AlignChunk(size_t size) {
+        return (size + 15) & ~static_cast<size_t>(15);
+    }
+}
+
+TextureStreamer& TextureStreamer::Instance() {
+    static TextureStreamer streamer;
+    return streamer;
+}
+
+TextureStreamer::TextureStreamer()
+    : workerCount(0), uploadBudget(DEFAULT_UPLOAD_BUDGET), stopping(false), activeDecodes(0),
+      pixelBuffers{}, nextPixelBuffer(0), uploadedBytes(0), residentCount(0) {
+}
+
+TextureStreamer::~TextureStreamer() {
+    // GL objects are released by Shutdown while the context is current
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobCondition.notify_all();
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+std::shared_ptr<Texture> TextureStreamer::Load(const std::string& filePath, TextureType type) {
+    std::string key = std::to_string(static_cast<int>(type)) + ":" + filePath;
+    auto it = textures.find(key);
+    if (it != textures.end()) {
+        if (auto texture = it->second.lock()) {
+            return texture;
+        }
+    }
+
+    // Neutral until resident: white multiplies the material factors by one,
+    // and the flat normal leaves the surface normal unchanged
+    static const unsigned char WHITE[4] = { 255, 255, 255, 255 };
+    static const unsigned char FLAT_NORMAL[4] = { 128, 128, 255, 255 };
+    auto texture = std::make_shared<Texture>(1, 1, TextureFormat::RGBA, type);
+    texture->UpdateData(type == TextureType::NORMAL ? FLAT_NORMAL : WHITE);
+    texture->SetResident(false);
+    textures[key] = texture;
+
+    Enqueue(filePath, texture, type);
+
+    if (FileUtils::IsWatchingFiles()) {
+        std::weak_ptr<Texture> weak = texture;
+        FileUtils::WatchFile(filePath, [this, filePath, weak, type]() {
+            // The current image stays until the new one is fully uploaded
+            if (auto watched = weak.lock()) {
+                Enqueue(filePath, watched, type);
+            }
+        });
+    }
+    return texture;
+}
+
+void TextureStreamer::Enqueue(const std::string& path, const std::shared_ptr<Texture>& texture, TextureType type) {
+    if (workers.empty()) {
+        StartWorkers();
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobs.push_back({ path, texture, type });
+    }
+    jobCondition.notify_one();
+}
+
+void TextureStreamer::StartWorkers() {
+    int count = workerCount;
+    if (count <= 0) {
+        // Leave a core for the render thread
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        count = std::clamp(cores - 1, 1, 4);
+    }
+
+    stopping = false;
+    for (int i = 0; i < count; ++i) {
+        workers.emplace_back(&TextureStreamer::WorkerLoop, this);
+    }
+}
+
+void TextureStreamer::WorkerLoop() {
+    TraceRecorder::Instance().SetThreadName("Texture decode");
+
+    while (true) {
+        DecodeJob job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            activeDecodes++;
+        }
+
+        Upload upload{ job.path, job.texture, job.type, Image(), 0, 0, 0 };
+        bool decodedOk = false;
+        if (!job.texture.expired()) {
+            TRACE_SCOPE("TextureStreamer::Decode");
+            std::string error;
+            if (!ImageLoader::Load(job.path, upload.image, error)) {
+                std::cerr << error << std::endl;
+            } else if (static_cast<GLsizeiptr>(upload.image.GetRowBytes(0)) > PBO_SIZE) {
+                std::cerr << "Texture too wide to stream: " << job.path << std::endl;
+            } else {
+                // Containers may bring their own chain (always, when compressed)
+                if (upload.image.levels.size() == 1) {
+                    ImageLoader::GenerateMipChain(upload.image);
+                }
+                decodedOk = true;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (decodedOk) {
+                decoded.push_back(std::move(upload));
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            activeDecodes--;
+        }
+    }
+}
+
+TextureStreamer::PixelBuffer* TextureStreamer::AcquirePixelBuffer() {
+    PixelBuffer& pbo = pixelBuffers[nextPixelBuffer];
+    if (pbo.buffer == 0) {
+        glGenBuffers(1, &pbo.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, PBO_SIZE, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // Never wait: a PBO the GPU is still reading from means try next frame
+    if (pbo.fence) {
+        GLenum status = glClientWaitSync(pbo.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return nullptr;
+        }
+        glDeleteSync(pbo.fence);
+        pbo.fence = nullptr;
+    }
+
+    nextPixelBuffer = (nextPixelBuffer + 1) % PBO_COUNT;
+    return &pbo;
+}
+
+void TextureStreamer::Update() {
+    TRACE_SCOPE("TextureStreamer::Update");
+    uploadedBytes = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        for (Upload& upload : decoded) {
+            uploads.push_back(std::move(upload));
+        }
+        decoded.clear();
+    }
+
+    std::vector<Upload> finished;
+    while (!uploads.empty() && uploadedBytes < uploadBudget) {
+        PixelBuffer* pbo = AcquirePixelBuffer();
+        if (!pbo) {
+            break;
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo->buffer);
+        auto* mapped = static_cast<unsigned char*>(glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER, 0, PBO_SIZE,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        if (!mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            break;
+        }
+
+        // Fill the PBO with as many rows as the budget allows, possibly
+        // spanning several levels and textures
+        chunks.clear();
+        size_t used = 0;
+        while (!uploads.empty()) {
+            Upload& upload = uploads.front();
+            if (upload.texture.expired()) {
+                if (upload.staging != 0) {
+                    glDeleteTextures(1, &upload.staging);
+                }
+                uploads.pop_front();
+                continue;
+            }
+
+            if (upload.staging == 0) {
+                TextureFormat format = Texture::GetImageFormat(upload.image, upload.type);
+                if (!Texture::IsFormatSupported(format)) {
+                    // The placeholder stays
+                    std::cerr << "Texture format not supported by the driver: " << upload.path << std::endl;
+                    uploads.pop_front();
+                    continue;
+                }
+                glGenTextures(1, &upload.staging);
+                glBindTexture(GL_TEXTURE_2D, upload.staging);
+                glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(upload.image.levels.size()),
+                               Texture::GetGLInternalFormat(format), upload.image.width, upload.image.height);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            }
+
+            size_t space = used < static_cast<size_t>(PBO_SIZE) ? PBO_SIZE - used : 0;
+            size_t budget = uploadBudget - std::min(uploadBudget, uploadedBytes);
+            // At least one row per frame, so a tiny budget still makes progress
+            if (uploadedBytes == 0) {
+                budget = std::max(budget, upload.image.GetRowBytes(static_cast<int>(upload.level)));
+            }
+
+            size_t staged = StageChunk(upload, mapped, static_cast<GLintptr>(used), std::min(space, budget));
+            if (staged == 0) {
+                break;
+            }
+            used += AlignChunk(staged);
+            uploadedBytes += staged;
+
+            if (upload.level == upload.image.levels.size()) {
+                finished.push_back(std::move(upload));
+                uploads.pop_front();
+            }
+        }
+
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (const PendingChunk& chunk : chunks) {
+            glBindTexture(GL_TEXTURE_2D, chunk.texture);
+            const void* source = reinterpret_cast<const void*>(chunk.offset);
+            if (chunk.compressedFormat != 0) {
+                glCompressedTexSubImage2D(GL_TEXTURE_2D, chunk.level, 0, chunk.y, chunk.width, chunk.height,
+                                          chunk.compressedFormat, chunk.size, source);
+            } else {
+                glTexSubImage2D(GL_TEXTURE_2D, chunk.level, 0, chunk.y, chunk.width, chunk.height,
+                                chunk.dataFormat, GL_UNSIGNED_BYTE, source);
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        pbo->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        if (chunks.empty()) {
+            break;
+        }
+    }
+
+    for (Upload& upload : finished) {
+        FinishUpload(upload);
+    }
+}
+
+size_t TextureStreamer::StageChunk(Upload& upload, unsigned char* mapped, GLintptr offset, size_t maxBytes) {
+    const Image& image = upload.image;
+    const Image::Level& level = image.levels[upload.level];
+    size_t rowBytes = image.GetRowBytes(static_cast<int>(upload.level));
+    int rowCount = image.GetRowCount(static_cast<int>(upload.level));
+    int rows = std::min<int>(rowCount - upload.row, static_cast<int>(maxBytes / rowBytes));
+    if (rows <= 0) {
+        return 0;
+    }
+
+    size_t size = rows * rowBytes;
+    std::memcpy(mapped + offset, image.pixels.data() + level.offset + upload.row * rowBytes, size);
+
+    // A compressed row is four texels high; the last one may be cut short
+    int rowHeight = image.IsCompressed() ? 4 : 1;
+    int y = upload.row * rowHeight;
+    GLenum compressedFormat = 0;
+    if (image.IsCompressed()) {
+        compressedFormat = Texture::GetGLInternalFormat(Texture::GetImageFormat(image, upload.type));
+    }
+    chunks.push_back({ upload.staging, static_cast<GLint>(upload.level), y, std::min(rows * rowHeight, level.height - y),
+                       level.width, GetDataFormat(image.channels), compressedFormat, static_cast<GLsizei>(size), offset });
+
+    upload.row += rows;
+    if (upload.row == rowCount) {
+        upload.level++;
+        upload.row = 0;
+    }
+    return size;
+}
+
+void TextureStreamer::FinishUpload(Upload& upload) {
+    auto texture = upload.texture.lock();
+    if (!texture) {
+        glDeleteTextures(1, &upload.staging);
+        return;
+    }
+
+    if (!texture->IsResident()) {
+        residentCount++;
+    }
+    texture->AdoptStorage(upload.staging, upload.image.width, upload.image.height, upload.image.channels,
+                          Texture::GetImageFormat(upload.image, upload.type), upload.image.levels.size() > 1);
+    upload.staging = 0;
+}
+
+void TextureStreamer::Flush() {
+    TRACE_SCOPE("TextureStreamer::Flush");
+    size_t budget = uploadBudget;
+    uploadBudget = std::numeric_limits<size_t>::max();
+
+    while (true) {
+        bool busy;
+        {
+            std::lock_guard<std::mutex> jobLock(jobMutex);
+            std::lock_guard<std::mutex> resultLock(resultMutex);
+            busy = !jobs.empty() || activeDecodes > 0 || !decoded.empty() || !uploads.empty();
+        }
+        if (!busy) {
+            break;
+        }
+        Update();
+        // Lets the PBO fences signal
+        glFinish();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    uploadBudget = budget;
+}
+
+void TextureStreamer::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobCondition.notify_all();
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        decoded.clear();
+    }
+    for (Upload& upload : uploads) {
+        if (upload.staging != 0) {
+            glDeleteTextures(1, &upload.staging);
+        }
+    }
+    uploads.clear();
+
+    for (PixelBuffer& pbo : pixelBuffers) {
+        if (pbo.fence) {
+            glDeleteSync(pbo.fence);
+            pbo.fence = nullptr;
+        }
+        if (pbo.buffer != 0) {
+            glDeleteBuffers(1, &pbo.buffer);
+            pbo.buffer = 0;
+        }
+    }
+    textures.clear();
+}
+
+TextureStreamer::Stats TextureStreamer::GetStats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stats.pendingDecodes = static_cast<int>(jobs.size()) + activeDecodes;
+    }
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        stats.pendingUploads = static_cast<int>(decoded.size() + uploads.size());
+    }
+    stats.resident = residentCount;
+    stats.uploadedBytes = uploadedBytes;
+    return stats;
+}
+
+GLenum TextureStreamer::GetDataFormat(int channels) {
+    return channels == 1 ? GL_RED : channels == 2 ? GL_RG : GL_RGBA;
+}
@@ -0,0 +1,175 @@
+#include "Engine/TraceRecorder.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+std::atomic<bool> TraceRecorder::recording(false);
+
+namespace {
+    void WriteJsonString(std::ostream& out, const char* text) {
+        out << '"';
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                out << '\\';
+            }
+            out << *c;
+        }
+        out << '"';
+    }
+}
+
+TraceRecorder& TraceRecorder::Instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+TraceRecorder::TraceRecorder() : framesRequested(0), frameNumber(0), captureStartNs(0), frameBeginNs(0) {
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::GetThreadBuffer() {
+    // Gives the buffer back when the thread exits
+    struct ThreadSlot {
+        ThreadBuffer* buffer = nullptr;
+        ~ThreadSlot() {
+            if (buffer) {
+                TraceRecorder::Instance().ReleaseThreadBuffer(*buffer);
+            }
+        }
+    };
+    thread_local ThreadSlot slot;
+    if (!slot.buffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        if (!freeBuffers.empty()) {
+            slot.buffer = freeBuffers.back();
+            freeBuffers.pop_back();
+        } else {
+            std::unique_ptr<ThreadBuffer> created(new ThreadBuffer());
+            created->threadId = static_cast<int>(buffers.size()) + 1;
+            created->threadName = "Thread " + std::to_string(created->threadId);
+            created->events.reset(new Event[EVENTS_PER_THREAD]);
+            created->count.store(0);
+            created->dropped.store(0);
+            slot.buffer = created.get();
+            buffers.push_back(std::move(created));
+        }
+    }
+    return *slot.buffer;
+}
+
+void TraceRecorder::ReleaseThreadBuffer(ThreadBuffer& buffer) {
+    // Events already recorded stay on this timeline row; the next thread
+    // continues after them. The label goes back to the default so a named
+    // worker's name does not carry over to whoever picks the buffer up.
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer.threadName = "Thread " + std::to_string(buffer.threadId);
+    freeBuffers.push_back(&buffer);
+}
+
+void TraceRecorder::SetThreadName(const char* name) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer.threadName = name;
+}
+
+void TraceRecorder::AddEvent(const char* name, int64_t beginNs, int64_t endNs) {
+    if (!IsRecording()) return;
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    size_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index >= EVENTS_PER_THREAD) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[index] = { name, beginNs, endNs };
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::StartCapture(int frameCount, const std::string& path) {
+    if (IsRecording()) {
+        std::cerr << "Trace capture already in progress" << std::endl;
+        return;
+    }
+    if (frameCount <= 0) return;
+
+    {
+        // Threads only append while recording, so the buffers are idle here
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto& buffer : buffers) {
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    framesRequested = frameCount;
+    frameNumber = 0;
+    outputPath = path;
+    captureStartNs = Now();
+    frameBeginNs = captureStartNs;
+    recording.store(true, std::memory_order_release);
+    std::cout << "Capturing " << frameCount << " frames to " << outputPath << std::endl;
+}
+
+void TraceRecorder::StopCapture() {
+    if (!IsRecording()) return;
+
+    recording.store(false, std::memory_order_release);
+    if (WriteTrace()) {
+        std::cout << "Trace written to " << outputPath << std::endl;
+    }
+}
+
+void TraceRecorder::FrameBoundary() {
+    if (!IsRecording()) return;
+
+    // The capture usually starts mid-frame, so the first boundary only opens
+    // the first whole frame; each later one closes a "Frame" zone
+    int64_t now = Now();
+    if (frameNumber > 0) {
+        AddEvent("Frame", frameBeginNs, now);
+    }
+    frameBeginNs = now;
+
+    if (frameNumber++ >= framesRequested) {
+        StopCapture();
+    }
+}
+
+bool TraceRecorder::WriteTrace() {
+    std::ofstream file(outputPath);
+    if (!file) {
+        std::cerr << "Failed to open trace file: " << outputPath << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    size_t dropped = 0;
+    for (const auto& buffer : buffers) {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << buffer->threadId << ",\"args\":{\"name\":";
+        WriteJsonString(file, buffer->threadName.c_str());
+        file << "}}";
+        first = false;
+
+        for (size_t i = 0; i < count; ++i) {
+            const Event& event = buffer->events[i];
+            file << ",\n{\"name\":";
+            WriteJsonString(file, event.name);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << (event.beginNs - captureStartNs) / 1000.0
+                 << ",\"dur\":" << (event.endNs - event.beginNs) / 1000.0 << "}";
+        }
+    }
+    file << "\n]}\n";
+
+    if (dropped > 0) {
+        std::cerr << "Trace buffers were full; dropped " << dropped << " events" << std::endl;
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,182 @@
+#include "Engine/UniformRing.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+UniformRing::UniformRing()
+    : buffer(0), mapped(nullptr), persistent(false), bytesPerFrame(0), alignment(256),
+      fences{}, frame(0), head(0), overflowed(false), spilledBytes(0) {
+}
+
+UniformRing::~UniformRing() {
+    Destroy();
+}
+
+bool UniformRing::Create(GLsizeiptr size) {
+    Destroy();
+
+    GLint uboAlignment = 0;
+    GLint ssboAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssboAlignment);
+    alignment = std::max<GLsizeiptr>({ uboAlignment, ssboAlignment, 16 });
+
+    bytesPerFrame = (size + alignment - 1) / alignment * alignment;
+    GLsizeiptr totalSize = bytesPerFrame * FRAMES_IN_FLIGHT;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+    persistent = GLEW_ARB_buffer_storage != 0;
+    if (persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+        if (!mapped) {
+            std::cerr << "Failed to map uniform ring persistently" << std::endl;
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            Destroy();
+            return false;
+        }
+    } else {
+        glBufferData(GL_COPY_WRITE_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+        staging.resize(totalSize);
+        mapped = staging.data();
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    frame = 0;
+    head = 0;
+    overflowed = false;
+    spilledBytes = 0;
+    return true;
+}
+
+bool UniformRing::Reserve(GLsizeiptr size) {
+    if (buffer != 0 && size <= bytesPerFrame) {
+        return true;
+    }
+    WaitForAllFences();
+    return Create(size);
+}
+
+void UniformRing::Destroy() {
+    for (GLsync& fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (buffer != 0) {
+        if (persistent && mapped) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    mapped = nullptr;
+    staging.clear();
+    for (int region = 0; region < FRAMES_IN_FLIGHT; ++region) {
+        ReleaseSpills(region);
+    }
+}
+
+void UniformRing::WaitForFence(int region) {
+    GLsync& fence = fences[region];
+    if (!fence) {
+        return;
+    }
+
+    // Normally already signalled; flush on the first wait so it can signal
+    GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+        GLenum result = glClientWaitSync(fence, waitFlags, 1000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) {
+            break;
+        }
+        waitFlags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void UniformRing::WaitForAllFences() {
+    for (int region = 0; region < FRAMES_IN_FLIGHT; ++region) {
+        WaitForFence(region);
+    }
+}
+
+void UniformRing::ReleaseSpills(int region) {
+    for (const Spill& spill : spills[region]) {
+        glDeleteBuffers(1, &spill.buffer);
+    }
+    spills[region].clear();
+}
+
+void UniformRing::BeginFrame() {
+    if (buffer == 0) {
+        return;
+    }
+
+    if (overflowed) {
+        // Every region may still be in use, so wait for all of them. Grow to
+        // hold everything last frame spilled, with room to spare.
+        WaitForAllFences();
+        Create(std::max(bytesPerFrame * 2, (head + spilledBytes) * 3 / 2));
+    }
+
+    frame = (frame + 1) % FRAMES_IN_FLIGHT;
+    WaitForFence(frame);
+    ReleaseSpills(frame);
+    head = 0;
+    spilledBytes = 0;
+}
+
+void UniformRing::EndFrame() {
+    if (buffer == 0) {
+        return;
+    }
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+UniformRing::Allocation UniformRing::Allocate(GLsizeiptr size) {
+    Allocation allocation;
+    GLsizeiptr start = (head + alignment - 1) / alignment * alignment;
+    if (mapped && start + size <= bytesPerFrame) {
+        head = start + size;
+        allocation.buffer = buffer;
+        allocation.offset = static_cast<GLintptr>(frame * bytesPerFrame + start);
+        allocation.data = mapped + allocation.offset;
+        return allocation;
+    }
+
+    // Out of room: this allocation gets a buffer of its own, uploaded by Commit
+    overflowed = true;
+    spilledBytes += (size + alignment - 1) / alignment * alignment;
+    Spill spill;
+    glGenBuffers(1, &spill.buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, spill.buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, std::max<GLsizeiptr>(size, 1), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    spill.data.resize(std::max<GLsizeiptr>(size, 1));
+    spills[frame].push_back(std::move(spill));
+
+    allocation.buffer = spills[frame].back().buffer;
+    allocation.data = spills[frame].back().data.data();
+    return allocation;
+}
+
+void UniformRing::Commit(const Allocation& allocation, GLsizeiptr size) {
+    if (size <= 0 || !allocation.data) {
+        return;
+    }
+    bool spilled = allocation.buffer != buffer;
+    if (persistent && !spilled) {
+        return;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, allocation.buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset, size, allocation.data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
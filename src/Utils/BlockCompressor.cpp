@@ -0,0 +1,435 @@
+#include "Utils/BlockCompressor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace {
+    // BC7 4-bit index interpolation weights, out of 64
+    const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Mean and dominant direction of the first dims channels
+    void PrincipalAxis(const float texels[16][4], int dims, float mean[4], float axis[4]) {
+        float minValue[4], maxValue[4];
+        for (int c = 0; c < 4; ++c) {
+            mean[c] = 0.0f;
+            minValue[c] = std::numeric_limits<float>::max();
+            maxValue[c] = std::numeric_limits<float>::lowest();
+        }
+        for (int i = 0; i < 16; ++i) {
+            for (int c = 0; c < dims; ++c) {
+                mean[c] += texels[i][c] / 16.0f;
+                minValue[c] = std::min(minValue[c], texels[i][c]);
+                maxValue[c] = std::max(maxValue[c], texels[i][c]);
+            }
+        }
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; ++i) {
+            for (int a = 0; a < dims; ++a) {
+                for (int b = 0; b < dims; ++b) {
+                    covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+                }
+            }
+        }
+
+        // Power iteration from the bounding box diagonal
+        for (int c = 0; c < 4; ++c) {
+            axis[c] = c < dims ? maxValue[c] - minValue[c] : 0.0f;
+        }
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            float next[4] = {};
+            float length = 0.0f;
+            for (int a = 0; a < dims; ++a) {
+                for (int b = 0; b < dims; ++b) {
+                    next[a] += covariance[a][b] * axis[b];
+                }
+                length += next[a] * next[a];
+            }
+            if (length < 1e-12f) {
+                break;
+            }
+            length = std::sqrt(length);
+            for (int c = 0; c < dims; ++c) {
+                axis[c] = next[c] / length;
+            }
+        }
+    }
+
+    // Endpoints at the extreme projections onto the axis
+    void FitEndpoints(const float texels[16][4], int dims, float e0[4], float e1[4]) {
+        float mean[4], axis[4];
+        PrincipalAxis(texels, dims, mean, axis);
+        float minProjection = std::numeric_limits<float>::max();
+        float maxProjection = std::numeric_limits<float>::lowest();
+        for (int i = 0; i < 16; ++i) {
+            float projection = 0.0f;
+            for (int c = 0; c < dims; ++c) {
+                projection += (texels[i][c] - mean[c]) * axis[c];
+            }
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+        for (int c = 0; c < dims; ++c) {
+            e0[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+            e1[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+        }
+    }
+
+    // Least-squares endpoints for fixed weights (weight of e1 per texel);
+    // false when the weights leave the system singular
+    bool RefineEndpoints(const float texels[16][4], int dims, const float weights[16], float e0[4], float e1[4]) {
+        float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+        float ax[4] = {}, bx[4] = {};
+        for (int i = 0; i < 16; ++i) {
+            float a = 1.0f - weights[i];
+            float b = weights[i];
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            for (int c = 0; c < dims; ++c) {
+                ax[c] += a * texels[i][c];
+                bx[c] += b * texels[i][c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f) {
+            return false;
+        }
+        for (int c = 0; c < dims; ++c) {
+            e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+            e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    uint16_t Pack565(const float color[4]) {
+        int r = static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f);
+        int g = static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f);
+        int b = static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>(r << 11 | g << 5 | b);
+    }
+
+    void Unpack565(uint16_t packed, float color[3]) {
+        int r = packed >> 11 & 31;
+        int g = packed >> 5 & 63;
+        int b = packed & 31;
+        color[0] = static_cast<float>(r << 3 | r >> 2);
+        color[1] = static_cast<float>(g << 2 | g >> 4);
+        color[2] = static_cast<float>(b << 3 | b >> 2);
+    }
+
+    // Four-colour BC1 palette indices for two endpoints; returns the error
+    float FitBC1(const float texels[16][4], uint16_t& c0, uint16_t& c1, uint32_t& indices) {
+        if (c0 < c1) {
+            std::swap(c0, c1);
+        }
+        float palette[4][3];
+        Unpack565(c0, palette[0]);
+        Unpack565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+        // Equal endpoints select three-colour mode, where only index 0 is safe
+        int paletteSize = c0 == c1 ? 1 : 4;
+
+        indices = 0;
+        float error = 0.0f;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            float bestError = std::numeric_limits<float>::max();
+            for (int p = 0; p < paletteSize; ++p) {
+                float e = 0.0f;
+                for (int c = 0; c < 3; ++c) {
+                    float d = texels[i][c] - palette[p][c];
+                    e += d * d;
+                }
+                if (e < bestError) {
+                    bestError = e;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+            error += bestError;
+        }
+        return error;
+    }
+
+    struct BC7Endpoints {
+        int q0[4];   // 7-bit
+        int q1[4];
+        int p0;
+        int p1;
+        int indices[16];
+    };
+
+    // Mode 6 indices for endpoints quantized with the given p-bits
+    float FitBC7(const float texels[16][4], const float e0[4], const float e1[4], int p0, int p1, BC7Endpoints& result) {
+        float palette[16][4];
+        for (int c = 0; c < 4; ++c) {
+            result.q0[c] = std::clamp(static_cast<int>(std::lround((e0[c] - p0) / 2.0f)), 0, 127);
+            result.q1[c] = std::clamp(static_cast<int>(std::lround((e1[c] - p1) / 2.0f)), 0, 127);
+            int v0 = result.q0[c] << 1 | p0;
+            int v1 = result.q1[c] << 1 | p1;
+            for (int k = 0; k < 16; ++k) {
+                palette[k][c] = static_cast<float>(((64 - BC7_WEIGHTS[k]) * v0 + BC7_WEIGHTS[k] * v1 + 32) >> 6);
+            }
+        }
+        result.p0 = p0;
+        result.p1 = p1;
+
+        float error = 0.0f;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            float bestError = std::numeric_limits<float>::max();
+            for (int k = 0; k < 16; ++k) {
+                float e = 0.0f;
+                for (int c = 0; c < 4; ++c) {
+                    float d = texels[i][c] - palette[k][c];
+                    e += d * d;
+                }
+                if (e < bestError) {
+                    bestError = e;
+                    best = k;
+                }
+            }
+            result.indices[i] = best;
+            error += bestError;
+        }
+        return error;
+    }
+
+    float FitBC7BestPBits(const float texels[16][4], const float e0[4], const float e1[4], BC7Endpoints& result) {
+        float bestError = std::numeric_limits<float>::max();
+        for (int pbits = 0; pbits < 4; ++pbits) {
+            BC7Endpoints candidate;
+            float error = FitBC7(texels, e0, e1, pbits & 1, pbits >> 1, candidate);
+            if (error < bestError) {
+                bestError = error;
+                result = candidate;
+            }
+        }
+        return bestError;
+    }
+
+    class BitWriter {
+    public:
+        explicit BitWriter(unsigned char* output) : output(output), position(0) {
+            std::memset(output, 0, 16);
+        }
+        void Write(uint32_t value, int bits) {
+            for (int i = 0; i < bits; ++i, ++position) {
+                output[position / 8] |= static_cast<unsigned char>((value >> i & 1) << (position % 8));
+            }
+        }
+    private:
+        unsigned char* output;
+        int position;
+    };
+}
+
+bool BlockCompressor::Compress(const Image& source, BlockFormat format, Image& result, std::string& error) {
+    if (source.IsCompressed() || source.levels.empty()) {
+        error = "source image must be uncompressed";
+        return false;
+    }
+    if (format == BlockFormat::NONE) {
+        error = "no block format given";
+        return false;
+    }
+
+    result = Image();
+    result.width = source.width;
+    result.height = source.height;
+    result.blockFormat = format;
+    result.channels = format == BlockFormat::BC4 ? 1 : format == BlockFormat::BC5 ? 2 : 4;
+    // Only the colour formats have sRGB variants
+    result.srgb = source.srgb && result.channels == 4;
+    size_t total = 0;
+    for (size_t level = 0; level < source.levels.size(); ++level) {
+        const Image::Level& sourceLevel = source.levels[level];
+        result.levels.push_back({ sourceLevel.width, sourceLevel.height, total, 0 });
+        result.levels.back().size = result.GetRowBytes(static_cast<int>(level)) * result.GetRowCount(static_cast<int>(level));
+        total += result.levels.back().size;
+    }
+    result.pixels.resize(total);
+
+    // Block rows are independent, so they are split across threads
+    const int blockBytes = Image::GetBlockBytes(format);
+    for (size_t level = 0; level < result.levels.size(); ++level) {
+        const Image::Level& target = result.levels[level];
+        int blocksWide = (target.width + 3) / 4;
+        int blocksHigh = (target.height + 3) / 4;
+        int threadCount = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, blocksHigh);
+
+        auto encodeRows = [&, level](int firstRow, int rowStep) {
+            Block block;
+            for (int by = firstRow; by < blocksHigh; by += rowStep) {
+                for (int bx = 0; bx < blocksWide; ++bx) {
+                    GatherBlock(source, static_cast<int>(level), bx, by, block);
+                    unsigned char* output = result.pixels.data() + target.offset +
+                                            (static_cast<size_t>(by) * blocksWide + bx) * blockBytes;
+                    switch (format) {
+                        case BlockFormat::BC1: EncodeBC1(block, output); break;
+                        case BlockFormat::BC3: EncodeBC4(block, 3, output); EncodeBC1(block, output + 8); break;
+                        case BlockFormat::BC4: EncodeBC4(block, 0, output); break;
+                        case BlockFormat::BC5: EncodeBC4(block, 0, output); EncodeBC4(block, 1, output + 8); break;
+                        case BlockFormat::BC7: EncodeBC7(block, output); break;
+                        default: break;
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; ++t) {
+            threads.emplace_back(encodeRows, t, threadCount);
+        }
+        encodeRows(0, threadCount);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    return true;
+}
+
+void BlockCompressor::GatherBlock(const Image& image, int level, int blockX, int blockY, Block& block) {
+    const Image::Level& source = image.levels[level];
+    const unsigned char* pixels = image.pixels.data() + source.offset;
+    for (int y = 0; y < 4; ++y) {
+        int sy = std::min(blockY * 4 + y, source.height - 1);
+        for (int x = 0; x < 4; ++x) {
+            int sx = std::min(blockX * 4 + x, source.width - 1);
+            const unsigned char* texel = pixels + (static_cast<size_t>(sy) * source.width + sx) * image.channels;
+            float* out = block.texels[y * 4 + x];
+            if (image.channels == 1) {
+                out[0] = out[1] = out[2] = texel[0];
+                out[3] = 255.0f;
+            } else if (image.channels == 2) {
+                out[0] = texel[0];
+                out[1] = texel[1];
+                out[2] = 0.0f;
+                out[3] = 255.0f;
+            } else {
+                for (int c = 0; c < 4; ++c) {
+                    out[c] = texel[c];
+                }
+            }
+        }
+    }
+}
+
+void BlockCompressor::EncodeBC1(const Block& block, unsigned char* output) {
+    float e0[4], e1[4];
+    FitEndpoints(block.texels, 3, e0, e1);
+    uint16_t c0 = Pack565(e0);
+    uint16_t c1 = Pack565(e1);
+    uint32_t indices;
+    float error = FitBC1(block.texels, c0, c1, indices);
+
+    // One least-squares pass on the chosen indices
+    static const float INDEX_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    float weights[16];
+    for (int i = 0; i < 16; ++i) {
+        weights[i] = INDEX_WEIGHTS[indices >> (2 * i) & 3];
+    }
+    if (RefineEndpoints(block.texels, 3, weights, e0, e1)) {
+        uint16_t r0 = Pack565(e0);
+        uint16_t r1 = Pack565(e1);
+        uint32_t refinedIndices;
+        if (FitBC1(block.texels, r0, r1, refinedIndices) < error) {
+            c0 = r0;
+            c1 = r1;
+            indices = refinedIndices;
+        }
+    }
+
+    output[0] = static_cast<unsigned char>(c0);
+    output[1] = static_cast<unsigned char>(c0 >> 8);
+    output[2] = static_cast<unsigned char>(c1);
+    output[3] = static_cast<unsigned char>(c1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        output[4 + i] = static_cast<unsigned char>(indices >> (8 * i));
+    }
+}
+
+void BlockCompressor::EncodeBC4(const Block& block, int channel, unsigned char* output) {
+    float minValue = 255.0f;
+    float maxValue = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        minValue = std::min(minValue, block.texels[i][channel]);
+        maxValue = std::max(maxValue, block.texels[i][channel]);
+    }
+    int a0 = static_cast<int>(maxValue + 0.5f);
+    int a1 = static_cast<int>(minValue + 0.5f);
+    output[0] = static_cast<unsigned char>(a0);
+    output[1] = static_cast<unsigned char>(a1);
+
+    // Eight-value mode (a0 > a1): index 0 and 1 are the endpoints, 2-7 lie between
+    float palette[8] = { static_cast<float>(a0), static_cast<float>(a1) };
+    for (int k = 2; k < 8; ++k) {
+        palette[k] = static_cast<float>(((8 - k) * a0 + (k - 1) * a1) / 7);
+    }
+    int paletteSize = a0 == a1 ? 1 : 8;
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 16; ++i) {
+        int best = 0;
+        float bestError = std::numeric_limits<float>::max();
+        for (int k = 0; k < paletteSize; ++k) {
+            float e = std::fabs(block.texels[i][channel] - palette[k]);
+            if (e < bestError) {
+                bestError = e;
+                best = k;
+            }
+        }
+        indices |= static_cast<uint64_t>(best) << (3 * i);
+    }
+    for (int i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<unsigned char>(indices >> (8 * i));
+    }
+}
+
+void BlockCompressor::EncodeBC7(const Block& block, unsigned char* output) {
+    float e0[4], e1[4];
+    FitEndpoints(block.texels, 4, e0, e1);
+    BC7Endpoints best;
+    float error = FitBC7BestPBits(block.texels, e0, e1, best);
+
+    float weights[16];
+    for (int i = 0; i < 16; ++i) {
+        weights[i] = BC7_WEIGHTS[best.indices[i]] / 64.0f;
+    }
+    if (RefineEndpoints(block.texels, 4, weights, e0, e1)) {
+        BC7Endpoints refined;
+        if (FitBC7BestPBits(block.texels, e0, e1, refined) < error) {
+            best = refined;
+        }
+    }
+
+    // The anchor (texel 0) index has an implicit zero top bit
+    if (best.indices[0] >= 8) {
+        std::swap(best.q0, best.q1);
+        std::swap(best.p0, best.p1);
+        for (int& index : best.indices) {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer(output);
+    writer.Write(1 << 6, 7);   // Mode 6
+    for (int c = 0; c < 4; ++c) {
+        writer.Write(static_cast<uint32_t>(best.q0[c]), 7);
+        writer.Write(static_cast<uint32_t>(best.q1[c]), 7);
+    }
+    writer.Write(static_cast<uint32_t>(best.p0), 1);
+    writer.Write(static_cast<uint32_t>(best.p1), 1);
+    writer.Write(static_cast<uint32_t>(best.indices[0]), 3);
+    for (int i = 1; i < 16; ++i) {
+        writer.Write(static_cast<uint32_t>(best.indices[i]), 4);
+    }
+}
@@ -0,0 +1,314 @@
+#include "Utils/FileUtils.h"
+#include "Utils/FileWatcher.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+std::string FileUtils::assetDirectory = "assets";
+std::string FileUtils::shaderDirectory = "shaders";
+std::string FileUtils::textureDirectory = "assets/textures";
+std::string FileUtils::modelDirectory = "assets/models";
+std::string FileUtils::lastError;
+
+std::vector<FileUtils::FileWatch> FileUtils::fileWatches;
+std::unique_ptr<FileWatcher> FileUtils::fileWatcher;
+int FileUtils::nextWatchId = 1;
+
+// File reading
+
+std::string FileUtils::ReadTextFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        lastError = "Failed to open file: " + filePath;
+        return "";
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+std::vector<unsigned char> FileUtils::ReadBinaryFile(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        lastError = "Failed to open file: " + filePath;
+        return {};
+    }
+
+    std::vector<unsigned char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    return data;
+}
+
+bool FileUtils::FileExists(const std::string& filePath) {
+    std::error_code error;
+    return fs::is_regular_file(filePath, error);
+}
+
+size_t FileUtils::GetFileSize(const std::string& filePath) {
+    std::error_code error;
+    uintmax_t size = fs::file_size(filePath, error);
+    return error ? 0 : static_cast<size_t>(size);
+}
+
+// File writing
+
+bool FileUtils::WriteTextFile(const std::string& filePath, const std::string& content) {
+    std::ofstream file(filePath);
+    if (!file.is_open()) {
+        lastError = "Failed to write file: " + filePath;
+        return false;
+    }
+    file << content;
+    return static_cast<bool>(file);
+}
+
+bool FileUtils::WriteBinaryFile(const std::string& filePath, const std::vector<unsigned char>& data) {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        lastError = "Failed to write file: " + filePath;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return static_cast<bool>(file);
+}
+
+bool FileUtils::WriteFileAtomic(const std::string& filePath, const std::function<bool(std::ostream&)>& write) {
+    std::error_code error;
+    fs::path path(filePath);
+    if (path.has_parent_path()) {
+        fs::create_directories(path.parent_path(), error);
+    }
+
+    // Unique per process, thread and call: several viewers may share a cache
+    // directory and workers may write the same entry, and each writer must
+    // own its temporary until the rename
+    static std::atomic<unsigned> tempCounter(0);
+    std::ostringstream tempName;
+    tempName << filePath << '.' << getpid() << '.'
+             << std::hash<std::thread::id>()(std::this_thread::get_id()) << '.'
+             << tempCounter.fetch_add(1, std::memory_order_relaxed) << ".tmp";
+    std::string tempPath = tempName.str();
+    std::ofstream file(tempPath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    bool written = write(file) && file.good();
+    file.close();
+    if (written && !file.fail()) {
+        fs::rename(tempPath, filePath, error);
+        if (!error) {
+            return true;
+        }
+    }
+    fs::remove(tempPath, error);
+    return false;
+}
+
+bool FileUtils::CreateDirectory(const std::string& path) {
+    std::error_code error;
+    fs::create_directories(path, error);
+    if (error) {
+        lastError = "Failed to create directory: " + path;
+        return false;
+    }
+    return true;
+}
+
+// Path utilities
+
+std::string FileUtils::GetDirectory(const std::string& filePath) {
+    return fs::path(filePath).parent_path().string();
+}
+
+std::string FileUtils::GetFileName(const std::string& filePath) {
+    return fs::path(filePath).filename().string();
+}
+
+std::string FileUtils::GetFileExtension(const std::string& filePath) {
+    return fs::path(filePath).extension().string();
+}
+
+std::string FileUtils::GetFileNameWithoutExtension(const std::string& filePath) {
+    return fs::path(filePath).stem().string();
+}
+
+std::string FileUtils::CombinePath(const std::string& path1, const std::string& path2) {
+    return (fs::path(path1) / path2).string();
+}
+
+std::string FileUtils::GetAbsolutePath(const std::string& relativePath) {
+    return NormalizePath(relativePath);
+}
+
+std::string FileUtils::GetRelativePath(const std::string& absolutePath, const std::string& basePath) {
+    return fs::path(absolutePath).lexically_relative(basePath).string();
+}
+
+// Directory operations
+
+std::vector<std::string> FileUtils::GetFilesInDirectory(const std::string& directory, const std::string& extension) {
+    std::vector<std::string> files;
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(directory, error)) {
+        if (entry.is_regular_file() && (extension.empty() || entry.path().extension() == extension)) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::vector<std::string> FileUtils::GetSubdirectories(const std::string& directory) {
+    std::vector<std::string> directories;
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(directory, error)) {
+        if (entry.is_directory()) {
+            directories.push_back(entry.path().string());
+        }
+    }
+    std::sort(directories.begin(), directories.end());
+    return directories;
+}
+
+bool FileUtils::IsDirectory(const std::string& path) {
+    std::error_code error;
+    return fs::is_directory(path, error);
+}
+
+bool FileUtils::DeleteFile(const std::string& filePath) {
+    std::error_code error;
+    return fs::remove(filePath, error);
+}
+
+bool FileUtils::DeleteDirectory(const std::string& directory) {
+    std::error_code error;
+    return fs::remove_all(directory, error) > 0;
+}
+
+// Asset management
+
+std::string FileUtils::GetAssetPath(const std::string& assetName) {
+    return CombinePath(assetDirectory, assetName);
+}
+
+std::string FileUtils::GetShaderPath(const std::string& shaderName) {
+    return CombinePath(shaderDirectory, shaderName);
+}
+
+std::string FileUtils::GetTexturePath(const std::string& textureName) {
+    return CombinePath(textureDirectory, textureName);
+}
+
+std::string FileUtils::GetModelPath(const std::string& modelName) {
+    return CombinePath(modelDirectory, modelName);
+}
+
+// File watching
+
+int FileUtils::WatchFile(const std::string& filePath, std::function<void()> callback) {
+    if (!fileWatcher) {
+        fileWatcher = std::make_unique<FileWatcher>();
+        fileWatcher->Start();
+    }
+
+    std::string path = NormalizePath(filePath);
+    fileWatcher->Watch(path);
+
+    int id = nextWatchId++;
+    fileWatches.push_back({ id, path, std::move(callback) });
+    return id;
+}
+
+void FileUtils::UnwatchFile(const std::string& filePath) {
+    std::string path = NormalizePath(filePath);
+    fileWatches.erase(std::remove_if(fileWatches.begin(), fileWatches.end(),
+                                     [&](const FileWatch& watch) { return watch.filePath == path; }),
+                      fileWatches.end());
+    if (fileWatcher) {
+        fileWatcher->Unwatch(path);
+    }
+}
+
+void FileUtils::UnwatchFile(int watchId) {
+    auto it = std::find_if(fileWatches.begin(), fileWatches.end(),
+                           [&](const FileWatch& watch) { return watch.id == watchId; });
+    if (it == fileWatches.end()) {
+        return;
+    }
+
+    std::string path = it->filePath;
+    fileWatches.erase(it);
+    bool stillWatched = std::any_of(fileWatches.begin(), fileWatches.end(),
+                                    [&](const FileWatch& watch) { return watch.filePath == path; });
+    if (!stillWatched && fileWatcher) {
+        fileWatcher->Unwatch(path);
+    }
+}
+
+void FileUtils::UpdateFileWatchers() {
+    static std::vector<std::string> changed;
+    if (!fileWatcher || !fileWatcher->Poll(changed)) {
+        return;
+    }
+
+    // Collected first: a callback may add or remove watches
+    std::vector<std::function<void()>> callbacks;
+    for (const FileWatch& watch : fileWatches) {
+        if (std::binary_search(changed.begin(), changed.end(), watch.filePath)) {
+            callbacks.push_back(watch.callback);
+        }
+    }
+    for (const auto& callback : callbacks) {
+        callback();
+    }
+}
+
+void FileUtils::StopFileWatchers() {
+    fileWatches.clear();
+    fileWatcher.reset();
+}
+
+// Configuration
+
+void FileUtils::SetAssetDirectory(const std::string& directory) {
+    assetDirectory = directory;
+}
+
+void FileUtils::SetShaderDirectory(const std::string& directory) {
+    shaderDirectory = directory;
+}
+
+void FileUtils::SetTextureDirectory(const std::string& directory) {
+    textureDirectory = directory;
+}
+
+void FileUtils::SetModelDirectory(const std::string& directory) {
+    modelDirectory = directory;
+}
+
+// Error handling
+
+std::string FileUtils::GetLastError() {
+    return lastError;
+}
+
+void FileUtils::ClearLastError() {
+    lastError.clear();
+}
+
+std::string FileUtils::NormalizePath(const std::string& path) {
+    return FileWatcher::NormalizePath(path);
+}
@@ -0,0 +1,235 @@
+#include "Utils/FileWatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // How often the fallback thread checks modification times
+    const auto POLL_INTERVAL = std::chrono::milliseconds(250);
+
+#ifdef __linux__
+    // Editors either rewrite in place (close after write) or rename a temp
+    // file over the original (moved to)
+    const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO;
+#endif
+}
+
+FileWatcher::FileWatcher()
+    : queueHead(0), queueTail(0), queueOverflowed(false), running(false), native(false)
+#ifdef __linux__
+    , inotifyFd(-1), wakeFd(-1)
+#endif
+{
+}
+
+FileWatcher::~FileWatcher() {
+    Stop();
+}
+
+std::string FileWatcher::NormalizePath(const std::string& filePath) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(filePath, error);
+    if (error) {
+        return filePath;
+    }
+    return absolute.lexically_normal().string();
+}
+
+bool FileWatcher::Start() {
+    if (running) {
+        return true;
+    }
+
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    native = inotifyFd >= 0 && wakeFd >= 0;
+    if (!native) {
+        std::cerr << "inotify unavailable, polling for file changes instead" << std::endl;
+        if (inotifyFd >= 0) close(inotifyFd);
+        if (wakeFd >= 0) close(wakeFd);
+        inotifyFd = -1;
+        wakeFd = -1;
+    } else {
+        // Watches added before Start
+        std::lock_guard<std::mutex> lock(watchMutex);
+        for (const std::string& file : files) {
+            std::string directory = std::filesystem::path(file).parent_path().string();
+            if (watchedDirectories.insert(directory).second) {
+                int wd = inotify_add_watch(inotifyFd, directory.c_str(), WATCH_MASK);
+                if (wd >= 0) {
+                    directories[wd] = directory;
+                }
+            }
+        }
+    }
+#endif
+
+    running = true;
+#ifdef __linux__
+    if (native) {
+        thread = std::thread(&FileWatcher::RunInotify, this);
+        return true;
+    }
+#endif
+    thread = std::thread(&FileWatcher::RunPolling, this);
+    return true;
+}
+
+void FileWatcher::Stop() {
+    if (!running) {
+        return;
+    }
+
+    running = false;
+#ifdef __linux__
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+#endif
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+#ifdef __linux__
+    if (inotifyFd >= 0) close(inotifyFd);
+    if (wakeFd >= 0) close(wakeFd);
+    inotifyFd = -1;
+    wakeFd = -1;
+    directories.clear();
+    watchedDirectories.clear();
+#endif
+}
+
+void FileWatcher::Watch(const std::string& filePath) {
+    std::string path = NormalizePath(filePath);
+    std::lock_guard<std::mutex> lock(watchMutex);
+    if (!files.insert(path).second) {
+        return;
+    }
+
+    std::error_code error;
+    modifiedTimes[path] = std::filesystem::last_write_time(path, error);
+
+#ifdef __linux__
+    if (native && inotifyFd >= 0) {
+        std::string directory = std::filesystem::path(path).parent_path().string();
+        if (watchedDirectories.insert(directory).second) {
+            int wd = inotify_add_watch(inotifyFd, directory.c_str(), WATCH_MASK);
+            if (wd < 0) {
+                std::cerr << "Failed to watch directory: " << directory << std::endl;
+                watchedDirectories.erase(directory);
+                return;
+            }
+            directories[wd] = directory;
+        }
+    }
+#endif
+}
+
+void FileWatcher::Unwatch(const std::string& filePath) {
+    // The directory watch stays; events for unwatched files are dropped
+    std::string path = NormalizePath(filePath);
+    std::lock_guard<std::mutex> lock(watchMutex);
+    files.erase(path);
+    modifiedTimes.erase(path);
+}
+
+void FileWatcher::Push(const std::string& path) {
+    size_t tail = queueTail.load(std::memory_order_relaxed);
+    if (tail - queueHead.load(std::memory_order_acquire) >= QUEUE_CAPACITY) {
+        queueOverflowed.store(true, std::memory_order_release);
+        return;
+    }
+    queue[tail & (QUEUE_CAPACITY - 1)] = path;
+    queueTail.store(tail + 1, std::memory_order_release);
+}
+
+bool FileWatcher::Poll(std::vector<std::string>& changed) {
+    changed.clear();
+
+    size_t head = queueHead.load(std::memory_order_relaxed);
+    size_t tail = queueTail.load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+        changed.push_back(std::move(queue[head & (QUEUE_CAPACITY - 1)]));
+    }
+    queueHead.store(head, std::memory_order_release);
+
+    if (queueOverflowed.exchange(false, std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        changed.assign(files.begin(), files.end());
+    }
+
+    // A single save can produce several events
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return !changed.empty();
+}
+
+#ifdef __linux__
+void FileWatcher::RunInotify() {
+    alignas(inotify_event) char buffer[4096];
+    pollfd fds[2] = { { inotifyFd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+
+    while (running) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            std::lock_guard<std::mutex> lock(watchMutex);
+            for (char* ptr = buffer; ptr < buffer + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    queueOverflowed.store(true, std::memory_order_release);
+                    continue;
+                }
+                auto directory = directories.find(event->wd);
+                if (event->len == 0 || directory == directories.end()) {
+                    continue;
+                }
+
+                std::string path = directory->second + "/" + event->name;
+                if (files.count(path) > 0) {
+                    Push(path);
+                }
+            }
+        }
+    }
+}
+#endif
+
+void FileWatcher::RunPolling() {
+    while (running) {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+
+        std::lock_guard<std::mutex> lock(watchMutex);
+        for (auto& entry : modifiedTimes) {
+            std::error_code error;
+            auto modified = std::filesystem::last_write_time(entry.first, error);
+            if (!error && modified != entry.second) {
+                entry.second = modified;
+                Push(entry.first);
+            }
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#include "Utils/HeightField.h"
+#include "Utils/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+    // Rows per thread below which splitting costs more than it saves
+    const int MIN_ROWS_PER_BAND = 32;
+
+    // Integer hash of a sample position to [0, 1). Only multiplies, xors and
+    // shifts, so the row loops below vectorise.
+    inline float HashNoise(uint32_t x, uint32_t z, uint32_t seed) {
+        uint32_t h = (x * 0x8da6b343u) ^ (z * 0xd8163841u) ^ (seed * 0xcb1ab31fu);
+        h ^= h >> 15;
+        h *= 0x2c1b3c6du;
+        h ^= h >> 12;
+        h *= 0x297a2d39u;
+        h ^= h >> 15;
+        return static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+    }
+}
+
+HeightField::HeightField() : width(0), height(0), view(nullptr) {
+}
+
+HeightField::HeightField(int width, int height) : width(0), height(0), view(nullptr) {
+    Resize(width, height);
+}
+
+void HeightField::Resize(int newWidth, int newHeight) {
+    view = nullptr;
+    storage.reset();
+    width = std::max(newWidth, 0);
+    height = std::max(newHeight, 0);
+    samples.assign(static_cast<size_t>(width) * height, 0.0f);
+}
+
+void HeightField::SetView(int newWidth, int newHeight, const float* data, std::shared_ptr<const void> owner) {
+    samples.clear();
+    samples.shrink_to_fit();
+    width = std::max(newWidth, 0);
+    height = std::max(newHeight, 0);
+    view = data;
+    storage = std::move(owner);
+}
+
+void HeightField::Detach() {
+    if (!view) {
+        return;
+    }
+    samples.assign(view, view + static_cast<size_t>(width) * height);
+    view = nullptr;
+    storage.reset();
+}
+
+void HeightField::Generate(Shape shape, uint32_t seed) {
+    if (IsEmpty()) {
+        return;
+    }
+    Detach();
+
+    // Hills are separable: sin(x) terms are tabulated once per column and
+    // cos(z) terms once per row, leaving multiply-adds in the inner loop
+    std::vector<float> ridgeLarge, ridgeMedium;
+    if (shape == Shape::HILLS) {
+        ridgeLarge.resize(width);
+        ridgeMedium.resize(width);
+        for (int x = 0; x < width; ++x) {
+            ridgeLarge[x] = std::sin(x * 0.1f);
+            ridgeMedium[x] = std::sin(x * 0.3f);
+        }
+    }
+
+    const float centerX = width / 2.0f;
+    const float centerZ = height / 2.0f;
+    const float extent = static_cast<float>(std::min(width, height));
+
+    ParallelFor(height, MIN_ROWS_PER_BAND, [&](int begin, int end) {
+        for (int z = begin; z < end; ++z) {
+            float* row = GetRow(z);
+            const uint32_t uz = static_cast<uint32_t>(z);
+            const float dz2 = (z - centerZ) * (z - centerZ);
+
+            switch (shape) {
+                case Shape::FLAT:
+                    std::fill(row, row + width, 0.0f);
+                    break;
+
+                case Shape::HILLS: {
+                    const float* large = ridgeLarge.data();
+                    const float* medium = ridgeMedium.data();
+                    const float largeScale = std::cos(z * 0.1f) * 0.5f;
+                    const float mediumScale = std::cos(z * 0.3f) * 0.3f;
+                    for (int x = 0; x < width; ++x) {
+                        float h = large[x] * largeScale + medium[x] * mediumScale +
+                                  HashNoise(static_cast<uint32_t>(x), uz, seed) * 0.2f;
+                        row[x] = std::max(0.0f, h);
+                    }
+                    break;
+                }
+
+                case Shape::PEAK: {
+                    // Squared falloff from the centre out to a third of the extent
+                    const float inverseRadius = 3.0f / extent;
+                    for (int x = 0; x < width; ++x) {
+                        float distance = std::sqrt((x - centerX) * (x - centerX) + dz2);
+                        float peak = std::max(0.0f, 1.0f - distance * inverseRadius);
+                        row[x] = peak * peak + HashNoise(static_cast<uint32_t>(x), uz, seed) * 0.1f;
+                    }
+                    break;
+                }
+
+                case Shape::VALLEY: {
+                    // Squared basin out to a quarter of the extent, raised edges beyond
+                    const float inverseRadius = 4.0f / extent;
+                    for (int x = 0; x < width; ++x) {
+                        float t = std::sqrt((x - centerX) * (x - centerX) + dz2) * inverseRadius;
+                        float base = t < 1.0f ? 1.0f - t * t : 0.5f;
+                        row[x] = base + HashNoise(static_cast<uint32_t>(x), uz, seed) * 0.05f;
+                    }
+                    break;
+                }
+            }
+        }
+    });
+}
+
+void HeightField::Smooth() {
+    if (width < 3 || height < 3) {
+        return;
+    }
+    Detach();
+
+    // Horizontal 3-tap sums into a scratch grid, then vertical sums back.
+    // The vertical pass only reads the scratch grid, so bands never race.
+    std::vector<float> rowSums(samples.size());
+    ParallelFor(height, MIN_ROWS_PER_BAND, [&](int begin, int end) {
+        for (int z = begin; z < end; ++z) {
+            const float* source = GetRow(z);
+            float* sums = rowSums.data() + static_cast<size_t>(z) * width;
+            for (int x = 1; x < width - 1; ++x) {
+                sums[x] = source[x - 1] + source[x] + source[x + 1];
+            }
+        }
+    });
+
+    const float inverseCount = 1.0f / 9.0f;
+    ParallelFor(height - 2, MIN_ROWS_PER_BAND, [&](int begin, int end) {
+        for (int z = begin + 1; z < end + 1; ++z) {
+            const float* above = rowSums.data() + static_cast<size_t>(z - 1) * width;
+            const float* center = above + width;
+            const float* below = center + width;
+            float* row = GetRow(z);
+            for (int x = 1; x < width - 1; ++x) {
+                row[x] = (above[x] + center[x] + below[x]) * inverseCount;
+            }
+        }
+    });
+}
@@ -0,0 +1,238 @@
+#include "Utils/HeightFieldFile.h"
+#include "Utils/FileUtils.h"
+#include "Utils/MappedFile.h"
+#include "Utils/ParallelFor.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+
+namespace {
+    const char MAGIC[4] = { 'H', 'F', 'L', 'D' };
+    const uint32_t FLAG_NORMALS = 1;
+    const uint64_t SECTION_ALIGNMENT = 64;
+    const int MIN_ROWS_PER_BAND = 64;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t sampleFormat;
+        uint32_t flags;
+        float size[2];
+        float heightScale;
+        float heightOffset;
+        uint64_t sourceKey;
+        uint64_t samplesOffset;
+        uint64_t normalsOffset;
+    };
+    static_assert(sizeof(FileHeader) == 64, "height field header layout changed");
+
+    uint64_t AlignUp(uint64_t value) {
+        return (value + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+    }
+
+    // IEEE 754 binary16, round to nearest even; overflow saturates to infinity
+    uint16_t FloatToHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000u;
+        uint32_t exponent = (bits >> 23) & 0xffu;
+        uint32_t mantissa = bits & 0x7fffffu;
+
+        if (exponent == 0xffu) {
+            return static_cast<uint16_t>(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+        }
+        int halfExponent = static_cast<int>(exponent) - 127 + 15;
+        if (halfExponent >= 31) {
+            return static_cast<uint16_t>(sign | 0x7c00u);
+        }
+        if (halfExponent <= 0) {
+            if (halfExponent < -10) {
+                return static_cast<uint16_t>(sign);
+            }
+            mantissa |= 0x800000u;
+            uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+            uint32_t half = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1);
+            uint32_t midpoint = 1u << (shift - 1);
+            if (remainder > midpoint || (remainder == midpoint && (half & 1u))) {
+                ++half;
+            }
+            return static_cast<uint16_t>(sign | half);
+        }
+        uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1fffu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+            ++half;   // May carry into the exponent, which is still correct
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    float HalfToFloat(uint16_t value) {
+        uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+        uint32_t exponent = (value >> 10) & 0x1fu;
+        uint32_t mantissa = value & 0x3ffu;
+
+        uint32_t bits;
+        if (exponent == 0) {
+            if (mantissa == 0) {
+                bits = sign;
+            } else {
+                // Subnormal: renormalise
+                exponent = 127 - 15 + 1;
+                while (!(mantissa & 0x400u)) {
+                    mantissa <<= 1;
+                    --exponent;
+                }
+                bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+            }
+        } else if (exponent == 31) {
+            bits = sign | 0x7f800000u | (mantissa << 13);
+        } else {
+            bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+}
+
+bool HeightFieldFile::IsHeightFieldFile(const std::string& filePath) {
+    std::string extension = std::filesystem::path(filePath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".hfld";
+}
+
+bool HeightFieldFile::Write(const std::string& filePath, const HeightField& field, const Metadata& metadata,
+                            SampleFormat format, const std::vector<glm::vec3>& normals) {
+    const size_t count = static_cast<size_t>(field.GetWidth()) * field.GetHeight();
+    if (count == 0) {
+        std::cerr << "Cannot write an empty height field: " << filePath << std::endl;
+        return false;
+    }
+    bool hasNormals = !normals.empty();
+    if (hasNormals && normals.size() != count) {
+        std::cerr << "Height field normals do not match its size: " << filePath << std::endl;
+        return false;
+    }
+
+    FileHeader header = {};
+    std::copy(MAGIC, MAGIC + 4, header.magic);
+    header.version = VERSION;
+    header.width = static_cast<uint32_t>(field.GetWidth());
+    header.height = static_cast<uint32_t>(field.GetHeight());
+    header.sampleFormat = static_cast<uint32_t>(format);
+    header.flags = hasNormals ? FLAG_NORMALS : 0;
+    header.size[0] = metadata.size.x;
+    header.size[1] = metadata.size.y;
+    header.heightScale = metadata.heightScale;
+    header.heightOffset = metadata.heightOffset;
+    header.sourceKey = metadata.sourceKey;
+    header.samplesOffset = AlignUp(sizeof(FileHeader));
+    size_t sampleBytes = count * (format == SampleFormat::FLOAT16 ? sizeof(uint16_t) : sizeof(float));
+    header.normalsOffset = hasNormals ? AlignUp(header.samplesOffset + sampleBytes) : 0;
+
+    bool written = FileUtils::WriteFileAtomic(filePath, [&](std::ostream& file) {
+        const char padding[SECTION_ALIGNMENT] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(padding, header.samplesOffset - sizeof(header));
+        if (format == SampleFormat::FLOAT16) {
+            std::vector<uint16_t> row(field.GetWidth());
+            for (int z = 0; z < field.GetHeight(); ++z) {
+                const float* source = field.GetRow(z);
+                std::transform(source, source + field.GetWidth(), row.begin(), FloatToHalf);
+                file.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(uint16_t));
+            }
+        } else {
+            file.write(reinterpret_cast<const char*>(field.GetData()), sampleBytes);
+        }
+        if (hasNormals) {
+            file.write(padding, header.normalsOffset - header.samplesOffset - sampleBytes);
+            file.write(reinterpret_cast<const char*>(normals.data()), count * sizeof(glm::vec3));
+        }
+        return true;
+    });
+    if (!written) {
+        std::cerr << "Failed to write height field: " << filePath << std::endl;
+    }
+    return written;
+}
+
+bool HeightFieldFile::Read(const std::string& filePath, HeightField& field, Metadata& metadata,
+                           std::vector<glm::vec3>& normals) {
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->Open(filePath)) {
+        return false;
+    }
+
+    FileHeader header;
+    if (mapping->GetSize() < sizeof(header)) {
+        std::cerr << "Truncated height field: " << filePath << std::endl;
+        return false;
+    }
+    std::memcpy(&header, mapping->GetData(), sizeof(header));
+    if (!std::equal(header.magic, header.magic + 4, MAGIC)) {
+        std::cerr << "Not a height field file: " << filePath << std::endl;
+        return false;
+    }
+    if (header.version != VERSION) {
+        std::cerr << "Unsupported height field version " << header.version << ": " << filePath << std::endl;
+        return false;
+    }
+    if (header.sampleFormat != static_cast<uint32_t>(SampleFormat::FLOAT32) &&
+        header.sampleFormat != static_cast<uint32_t>(SampleFormat::FLOAT16)) {
+        std::cerr << "Unknown height field sample format: " << filePath << std::endl;
+        return false;
+    }
+
+    const uint64_t count = static_cast<uint64_t>(header.width) * header.height;
+    const bool halfFloat = header.sampleFormat == static_cast<uint32_t>(SampleFormat::FLOAT16);
+    const uint64_t sampleBytes = count * (halfFloat ? sizeof(uint16_t) : sizeof(float));
+    const bool hasNormals = (header.flags & FLAG_NORMALS) != 0;
+    // Offsets come from the file, so compare without adding them to sizes
+    const uint64_t fileSize = mapping->GetSize();
+    auto fits = [fileSize](uint64_t offset, uint64_t bytes) { return offset <= fileSize && bytes <= fileSize - offset; };
+    bool valid = count > 0 && header.width <= 65536 && header.height <= 65536 &&
+                 header.samplesOffset % SECTION_ALIGNMENT == 0 && fits(header.samplesOffset, sampleBytes);
+    if (valid && hasNormals) {
+        valid = header.normalsOffset % SECTION_ALIGNMENT == 0 && header.normalsOffset >= header.samplesOffset + sampleBytes &&
+                fits(header.normalsOffset, count * sizeof(glm::vec3));
+    }
+    if (!valid) {
+        std::cerr << "Corrupt or truncated height field: " << filePath << std::endl;
+        return false;
+    }
+
+    metadata.size = glm::vec2(header.size[0], header.size[1]);
+    metadata.heightScale = header.heightScale;
+    metadata.heightOffset = header.heightOffset;
+    metadata.sourceKey = header.sourceKey;
+
+    const int width = static_cast<int>(header.width);
+    const int height = static_cast<int>(header.height);
+    const unsigned char* samples = mapping->GetData() + header.samplesOffset;
+    if (hasNormals) {
+        normals.resize(count);
+        std::memcpy(normals.data(), mapping->GetData() + header.normalsOffset, count * sizeof(glm::vec3));
+    } else {
+        normals.clear();
+    }
+
+    if (halfFloat) {
+        field.Resize(width, height);
+        const uint16_t* source = reinterpret_cast<const uint16_t*>(samples);
+        ParallelFor(height, MIN_ROWS_PER_BAND, [&](int begin, int end) {
+            for (int z = begin; z < end; ++z) {
+                const uint16_t* row = source + static_cast<size_t>(z) * width;
+                std::transform(row, row + width, field.GetRow(z), HalfToFloat);
+            }
+        });
+    } else {
+        field.SetView(width, height, reinterpret_cast<const float*>(samples), mapping);
+    }
+    return true;
+}
@@ -0,0 +1,382 @@
+#include "Utils/ImageLoader.h"
+#include "Utils/TextureContainer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#if __has_include("stb_image.h")
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#include "stb_image.h"
+#define IMAGE_LOADER_HAS_STB 1
+#else
+#define IMAGE_LOADER_HAS_STB 0
+#endif
+
+namespace {
+    std::string GetLowerExtension(const std::string& filePath) {
+        size_t dot = filePath.find_last_of('.');
+        if (dot == std::string::npos) {
+            return "";
+        }
+        std::string extension = filePath.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
+    }
+
+    void FlipRows(unsigned char* pixels, size_t rowBytes, int rowCount) {
+        std::vector<unsigned char> row(rowBytes);
+        for (int y = 0; y < rowCount / 2; ++y) {
+            unsigned char* top = pixels + y * rowBytes;
+            unsigned char* bottom = pixels + (rowCount - 1 - y) * rowBytes;
+            std::memcpy(row.data(), top, rowBytes);
+            std::memcpy(top, bottom, rowBytes);
+            std::memcpy(bottom, row.data(), rowBytes);
+        }
+    }
+
+    void FlipRows(Image& image) {
+        FlipRows(image.pixels.data(), static_cast<size_t>(image.width) * image.channels, image.height);
+    }
+
+    // BC4-style block: two endpoints, then 3-bit indices packed 12 bits per row
+    void FlipAlphaBlock(unsigned char* block, int rows) {
+        uint64_t bits = 0;
+        for (int i = 0; i < 6; ++i) {
+            bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+        }
+        uint64_t flipped = bits;
+        for (int row = 0; row < rows; ++row) {
+            uint64_t rowBits = (bits >> (12 * row)) & 0xFFF;
+            int target = rows - 1 - row;
+            flipped &= ~(static_cast<uint64_t>(0xFFF) << (12 * target));
+            flipped |= rowBits << (12 * target);
+        }
+        for (int i = 0; i < 6; ++i) {
+            block[2 + i] = static_cast<unsigned char>(flipped >> (8 * i));
+        }
+    }
+
+    // BC1 block: two endpoints, then 2-bit indices, one byte per row
+    void FlipColorBlock(unsigned char* block, int rows) {
+        std::reverse(block + 4, block + 4 + rows);
+    }
+
+    // Next header token of a PNM file, skipping whitespace and # comments
+    bool ReadPNMToken(const std::vector<unsigned char>& data, size_t& pos, int& value) {
+        while (pos < data.size()) {
+            if (data[pos] == '#') {
+                while (pos < data.size() && data[pos] != '\n') pos++;
+            } else if (std::isspace(data[pos])) {
+                pos++;
+            } else {
+                break;
+            }
+        }
+        if (pos >= data.size() || !std::isdigit(data[pos])) {
+            return false;
+        }
+        value = 0;
+        while (pos < data.size() && std::isdigit(data[pos])) {
+            value = value * 10 + (data[pos++] - '0');
+        }
+        return true;
+    }
+}
+
+bool ImageLoader::IsSupported(const std::string& filePath) {
+    std::string extension = GetLowerExtension(filePath);
+    if (extension == "ppm" || extension == "pgm" || extension == "tga" ||
+        extension == "ktx2" || extension == "dds") {
+        return true;
+    }
+    return IMAGE_LOADER_HAS_STB && (extension == "png" || extension == "jpg" || extension == "jpeg" ||
+                                    extension == "bmp" || extension == "hdr" || extension == "psd");
+}
+
+bool ImageLoader::Load(const std::string& filePath, Image& image, std::string& error) {
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        error = "Failed to open image: " + filePath;
+        return false;
+    }
+    std::vector<unsigned char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!file) {
+        error = "Failed to read image: " + filePath;
+        return false;
+    }
+
+    image = Image();
+    std::string extension = GetLowerExtension(filePath);
+    bool loaded;
+    if (extension == "ppm" || extension == "pgm") {
+        loaded = LoadPNM(data, image, error);
+    } else if (extension == "tga") {
+        loaded = LoadTGA(data, image, error);
+    } else if (extension == "ktx2") {
+        // Containers fill in their own levels
+        loaded = TextureContainer::ReadKTX2(data, image, error);
+    } else if (extension == "dds") {
+        loaded = TextureContainer::ReadDDS(data, image, error);
+    } else {
+        loaded = LoadWithStb(data, image, error);
+    }
+    if (!loaded) {
+        error = filePath + ": " + error;
+        return false;
+    }
+
+    if (image.levels.empty()) {
+        ExpandRGB(image);
+        image.levels = { { image.width, image.height, 0, image.pixels.size() } };
+    }
+    return true;
+}
+
+bool ImageLoader::LoadPNM(const std::vector<unsigned char>& data, Image& image, std::string& error) {
+    if (data.size() < 2 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) {
+        error = "only binary PGM (P5) and PPM (P6) are supported";
+        return false;
+    }
+
+    size_t pos = 2;
+    int maxValue = 0;
+    if (!ReadPNMToken(data, pos, image.width) || !ReadPNMToken(data, pos, image.height) ||
+        !ReadPNMToken(data, pos, maxValue) || pos >= data.size()) {
+        error = "malformed PNM header";
+        return false;
+    }
+    if (maxValue <= 0 || maxValue > 255 || image.width <= 0 || image.height <= 0) {
+        error = "unsupported PNM dimensions or bit depth";
+        return false;
+    }
+    pos++;   // Single whitespace before the raster
+
+    image.channels = data[1] == '6' ? 3 : 1;
+    size_t size = static_cast<size_t>(image.width) * image.height * image.channels;
+    if (data.size() - pos < size) {
+        error = "truncated PNM raster";
+        return false;
+    }
+    image.pixels.assign(data.begin() + pos, data.begin() + pos + size);
+
+    // PNM stores the top row first
+    FlipRows(image);
+    return true;
+}
+
+bool ImageLoader::LoadTGA(const std::vector<unsigned char>& data, Image& image, std::string& error) {
+    if (data.size() < 18) {
+        error = "truncated TGA header";
+        return false;
+    }
+
+    int idLength = data[0];
+    int colorMapType = data[1];
+    int imageType = data[2];
+    image.width = data[12] | (data[13] << 8);
+    image.height = data[14] | (data[15] << 8);
+    int bitsPerPixel = data[16];
+    bool topLeftOrigin = (data[17] & 0x20) != 0;
+
+    bool rle = imageType == 10 || imageType == 11;
+    bool gray = imageType == 3 || imageType == 11;
+    if (colorMapType != 0 || (imageType != 2 && imageType != 3 && !rle)) {
+        error = "only true-color and grayscale TGA are supported";
+        return false;
+    }
+    if ((gray && bitsPerPixel != 8) || (!gray && bitsPerPixel != 24 && bitsPerPixel != 32) ||
+        image.width <= 0 || image.height <= 0) {
+        error = "unsupported TGA bit depth or dimensions";
+        return false;
+    }
+
+    image.channels = bitsPerPixel / 8;
+    size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    image.pixels.resize(pixelCount * image.channels);
+
+    size_t pos = 18 + idLength;
+    size_t written = 0;
+    const size_t pixelBytes = image.channels;
+    while (written < pixelCount) {
+        size_t run = 1;
+        bool repeat = false;
+        if (rle) {
+            if (pos >= data.size()) break;
+            unsigned char header = data[pos++];
+            run = (header & 0x7F) + 1;
+            repeat = (header & 0x80) != 0;
+        } else {
+            run = pixelCount;
+        }
+        run = std::min(run, pixelCount - written);
+
+        size_t needed = repeat ? pixelBytes : run * pixelBytes;
+        if (data.size() - std::min(pos, data.size()) < needed) {
+            break;
+        }
+        for (size_t i = 0; i < run; ++i) {
+            const unsigned char* src = &data[pos + (repeat ? 0 : i * pixelBytes)];
+            std::memcpy(&image.pixels[(written + i) * pixelBytes], src, pixelBytes);
+        }
+        pos += needed;
+        written += run;
+    }
+    if (written < pixelCount) {
+        error = "truncated TGA raster";
+        return false;
+    }
+
+    // BGR(A) to RGB(A)
+    if (image.channels >= 3) {
+        for (size_t i = 0; i < pixelCount; ++i) {
+            std::swap(image.pixels[i * pixelBytes], image.pixels[i * pixelBytes + 2]);
+        }
+    }
+    if (topLeftOrigin) {
+        FlipRows(image);
+    }
+    return true;
+}
+
+bool ImageLoader::LoadWithStb(const std::vector<unsigned char>& data, Image& image, std::string& error) {
+#if IMAGE_LOADER_HAS_STB
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_uc* pixels = stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &width, &height, &channels, 0);
+    if (!pixels) {
+        error = stbi_failure_reason();
+        return false;
+    }
+    image.width = width;
+    image.height = height;
+    image.channels = channels;
+    image.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * channels);
+    stbi_image_free(pixels);
+
+    // stb_image returns the top row first
+    FlipRows(image);
+    return true;
+#else
+    (void)data;
+    (void)image;
+    error = "unsupported format (PNG/JPEG need stb_image.h on the include path)";
+    return false;
+#endif
+}
+
+void ImageLoader::ExpandRGB(Image& image) {
+    // RGB8 rows are rarely 4-byte aligned and RGB8 is often stored as RGBA
+    // by the driver anyway
+    if (image.channels != 3) {
+        return;
+    }
+    size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    std::vector<unsigned char> rgba(pixelCount * 4);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        rgba[i * 4 + 0] = image.pixels[i * 3 + 0];
+        rgba[i * 4 + 1] = image.pixels[i * 3 + 1];
+        rgba[i * 4 + 2] = image.pixels[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+    image.pixels.swap(rgba);
+    image.channels = 4;
+}
+
+void ImageLoader::GenerateMipChain(Image& image) {
+    if (image.levels.empty() || image.IsCompressed()) {
+        return;
+    }
+    image.levels.resize(1);
+
+    // Sizes first, so pixels is resized once
+    size_t total = image.levels[0].size;
+    int width = image.width;
+    int height = image.height;
+    while (width > 1 || height > 1) {
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        size_t size = static_cast<size_t>(width) * height * image.channels;
+        image.levels.push_back({ width, height, total, size });
+        total += size;
+    }
+    image.pixels.resize(total);
+
+    const int channels = image.channels;
+    for (size_t level = 1; level < image.levels.size(); ++level) {
+        const Image::Level& src = image.levels[level - 1];
+        const Image::Level& dst = image.levels[level];
+        const unsigned char* srcPixels = image.pixels.data() + src.offset;
+        unsigned char* dstPixels = image.pixels.data() + dst.offset;
+
+        // 2x2 box filter; odd edges reuse the last row/column
+        for (int y = 0; y < dst.height; ++y) {
+            int y0 = std::min(y * 2, src.height - 1);
+            int y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                int x0 = std::min(x * 2, src.width - 1);
+                int x1 = std::min(x * 2 + 1, src.width - 1);
+                for (int c = 0; c < channels; ++c) {
+                    int sum = srcPixels[(y0 * src.width + x0) * channels + c] +
+                              srcPixels[(y0 * src.width + x1) * channels + c] +
+                              srcPixels[(y1 * src.width + x0) * channels + c] +
+                              srcPixels[(y1 * src.width + x1) * channels + c];
+                    dstPixels[(y * dst.width + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+bool ImageLoader::FlipVertical(Image& image) {
+    if (image.blockFormat == BlockFormat::BC7) {
+        return false;
+    }
+
+    for (size_t index = 0; index < image.levels.size(); ++index) {
+        const Image::Level& level = image.levels[index];
+        unsigned char* pixels = image.pixels.data() + level.offset;
+        size_t rowBytes = image.GetRowBytes(static_cast<int>(index));
+        int rowCount = image.GetRowCount(static_cast<int>(index));
+        FlipRows(pixels, rowBytes, rowCount);
+
+        // Whole blocks flip, so a level whose height is not a multiple of
+        // four ends up shifted by its padding rows (small mips only, unless
+        // the image itself has such a height)
+        if (image.IsCompressed()) {
+            int blockBytes = Image::GetBlockBytes(image.blockFormat);
+            int rows = std::min(level.height, 4);
+            for (size_t offset = 0; offset < level.size; offset += blockBytes) {
+                FlipBlock(pixels + offset, image.blockFormat, rows);
+            }
+        }
+    }
+    return true;
+}
+
+void ImageLoader::FlipBlock(unsigned char* block, BlockFormat format, int rows) {
+    switch (format) {
+        case BlockFormat::BC1:
+            FlipColorBlock(block, rows);
+            break;
+        case BlockFormat::BC3:
+            FlipAlphaBlock(block, rows);
+            FlipColorBlock(block + 8, rows);
+            break;
+        case BlockFormat::BC4:
+            FlipAlphaBlock(block, rows);
+            break;
+        case BlockFormat::BC5:
+            FlipAlphaBlock(block, rows);
+            FlipAlphaBlock(block + 8, rows);
+            break;
+        default:
+            break;
+    }
+}
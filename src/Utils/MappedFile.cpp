@@ -0,0 +1,74 @@
+#include "Utils/MappedFile.h"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : data(nullptr), size(0), mapped(false) {
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& filePath) {
+    Close();
+
+#ifdef MAPPED_FILE_MMAP
+    int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive on its own
+    close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(status.st_size);
+    mapped = true;
+    return true;
+#else
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamsize length = file.tellg();
+    if (length <= 0) {
+        return false;
+    }
+    buffer.resize(static_cast<size_t>(length));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), length)) {
+        buffer.clear();
+        return false;
+    }
+    data = buffer.data();
+    size = buffer.size();
+    return true;
+#endif
+}
+
+void MappedFile::Close() {
+#ifdef MAPPED_FILE_MMAP
+    if (mapped && data) {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+#endif
+    buffer.clear();
+    buffer.shrink_to_fit();
+    data = nullptr;
+    size = 0;
+    mapped = false;
+}
@@ -0,0 +1,293 @@
+#include "Utils/TerrainPyramid.h"
+#include "Utils/FileUtils.h"
+#include "Utils/ParallelFor.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+
+namespace {
+    const char MAGIC[4] = { 'H', 'T', 'P', 'Y' };
+    const uint64_t SECTION_ALIGNMENT = 64;
+    const int MIN_NODE_ROWS_PER_BAND = 4;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t resolution;
+        uint32_t patchSize;
+        uint32_t levelCount;
+        uint32_t reserved;
+        float size[2];
+        float heightScale;
+        float heightOffset;
+        uint64_t sourceKey;
+        uint64_t boundsOffset;
+        uint64_t tilesOffset;
+    };
+    static_assert(sizeof(FileHeader) == 64, "terrain pyramid header layout changed");
+
+    uint64_t AlignUp(uint64_t value) {
+        return (value + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+    }
+
+    int NodeCount(int resolution, int patchSize, int level) {
+        int span = patchSize << level;
+        return (resolution - 1 + span - 1) / span;
+    }
+
+    // Samples on the far edges belong to both neighbours
+    glm::vec2 SampleRange(const HeightField& field, int span, int x, int z) {
+        const int cells = field.GetWidth() - 1;
+        glm::vec2 range(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+        int lastX = std::min((x + 1) * span, cells);
+        for (int sz = z * span; sz <= std::min((z + 1) * span, cells); ++sz) {
+            const float* row = field.GetRow(sz);
+            for (int sx = x * span; sx <= lastX; ++sx) {
+                range.x = std::min(range.x, row[sx]);
+                range.y = std::max(range.y, row[sx]);
+            }
+        }
+        return range;
+    }
+
+    glm::vec2 ChildRange(const std::vector<glm::vec2>& children, int childCount, int x, int z) {
+        glm::vec2 range(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+        for (int cz = 2 * z; cz < std::min(2 * z + 2, childCount); ++cz) {
+            for (int cx = 2 * x; cx < std::min(2 * x + 2, childCount); ++cx) {
+                range.x = std::min(range.x, children[static_cast<size_t>(cz) * childCount + cx].x);
+                range.y = std::max(range.y, children[static_cast<size_t>(cz) * childCount + cx].y);
+            }
+        }
+        return range;
+    }
+}
+
+TerrainPyramid::TerrainPyramid() : resolution(0), patchSize(0) {
+}
+
+std::vector<std::vector<glm::vec2>> TerrainPyramid::ComputeBounds(const HeightField& field, int patchSize) {
+    std::vector<std::vector<glm::vec2>> levels;
+    const int resolution = field.GetWidth();
+    const int cells = resolution - 1;
+    if (cells < 1 || patchSize < 1) {
+        return levels;
+    }
+
+    for (int level = 0;; ++level) {
+        int span = patchSize << level;
+        int count = NodeCount(resolution, patchSize, level);
+        std::vector<glm::vec2> bounds(static_cast<size_t>(count) * count);
+
+        if (level == 0) {
+            ParallelFor(count, MIN_NODE_ROWS_PER_BAND, [&](int begin, int end) {
+                for (int z = begin; z < end; ++z) {
+                    for (int x = 0; x < count; ++x) {
+                        bounds[static_cast<size_t>(z) * count + x] = SampleRange(field, span, x, z);
+                    }
+                }
+            });
+        } else {
+            int childCount = NodeCount(resolution, patchSize, level - 1);
+            for (int z = 0; z < count; ++z) {
+                for (int x = 0; x < count; ++x) {
+                    bounds[static_cast<size_t>(z) * count + x] = ChildRange(levels[level - 1], childCount, x, z);
+                }
+            }
+        }
+
+        levels.push_back(std::move(bounds));
+        if (count == 1) {
+            return levels;
+        }
+    }
+}
+
+void TerrainPyramid::UpdateBounds(const HeightField& field, int patchSize, const glm::ivec2& first,
+                                  const glm::ivec2& last, std::vector<std::vector<glm::vec2>>& levels) {
+    const int resolution = field.GetWidth();
+    if (levels.empty() || resolution < 2) {
+        return;
+    }
+
+    // Level 0 nodes holding the samples; one on a node edge is in both nodes
+    int count = NodeCount(resolution, patchSize, 0);
+    glm::ivec2 nodeMin(std::max(first.x - 1, 0) / patchSize, std::max(first.y - 1, 0) / patchSize);
+    glm::ivec2 nodeMax(std::min(last.x / patchSize, count - 1), std::min(last.y / patchSize, count - 1));
+    for (int z = nodeMin.y; z <= nodeMax.y; ++z) {
+        for (int x = nodeMin.x; x <= nodeMax.x; ++x) {
+            levels[0][static_cast<size_t>(z) * count + x] = SampleRange(field, patchSize, x, z);
+        }
+    }
+
+    for (int level = 1; level < static_cast<int>(levels.size()); ++level) {
+        int childCount = count;
+        count = NodeCount(resolution, patchSize, level);
+        nodeMin /= 2;
+        nodeMax /= 2;
+        for (int z = nodeMin.y; z <= nodeMax.y; ++z) {
+            for (int x = nodeMin.x; x <= nodeMax.x; ++x) {
+                levels[level][static_cast<size_t>(z) * count + x] = ChildRange(levels[level - 1], childCount, x, z);
+            }
+        }
+    }
+}
+
+void TerrainPyramid::ExtractTile(const HeightField& field, int patchSize, int level, int x, int z, float* tile) {
+    const int stride = 1 << level;
+    const int span = patchSize << level;
+    const int last = field.GetWidth() - 1;
+    const int side = patchSize + 3;
+
+    for (int j = 0; j < side; ++j) {
+        const float* row = field.GetRow(std::clamp(z * span + (j - 1) * stride, 0, last));
+        float* target = tile + static_cast<size_t>(j) * side;
+        for (int i = 0; i < side; ++i) {
+            target[i] = row[std::clamp(x * span + (i - 1) * stride, 0, last)];
+        }
+    }
+}
+
+bool TerrainPyramid::Write(const std::string& filePath, const HeightField& field,
+                           const HeightFieldFile::Metadata& metadata, int patchSize) {
+    if (field.GetWidth() != field.GetHeight() || field.GetWidth() < 2 || patchSize < 1) {
+        std::cerr << "Terrain pyramids need a square height field: " << filePath << std::endl;
+        return false;
+    }
+
+    std::vector<std::vector<glm::vec2>> levels = ComputeBounds(field, patchSize);
+    size_t boundsCount = 0;
+    for (const auto& level : levels) {
+        boundsCount += level.size();
+    }
+
+    FileHeader header = {};
+    std::copy(MAGIC, MAGIC + 4, header.magic);
+    header.version = VERSION;
+    header.resolution = static_cast<uint32_t>(field.GetWidth());
+    header.patchSize = static_cast<uint32_t>(patchSize);
+    header.levelCount = static_cast<uint32_t>(levels.size());
+    header.size[0] = metadata.size.x;
+    header.size[1] = metadata.size.y;
+    header.heightScale = metadata.heightScale;
+    header.heightOffset = metadata.heightOffset;
+    header.sourceKey = metadata.sourceKey;
+    header.boundsOffset = AlignUp(sizeof(FileHeader));
+    header.tilesOffset = AlignUp(header.boundsOffset + boundsCount * sizeof(glm::vec2));
+
+    bool written = FileUtils::WriteFileAtomic(filePath, [&](std::ostream& file) {
+        const char padding[SECTION_ALIGNMENT] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(padding, header.boundsOffset - sizeof(header));
+        for (const auto& level : levels) {
+            file.write(reinterpret_cast<const char*>(level.data()), level.size() * sizeof(glm::vec2));
+        }
+        file.write(padding, header.tilesOffset - header.boundsOffset - boundsCount * sizeof(glm::vec2));
+
+        // One row of tiles at a time, extracted in parallel
+        const size_t tileFloats = static_cast<size_t>(patchSize + 3) * (patchSize + 3);
+        std::vector<float> row;
+        for (int level = 0; level < static_cast<int>(levels.size()) && file; ++level) {
+            int count = NodeCount(field.GetWidth(), patchSize, level);
+            row.resize(tileFloats * count);
+            for (int z = 0; z < count && file; ++z) {
+                ParallelFor(count, 8, [&](int begin, int end) {
+                    for (int x = begin; x < end; ++x) {
+                        ExtractTile(field, patchSize, level, x, z, row.data() + tileFloats * x);
+                    }
+                });
+                file.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+            }
+        }
+        return true;
+    });
+    if (!written) {
+        std::cerr << "Failed to write terrain pyramid: " << filePath << std::endl;
+    }
+    return written;
+}
+
+bool TerrainPyramid::Open(const std::string& path) {
+    filePath.clear();
+    bounds.clear();
+    levelOffsets.clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open terrain pyramid: " << path << std::endl;
+        return false;
+    }
+    FileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || !std::equal(header.magic, header.magic + 4, MAGIC)) {
+        std::cerr << "Not a terrain pyramid: " << path << std::endl;
+        return false;
+    }
+    if (header.version != VERSION) {
+        std::cerr << "Unsupported terrain pyramid version " << header.version << ": " << path << std::endl;
+        return false;
+    }
+    if (header.resolution < 2 || header.resolution > 1u << 20 || header.patchSize < 1 || header.patchSize > 1024) {
+        std::cerr << "Corrupt terrain pyramid: " << path << std::endl;
+        return false;
+    }
+
+    resolution = static_cast<int>(header.resolution);
+    patchSize = static_cast<int>(header.patchSize);
+    metadata.size = glm::vec2(header.size[0], header.size[1]);
+    metadata.heightScale = header.heightScale;
+    metadata.heightOffset = header.heightOffset;
+    metadata.sourceKey = header.sourceKey;
+
+    // The level count follows from the resolution; check rather than trust it
+    int levelCount = 0;
+    while (NodeCount(resolution, patchSize, levelCount) > 1) {
+        levelCount++;
+    }
+    levelCount++;
+    if (static_cast<int>(header.levelCount) != levelCount) {
+        std::cerr << "Corrupt terrain pyramid: " << path << std::endl;
+        return false;
+    }
+
+    file.seekg(static_cast<std::streamoff>(header.boundsOffset));
+    uint64_t offset = header.tilesOffset;
+    for (int level = 0; level < levelCount; ++level) {
+        int count = NodeCount(resolution, patchSize, level);
+        std::vector<glm::vec2> levelBounds(static_cast<size_t>(count) * count);
+        file.read(reinterpret_cast<char*>(levelBounds.data()), levelBounds.size() * sizeof(glm::vec2));
+        bounds.push_back(std::move(levelBounds));
+        levelOffsets.push_back(offset);
+        offset += static_cast<uint64_t>(count) * count * GetTileBytes();
+    }
+
+    std::error_code error;
+    uint64_t fileSize = std::filesystem::file_size(path, error);
+    if (!file || error || fileSize < offset) {
+        std::cerr << "Truncated terrain pyramid: " << path << std::endl;
+        bounds.clear();
+        levelOffsets.clear();
+        return false;
+    }
+    filePath = path;
+    return true;
+}
+
+int TerrainPyramid::GetNodeCount(int level) const {
+    return NodeCount(resolution, patchSize, level);
+}
+
+bool TerrainPyramid::ReadTile(std::ifstream& file, int level, int x, int z, float* tile) const {
+    if (level < 0 || level >= static_cast<int>(levelOffsets.size())) {
+        return false;
+    }
+    int count = GetNodeCount(level);
+    if (x < 0 || z < 0 || x >= count || z >= count) {
+        return false;
+    }
+    uint64_t offset = levelOffsets[level] + (static_cast<uint64_t>(z) * count + x) * GetTileBytes();
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(tile), static_cast<std::streamsize>(GetTileBytes()));
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,481 @@
+#include "Utils/TextureContainer.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const size_t KTX2_HEADER_SIZE = 80;   // Identifier, header and index, up to the level index
+    const size_t KTX2_LEVEL_ALIGNMENT = 16;   // Multiple of every block size and of 4
+
+    const uint32_t DDS_MAGIC = 0x20534444;   // "DDS "
+    const size_t DDS_HEADER_SIZE = 128;   // Magic and DDS_HEADER
+    const size_t DDS_DX10_HEADER_SIZE = 20;
+    const uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PITCH = 0x8;
+    const uint32_t DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+    const uint32_t DDPF_FOURCC = 0x4, DDPF_RGB = 0x40, DDPF_ALPHAPIXELS = 0x1;
+    const uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+    const uint32_t DDSCAPS2_CUBEMAP = 0x200, DDSCAPS2_VOLUME = 0x200000;
+    const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+    // Largest texture any GL 4.3 driver accepts; also keeps level sizes far from overflow
+    const int MAX_DIMENSION = 32768;
+
+    constexpr uint32_t FourCC(char a, char b, char c, char d) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(a)) |
+               static_cast<uint32_t>(static_cast<unsigned char>(b)) << 8 |
+               static_cast<uint32_t>(static_cast<unsigned char>(c)) << 16 |
+               static_cast<uint32_t>(static_cast<unsigned char>(d)) << 24;
+    }
+
+    uint32_t ReadU32(const std::vector<unsigned char>& data, size_t offset) {
+        return static_cast<uint32_t>(data[offset]) | static_cast<uint32_t>(data[offset + 1]) << 8 |
+               static_cast<uint32_t>(data[offset + 2]) << 16 | static_cast<uint32_t>(data[offset + 3]) << 24;
+    }
+
+    uint64_t ReadU64(const std::vector<unsigned char>& data, size_t offset) {
+        return static_cast<uint64_t>(ReadU32(data, offset)) | static_cast<uint64_t>(ReadU32(data, offset + 4)) << 32;
+    }
+
+    void WriteU32(std::vector<unsigned char>& data, size_t offset, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            data[offset + i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+    }
+
+    void WriteU64(std::vector<unsigned char>& data, size_t offset, uint64_t value) {
+        WriteU32(data, offset, static_cast<uint32_t>(value));
+        WriteU32(data, offset + 4, static_cast<uint32_t>(value >> 32));
+    }
+
+    size_t Align(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Value of a key in the KTX2 key/value data, or "" when absent
+    std::string FindKeyValue(const std::vector<unsigned char>& data, size_t offset, size_t length, const char* key) {
+        size_t end = std::min(data.size(), offset + length);
+        size_t keyLength = std::strlen(key);
+        while (offset + 4 <= end) {
+            uint32_t entryLength = ReadU32(data, offset);
+            size_t entry = offset + 4;
+            if (entryLength > end - entry) {
+                break;
+            }
+            if (entryLength > keyLength && std::memcmp(&data[entry], key, keyLength) == 0 && data[entry + keyLength] == 0) {
+                std::string value(reinterpret_cast<const char*>(&data[entry + keyLength + 1]), entryLength - keyLength - 1);
+                return value.substr(0, value.find('\0'));
+            }
+            offset = Align(entry + entryLength, 4);
+        }
+        return "";
+    }
+
+    void AppendKeyValue(std::vector<unsigned char>& data, const std::string& key, const std::string& value) {
+        uint32_t length = static_cast<uint32_t>(key.size() + 1 + value.size() + 1);
+        size_t offset = data.size();
+        data.resize(Align(offset + 4 + length, 4), 0);
+        WriteU32(data, offset, length);
+        std::memcpy(&data[offset + 4], key.c_str(), key.size() + 1);
+        std::memcpy(&data[offset + 4 + key.size() + 1], value.c_str(), value.size() + 1);
+    }
+
+    bool WriteFile(const std::string& filePath, const std::vector<unsigned char>& data, std::string& error) {
+        std::ofstream file(filePath, std::ios::binary);
+        if (!file) {
+            error = "Failed to open " + filePath + " for writing";
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!file) {
+            error = "Failed to write " + filePath;
+            return false;
+        }
+        return true;
+    }
+}
+
+// vkFormat and DXGI_FORMAT values of everything the engine uploads
+const TextureContainer::FormatInfo TextureContainer::FORMATS[] = {
+    { 9, 61, BlockFormat::NONE, 1, false },      // R8_UNORM
+    { 16, 49, BlockFormat::NONE, 2, false },     // R8G8_UNORM
+    { 37, 28, BlockFormat::NONE, 4, false },     // R8G8B8A8_UNORM
+    { 43, 29, BlockFormat::NONE, 4, true },      // R8G8B8A8_SRGB
+    { 133, 71, BlockFormat::BC1, 4, false },     // BC1_RGBA_UNORM
+    { 134, 72, BlockFormat::BC1, 4, true },      // BC1_RGBA_SRGB
+    { 131, 71, BlockFormat::BC1, 4, false },     // BC1_RGB_UNORM (read only)
+    { 132, 72, BlockFormat::BC1, 4, true },      // BC1_RGB_SRGB (read only)
+    { 137, 77, BlockFormat::BC3, 4, false },     // BC3_UNORM
+    { 138, 78, BlockFormat::BC3, 4, true },      // BC3_SRGB
+    { 139, 80, BlockFormat::BC4, 1, false },     // BC4_UNORM
+    { 141, 83, BlockFormat::BC5, 2, false },     // BC5_UNORM
+    { 145, 98, BlockFormat::BC7, 4, false },     // BC7_UNORM
+    { 146, 99, BlockFormat::BC7, 4, true },      // BC7_SRGB
+};
+
+const TextureContainer::FormatInfo* TextureContainer::FindVkFormat(uint32_t vkFormat) {
+    for (const FormatInfo& format : FORMATS) {
+        if (format.vkFormat == vkFormat) return &format;
+    }
+    return nullptr;
+}
+
+const TextureContainer::FormatInfo* TextureContainer::FindDxgiFormat(uint32_t dxgiFormat) {
+    for (const FormatInfo& format : FORMATS) {
+        if (format.dxgiFormat == dxgiFormat) return &format;
+    }
+    return nullptr;
+}
+
+const TextureContainer::FormatInfo* TextureContainer::FindImageFormat(const Image& image) {
+    for (const FormatInfo& format : FORMATS) {
+        if (format.blockFormat == image.blockFormat && format.channels == image.channels && format.srgb == image.srgb) {
+            return &format;
+        }
+    }
+    return nullptr;
+}
+
+size_t TextureContainer::LayoutLevels(Image& image, int levelCount) {
+    // No more levels than the full chain down to 1x1
+    int fullChain = 1;
+    for (int extent = std::max(image.width, image.height); extent > 1; extent /= 2) {
+        ++fullChain;
+    }
+    levelCount = std::min(levelCount, fullChain);
+
+    image.levels.clear();
+    size_t offset = 0;
+    int width = image.width;
+    int height = image.height;
+    for (int level = 0; level < levelCount; ++level) {
+        image.levels.push_back({ width, height, offset, 0 });
+        image.levels.back().size = image.GetRowBytes(level) * image.GetRowCount(level);
+        offset += image.levels.back().size;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return offset;
+}
+
+bool TextureContainer::ReadKTX2(const std::vector<unsigned char>& data, Image& image, std::string& error) {
+    if (data.size() < KTX2_HEADER_SIZE || std::memcmp(data.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        error = "not a KTX2 file";
+        return false;
+    }
+
+    uint32_t vkFormat = ReadU32(data, 12);
+    image.width = static_cast<int>(ReadU32(data, 20));
+    image.height = static_cast<int>(ReadU32(data, 24));
+    uint32_t depth = ReadU32(data, 28);
+    uint32_t layerCount = ReadU32(data, 32);
+    uint32_t faceCount = ReadU32(data, 36);
+    uint32_t levelCount = ReadU32(data, 40);
+    uint32_t supercompression = ReadU32(data, 44);
+    uint32_t kvdOffset = ReadU32(data, 56);
+    uint32_t kvdLength = ReadU32(data, 60);
+
+    if (depth > 1 || layerCount > 1 || faceCount != 1 || image.width <= 0 || image.height <= 0) {
+        error = "only single 2D KTX2 textures are supported";
+        return false;
+    }
+    if (image.width > MAX_DIMENSION || image.height > MAX_DIMENSION) {
+        error = "KTX2 texture larger than " + std::to_string(MAX_DIMENSION) + " pixels";
+        return false;
+    }
+    if (supercompression != 0) {
+        error = "supercompressed KTX2 (Basis Universal, zstd) is not supported";
+        return false;
+    }
+    const FormatInfo* format = FindVkFormat(vkFormat);
+    if (!format) {
+        error = "unsupported KTX2 vkFormat " + std::to_string(vkFormat);
+        return false;
+    }
+
+    image.channels = format->channels;
+    image.blockFormat = format->blockFormat;
+    image.srgb = format->srgb;
+    // levelCount 0 (the writer wants mips generated) is loaded as the single
+    // base level; levels past 1x1 are ignored
+    size_t totalSize = LayoutLevels(image, static_cast<int>(std::min(std::max(levelCount, 1u), 32u)));
+    int levels = static_cast<int>(image.levels.size());
+    if (data.size() < KTX2_HEADER_SIZE + levels * 24) {
+        error = "truncated KTX2 level index";
+        return false;
+    }
+    if (totalSize > data.size()) {
+        error = "truncated KTX2 level data";
+        return false;
+    }
+
+    image.pixels.resize(totalSize);
+    for (int level = 0; level < levels; ++level) {
+        size_t entry = KTX2_HEADER_SIZE + level * 24;
+        uint64_t byteOffset = ReadU64(data, entry);
+        uint64_t byteLength = ReadU64(data, entry + 8);
+        const Image::Level& target = image.levels[level];
+        if (byteLength < target.size || byteOffset > data.size() || data.size() - byteOffset < target.size) {
+            error = "truncated KTX2 level " + std::to_string(level);
+            return false;
+        }
+        std::memcpy(image.pixels.data() + target.offset, data.data() + byteOffset, target.size);
+    }
+
+    // "rd" (top row first) unless the writer says otherwise
+    std::string orientation = FindKeyValue(data, kvdOffset, kvdLength, "KTXorientation");
+    if (orientation.size() < 2 || orientation[1] != 'u') {
+        if (!ImageLoader::FlipVertical(image)) {
+            std::cerr << "Warning: top-down KTX2 cannot be flipped in this format and loads upside down" << std::endl;
+        }
+    }
+    return true;
+}
+
+bool TextureContainer::ReadDDS(const std::vector<unsigned char>& data, Image& image, std::string& error) {
+    if (data.size() < DDS_HEADER_SIZE || ReadU32(data, 0) != DDS_MAGIC || ReadU32(data, 4) != 124) {
+        error = "not a DDS file";
+        return false;
+    }
+
+    uint32_t flags = ReadU32(data, 8);
+    image.height = static_cast<int>(ReadU32(data, 12));
+    image.width = static_cast<int>(ReadU32(data, 16));
+    uint32_t mipMapCount = ReadU32(data, 28);
+    uint32_t pixelFlags = ReadU32(data, 80);
+    uint32_t fourCC = ReadU32(data, 84);
+    uint32_t bitCount = ReadU32(data, 88);
+    uint32_t redMask = ReadU32(data, 92);
+    uint32_t alphaMask = ReadU32(data, 104);
+    uint32_t caps2 = ReadU32(data, 112);
+    if ((caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) != 0 || image.width <= 0 || image.height <= 0) {
+        error = "only 2D DDS textures are supported";
+        return false;
+    }
+    if (image.width > MAX_DIMENSION || image.height > MAX_DIMENSION) {
+        error = "DDS texture larger than " + std::to_string(MAX_DIMENSION) + " pixels";
+        return false;
+    }
+
+    size_t dataOffset = DDS_HEADER_SIZE;
+    const FormatInfo* format = nullptr;
+    bool swapRedBlue = false;
+    if ((pixelFlags & DDPF_FOURCC) != 0) {
+        if (fourCC == FourCC('D', 'X', '1', '0')) {
+            if (data.size() < DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE) {
+                error = "truncated DDS DX10 header";
+                return false;
+            }
+            if (ReadU32(data, DDS_HEADER_SIZE + 4) != DDS_DIMENSION_TEXTURE2D || ReadU32(data, DDS_HEADER_SIZE + 12) > 1) {
+                error = "only single 2D DDS textures are supported";
+                return false;
+            }
+            format = FindDxgiFormat(ReadU32(data, DDS_HEADER_SIZE));
+            dataOffset += DDS_DX10_HEADER_SIZE;
+        } else if (fourCC == FourCC('D', 'X', 'T', '1')) {
+            format = FindDxgiFormat(71);
+        } else if (fourCC == FourCC('D', 'X', 'T', '5')) {
+            format = FindDxgiFormat(77);
+        } else if (fourCC == FourCC('A', 'T', 'I', '1') || fourCC == FourCC('B', 'C', '4', 'U')) {
+            format = FindDxgiFormat(80);
+        } else if (fourCC == FourCC('A', 'T', 'I', '2') || fourCC == FourCC('B', 'C', '5', 'U')) {
+            format = FindDxgiFormat(83);
+        }
+    } else if ((pixelFlags & DDPF_RGB) != 0 && bitCount == 32 && (redMask == 0xFF || redMask == 0xFF0000)) {
+        // RGBA8 or BGRA8 (alpha mask 0 means opaque XRGB)
+        format = FindDxgiFormat(28);
+        swapRedBlue = redMask == 0xFF0000;
+    }
+    if (!format) {
+        error = "unsupported DDS pixel format";
+        return false;
+    }
+
+    image.channels = format->channels;
+    image.blockFormat = format->blockFormat;
+    image.srgb = format->srgb;
+    int levels = (flags & DDSD_MIPMAPCOUNT) != 0 ? static_cast<int>(std::min(std::max(mipMapCount, 1u), 32u)) : 1;
+    size_t totalSize = LayoutLevels(image, levels);
+    if (data.size() - dataOffset < totalSize) {
+        error = "truncated DDS data";
+        return false;
+    }
+    image.pixels.resize(totalSize);
+    std::memcpy(image.pixels.data(), data.data() + dataOffset, image.pixels.size());
+
+    if (swapRedBlue || ((pixelFlags & DDPF_RGB) != 0 && ((pixelFlags & DDPF_ALPHAPIXELS) == 0 || alphaMask == 0))) {
+        for (size_t i = 0; i < image.pixels.size(); i += 4) {
+            if (swapRedBlue) std::swap(image.pixels[i], image.pixels[i + 2]);
+            if ((pixelFlags & DDPF_ALPHAPIXELS) == 0 || alphaMask == 0) image.pixels[i + 3] = 255;
+        }
+    }
+
+    // DDS always stores the top row first
+    if (!ImageLoader::FlipVertical(image)) {
+        std::cerr << "Warning: DDS cannot be flipped in this format and loads upside down (use KTX2)" << std::endl;
+    }
+    return true;
+}
+
+std::vector<uint32_t> TextureContainer::BuildDataFormatDescriptor(const FormatInfo& format) {
+    // Khronos Basic Data Format Descriptor block
+    const uint32_t MODEL_RGBSDA = 1, MODEL_BC1A = 128, MODEL_BC3 = 130, MODEL_BC4 = 131, MODEL_BC5 = 132, MODEL_BC7 = 134;
+    const uint32_t CHANNEL_ALPHA = 15, QUALIFIER_LINEAR = 0x10;
+    const uint32_t PRIMARIES_BT709 = 1, TRANSFER_LINEAR = 1, TRANSFER_SRGB = 2;
+
+    struct Sample {
+        uint32_t bitOffset;
+        uint32_t bitLength;
+        uint32_t channel;
+        uint32_t upper;
+    };
+    Sample samples[4];
+    int sampleCount = 0;
+    uint32_t model;
+    uint32_t blockDimension = 0;
+    uint32_t bytesPlane0;
+    switch (format.blockFormat) {
+        case BlockFormat::BC1:
+            model = MODEL_BC1A;
+            samples[sampleCount++] = { 0, 64, 1, 0xFFFFFFFF };
+            break;
+        case BlockFormat::BC3:
+            model = MODEL_BC3;
+            samples[sampleCount++] = { 0, 64, CHANNEL_ALPHA, 0xFFFFFFFF };
+            samples[sampleCount++] = { 64, 64, 0, 0xFFFFFFFF };
+            break;
+        case BlockFormat::BC4:
+            model = MODEL_BC4;
+            samples[sampleCount++] = { 0, 64, 0, 0xFFFFFFFF };
+            break;
+        case BlockFormat::BC5:
+            model = MODEL_BC5;
+            samples[sampleCount++] = { 0, 64, 0, 0xFFFFFFFF };
+            samples[sampleCount++] = { 64, 64, 1, 0xFFFFFFFF };
+            break;
+        case BlockFormat::BC7:
+            model = MODEL_BC7;
+            samples[sampleCount++] = { 0, 128, 0, 0xFFFFFFFF };
+            break;
+        default:
+            model = MODEL_RGBSDA;
+            for (int channel = 0; channel < format.channels; ++channel) {
+                uint32_t id = format.channels == 4 && channel == 3 ? CHANNEL_ALPHA : static_cast<uint32_t>(channel);
+                samples[sampleCount++] = { static_cast<uint32_t>(channel) * 8, 8, id, 255 };
+            }
+            break;
+    }
+    if (format.blockFormat != BlockFormat::NONE) {
+        blockDimension = 3 | 3 << 8;   // 4x4x1x1, stored minus one
+        bytesPlane0 = static_cast<uint32_t>(Image::GetBlockBytes(format.blockFormat));
+    } else {
+        bytesPlane0 = static_cast<uint32_t>(format.channels);
+    }
+
+    uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(sampleCount);
+    std::vector<uint32_t> words = {
+        4 + blockSize,
+        0,   // Khronos vendor, basic descriptor type
+        2 | blockSize << 16,
+        model | PRIMARIES_BT709 << 8 | (format.srgb ? TRANSFER_SRGB : TRANSFER_LINEAR) << 16,
+        blockDimension,
+        bytesPlane0,
+        0,
+    };
+    for (int i = 0; i < sampleCount; ++i) {
+        const Sample& sample = samples[i];
+        uint32_t channelType = sample.channel;
+        if (format.srgb && sample.channel == CHANNEL_ALPHA) {
+            channelType |= QUALIFIER_LINEAR;
+        }
+        words.push_back(sample.bitOffset | (sample.bitLength - 1) << 16 | channelType << 24);
+        words.push_back(0);
+        words.push_back(0);
+        words.push_back(sample.upper);
+    }
+    return words;
+}
+
+bool TextureContainer::WriteKTX2(const std::string& filePath, const Image& image, std::string& error) {
+    const FormatInfo* format = FindImageFormat(image);
+    if (!format || image.levels.empty()) {
+        error = "no KTX2 format for this image";
+        return false;
+    }
+
+    std::vector<uint32_t> dfd = BuildDataFormatDescriptor(*format);
+    std::vector<unsigned char> kvd;
+    AppendKeyValue(kvd, "KTXorientation", "ru");
+    AppendKeyValue(kvd, "KTXwriter", "texcompress");
+
+    size_t levelCount = image.levels.size();
+    size_t dfdOffset = KTX2_HEADER_SIZE + levelCount * 24;
+    size_t kvdOffset = dfdOffset + dfd.size() * 4;
+    size_t dataOffset = Align(kvdOffset + kvd.size(), KTX2_LEVEL_ALIGNMENT);
+
+    // Level data is stored smallest level first
+    std::vector<size_t> levelOffsets(levelCount);
+    size_t end = dataOffset;
+    for (size_t level = levelCount; level-- > 0;) {
+        levelOffsets[level] = Align(end, KTX2_LEVEL_ALIGNMENT);
+        end = levelOffsets[level] + image.levels[level].size;
+    }
+
+    std::vector<unsigned char> data(end, 0);
+    std::memcpy(data.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    WriteU32(data, 12, format->vkFormat);
+    WriteU32(data, 16, 1);   // typeSize
+    WriteU32(data, 20, static_cast<uint32_t>(image.width));
+    WriteU32(data, 24, static_cast<uint32_t>(image.height));
+    WriteU32(data, 36, 1);   // faceCount
+    WriteU32(data, 40, static_cast<uint32_t>(levelCount));
+    WriteU32(data, 48, static_cast<uint32_t>(dfdOffset));
+    WriteU32(data, 52, static_cast<uint32_t>(dfd.size() * 4));
+    WriteU32(data, 56, static_cast<uint32_t>(kvdOffset));
+    WriteU32(data, 60, static_cast<uint32_t>(kvd.size()));
+    for (size_t level = 0; level < levelCount; ++level) {
+        const Image::Level& source = image.levels[level];
+        size_t entry = KTX2_HEADER_SIZE + level * 24;
+        WriteU64(data, entry, levelOffsets[level]);
+        WriteU64(data, entry + 8, source.size);
+        WriteU64(data, entry + 16, source.size);
+        std::memcpy(&data[levelOffsets[level]], image.pixels.data() + source.offset, source.size);
+    }
+    for (size_t i = 0; i < dfd.size(); ++i) {
+        WriteU32(data, dfdOffset + i * 4, dfd[i]);
+    }
+    std::memcpy(&data[kvdOffset], kvd.data(), kvd.size());
+
+    return WriteFile(filePath, data, error);
+}
+
+bool TextureContainer::WriteDDS(const std::string& filePath, const Image& image, std::string& error) {
+    const FormatInfo* format = FindImageFormat(image);
+    if (!format || image.levels.empty()) {
+        error = "no DDS format for this image";
+        return false;
+    }
+
+    // Always a DX10 header: it is the only way to flag sRGB and BC7
+    std::vector<unsigned char> data(DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE + image.pixels.size(), 0);
+    bool mipmapped = image.levels.size() > 1;
+    WriteU32(data, 0, DDS_MAGIC);
+    WriteU32(data, 4, 124);
+    WriteU32(data, 8, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT |
+                      (image.IsCompressed() ? DDSD_LINEARSIZE : DDSD_PITCH));
+    WriteU32(data, 12, static_cast<uint32_t>(image.height));
+    WriteU32(data, 16, static_cast<uint32_t>(image.width));
+    WriteU32(data, 20, static_cast<uint32_t>(image.IsCompressed() ? image.levels[0].size : image.GetRowBytes(0)));
+    WriteU32(data, 28, static_cast<uint32_t>(image.levels.size()));
+    WriteU32(data, 76, 32);   // DDS_PIXELFORMAT size
+    WriteU32(data, 80, DDPF_FOURCC);
+    WriteU32(data, 84, FourCC('D', 'X', '1', '0'));
+    WriteU32(data, 108, DDSCAPS_TEXTURE | (mipmapped ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0));
+    WriteU32(data, DDS_HEADER_SIZE, format->dxgiFormat);
+    WriteU32(data, DDS_HEADER_SIZE + 4, DDS_DIMENSION_TEXTURE2D);
+    WriteU32(data, DDS_HEADER_SIZE + 12, 1);   // arraySize
+    std::memcpy(&data[DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE], image.pixels.data(), image.pixels.size());
+
+    return WriteFile(filePath, data, error);
+}
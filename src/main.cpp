@@ -24,6 +24,7 @@ std::unique_ptr<Renderer> renderer;
 std::unique_ptr<Camera> camera;
 std::unique_ptr<Scene> scene;
 std::unique_ptr<Light> sunLight;
+std::shared_ptr<Landscape> landscape;
 
 // Input handling
 bool keys[1024];
@@ -61,6 +62,7 @@ int main() {
     
     // Setup scene
     SetupScene();
+    renderer->ReserveFrameData(*scene);
     
     // Main render loop
     while (!glfwWindowShouldClose(window)) {
@@ -74,6 +76,9 @@ int main() {
         // Update scene
         scene->Update(deltaTime);
         
+        // Terrain chunks follow the camera
+        landscape->UpdateChunks(camera->GetPosition(), *scene);
+        
         // Render scene
         renderer->BeginFrame();
         renderer->Render(*scene, *camera);
@@ -190,11 +195,11 @@ void SetupScene() {
     scene->SetSkybox(skybox);
     
     // Create landscape
-    auto landscape = std::make_shared<Landscape>(Landscape::TerrainType::HILLY, 
-                                                glm::vec2(1000.0f, 1000.0f), 256);
+    landscape = std::make_shared<Landscape>(Landscape::TerrainType::HILLY, 
+                                           glm::vec2(1000.0f, 1000.0f), 256);
     landscape->SetHeightScale(50.0f);
     landscape->GenerateGeometry();
-    scene->AddModel(landscape->GetModel());
+    landscape->UpdateChunks(camera->GetPosition(), *scene);
     
     // Create buildings
     auto building1 = std::make_shared<Building>(Building::BuildingType::OFFICE,
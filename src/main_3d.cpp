@@ -6,11 +6,17 @@
 #include <iostream>
 #include <memory>
 #include <chrono>
+#include <cstdlib>
+#include <string>
 
 #include "Engine/Renderer.h"
 #include "Engine/Camera.h"
 #include "Engine/Light.h"
 #include "Engine/Scene.h"
+#include "Engine/Profiler.h"
+#include "Engine/TraceRecorder.h"
+#include "Engine/TextureStreamer.h"
+#include "Engine/Atmosphere.h"
 #include "Components/Skybox.h"
 #include "Components/Building.h"
 #include "Components/SolarPanel.h"
@@ -24,6 +30,7 @@ std::unique_ptr<Renderer> renderer;
 std::unique_ptr<Camera> camera;
 std::unique_ptr<Scene> scene;
 std::shared_ptr<Light> sunLight;
+std::shared_ptr<Landscape> landscape;
 
 // Input handling
 bool keys[1024];
@@ -41,6 +48,16 @@ float mouseSensitivity = 0.1f;
 std::shared_ptr<SolarPanel> solarArray;
 float simulationTime = 0.0f;
 
+// Trace capture (F3 or --trace <frames>)
+int traceFrames = 300;
+std::string traceOutputPath = "trace.json";
+
+// Rebuild shaders and textures edited on disk (--no-hot-reload disables)
+bool hotReload = true;
+
+// Stream the terrain from a tile pyramid instead of generating it (--terrain <file.htp>)
+std::string terrainTilesPath;
+
 // Function declarations
 void InitializeGLFW();
 void InitializeOpenGL();
@@ -55,10 +72,30 @@ void UpdateSolarPanelSimulation();
 void DisplayPerformanceInfo();
 void Cleanup();
 
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "Real-Time 3D Solar Panel Simulation with OpenGL" << std::endl;
     std::cout << "===============================================" << std::endl;
 
+    bool traceAtStartup = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) {
+            traceFrames = std::atoi(argv[++i]);
+            traceAtStartup = true;
+        } else if (arg == "--trace-output" && i + 1 < argc) {
+            traceOutputPath = argv[++i];
+        } else if (arg == "--no-hot-reload") {
+            hotReload = false;
+        } else if (arg == "--terrain" && i + 1 < argc) {
+            terrainTilesPath = argv[++i];
+        }
+    }
+    TraceRecorder::Instance().SetThreadName("Main");
+    if (traceAtStartup) {
+        // Started before setup so asset loads land in the first frame
+        TraceRecorder::Instance().StartCapture(traceFrames, traceOutputPath);
+    }
+
     // Initialize GLFW
     InitializeGLFW();
     
@@ -67,6 +104,7 @@ int main() {
     
     // Setup scene
     SetupScene();
+    renderer->ReserveFrameData(*scene);
     
     std::cout << "Solar Panel Simulation Started!" << std::endl;
     std::cout << "Controls:" << std::endl;
@@ -75,11 +113,14 @@ int main() {
     std::cout << "  Scroll - Zoom in/out" << std::endl;
     std::cout << "  F1 - Toggle performance overlay" << std::endl;
     std::cout << "  F2 - Toggle wireframe mode" << std::endl;
+    std::cout << "  F3 - Capture a " << traceFrames << "-frame trace to " << traceOutputPath << std::endl;
     std::cout << "  ESC - Exit" << std::endl;
     std::cout << std::endl;
     
     // Main render loop
     while (!glfwWindowShouldClose(window)) {
+        Profiler::Instance().BeginFrame();
+        
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
@@ -87,11 +128,26 @@ int main() {
         // Process input
         ProcessInput();
         
+        // Reload shaders and assets edited on disk
+        FileUtils::UpdateFileWatchers();
+        
         // Update solar panel simulation
-        UpdateSolarPanelSimulation();
+        {
+            PROFILE_CPU("Simulation");
+            UpdateSolarPanelSimulation();
+        }
         
         // Update scene
-        scene->Update(deltaTime);
+        {
+            PROFILE_CPU("Scene update");
+            scene->Update(deltaTime);
+        }
+        
+        // Terrain chunks follow the camera
+        {
+            PROFILE_CPU("Terrain LOD");
+            landscape->UpdateChunks(camera->GetPosition(), *scene);
+        }
         
         // Render scene
         renderer->BeginFrame();
@@ -104,6 +160,9 @@ int main() {
         // Swap buffers and poll events
         glfwSwapBuffers(window);
         glfwPollEvents();
+        
+        Profiler::Instance().EndFrame();
+        TraceRecorder::Instance().FrameBoundary();
     }
     
     // Cleanup
@@ -170,6 +229,12 @@ void InitializeOpenGL() {
     glfwGetFramebufferSize(window, &width, &height);
     renderer = std::make_unique<Renderer>(width, height);
     renderer->Initialize();
+    if (hotReload) {
+        renderer->EnableHotReload();
+    }
+    renderer->SetShadowCascades(4);
+    renderer->SetShadowMapResolution(2048);
+    renderer->SetShadowDistance(500.0f);
 }
 
 void SetupScene() {
@@ -203,11 +268,14 @@ void SetupScene() {
     scene->SetSkybox(skybox);
     
     // Create landscape
-    auto landscape = std::make_shared<Landscape>(Landscape::TerrainType::HILLY, 
-                                                glm::vec2(1000.0f, 1000.0f), 256);
+    landscape = std::make_shared<Landscape>(Landscape::TerrainType::HILLY, 
+                                            glm::vec2(1000.0f, 1000.0f), 256);
     landscape->SetHeightScale(50.0f);
     landscape->GenerateGeometry();
-    scene->AddModel(landscape->GetModel());
+    if (!terrainTilesPath.empty() && !landscape->OpenTiles(terrainTilesPath)) {
+        std::cerr << "Keeping the generated terrain" << std::endl;
+    }
+    landscape->UpdateChunks(camera->GetPosition(), *scene);
     
     // Create buildings
     auto building1 = std::make_shared<Building>(Building::BuildingType::OFFICE,
@@ -294,6 +362,16 @@ void ProcessInput() {
     if (!keys[GLFW_KEY_F2]) {
         f2Pressed = false;
     }
+    
+    // Trace capture
+    static bool f3Pressed = false;
+    if (keys[GLFW_KEY_F3] && !f3Pressed) {
+        TraceRecorder::Instance().StartCapture(traceFrames, traceOutputPath);
+        f3Pressed = true;
+    }
+    if (!keys[GLFW_KEY_F3]) {
+        f3Pressed = false;
+    }
 }
 
 void MouseCallback(GLFWwindow* window, double xpos, double ypos) {
@@ -350,12 +428,13 @@ void UpdateSolarPanelSimulation() {
     
     // Update simulation time
     simulationTime += deltaTime;
+    float timeOfDay = fmod(simulationTime / 86400.0f, 1.0f); // 24-hour cycle
     
     // Update solar panel
+    solarArray->SetTimeOfDay(timeOfDay);
     solarArray->Update(deltaTime);
     
     // Animate sun position based on time
-    float timeOfDay = fmod(simulationTime / 86400.0f, 1.0f); // 24-hour cycle
     float sunAngle = timeOfDay * 2.0f * glm::pi<float>();
     
     // Update sun light position
@@ -381,21 +460,25 @@ void DisplayPerformanceInfo() {
     performanceTimer += deltaTime;
     
     if (performanceTimer >= 1.0f) {
-        std::cout << "\rFPS: " << renderer->GetFPS() 
-                  << " | Draw Calls: " << renderer->GetDrawCalls();
+        std::cout << Profiler::Instance().FormatReport();
         
         if (solarArray) {
-            std::cout << " | Solar Power: " << solarArray->GetCurrentPower() << "W"
+            std::cout << "  Solar Power: " << solarArray->GetCurrentPower() << "W"
                       << " | Energy: " << solarArray->GetEnergyGenerated() << "kWh"
-                      << " | Temp: " << solarArray->GetTemperature() << "°C";
+                      << " | Temp: " << solarArray->GetTemperature() << "°C" << std::endl;
         }
         
-        std::cout << "    " << std::flush;
+        std::cout << std::flush;
         performanceTimer = 0.0f;
     }
 }
 
 void Cleanup() {
+    FileUtils::StopFileWatchers();
+    TraceRecorder::Instance().StopCapture();
+    Profiler::Instance().Shutdown();
+    TextureStreamer::Instance().Shutdown();
+    Atmosphere::Instance().Shutdown();
     glfwTerminate();
     std::cout << std::endl << "Solar Panel Simulation ended." << std::endl;
 }
@@ -0,0 +1,468 @@
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+#include "Engine/HeadlessContext.h"
+#include "Engine/RenderTarget.h"
+#include "Engine/Renderer.h"
+#include "Engine/Profiler.h"
+#include "Engine/TraceRecorder.h"
+#include "Engine/Camera.h"
+#include "Engine/Light.h"
+#include "Engine/Scene.h"
+#include "Engine/TextureStreamer.h"
+#include "Engine/Atmosphere.h"
+#include "Components/Skybox.h"
+#include "Components/Building.h"
+#include "Components/SolarPanel.h"
+#include "Components/Landscape.h"
+
+// Headless renderer: loads a scene file, flies a camera along a path file and
+// writes each frame as a PPM image. Needs no window system, so it runs on
+// display-less servers (EGL surfaceless, e.g. Mesa llvmpipe).
+//
+// Scene file, one directive per line ('#' starts a comment):
+//   camera <fov> <near> <far>
+//   ambient <r> <g> <b>
+//   sun <r> <g> <b> <intensity>
+//   time <timeOfDay 0-1>
+//   skybox clear_day|cloudy_day|sunset|night|stormy
+//   landscape flat|hilly|mountainous|coastal|urban <sizeX> <sizeZ> <resolution> <heightScale> [seed]
+//   terrain <pyramid.htp> [memoryBudgetMB]
+//   pad <x> <z> <sizeX> <sizeZ> <height> [blend]   (grades the last landscape)
+//   building office|residential|industrial|commercial|skyscraper <x> <y> <z> <sx> <sy> <sz> <floors>
+//   panels <x> <y> <z> <rows> <cols> <spacing> <tilt> <azimuth>
+//
+// Camera path file, one keyframe per line, sorted by time:
+//   <seconds> <px> <py> <pz> <tx> <ty> <tz> [timeOfDay]
+
+struct HeadlessOptions {
+    std::string scenePath;
+    std::string cameraPath;
+    std::string outputDirectory = "frames";
+    int width = 1920;
+    int height = 1080;
+    float fps = 30.0f;
+    int frameLimit = -1;
+    bool writeFrames = true;
+    int traceFrames = 0;
+    std::string tracePath = "trace.json";
+};
+
+struct CameraKeyframe {
+    float time;
+    glm::vec3 position;
+    glm::vec3 target;
+    float timeOfDay;
+};
+
+struct HeadlessScene {
+    std::unique_ptr<Scene> scene;
+    std::shared_ptr<Light> sun;
+    std::vector<std::shared_ptr<SolarPanel>> panels;
+    std::vector<std::shared_ptr<Building>> buildings;
+    std::vector<std::shared_ptr<Landscape>> landscapes;
+    float fov = 45.0f;
+    float nearPlane = 0.1f;
+    float farPlane = 1000.0f;
+    float timeOfDay = 0.5f;
+};
+
+static void PrintUsage() {
+    std::cout << "Usage: RealTime3DSimulationHeadless --scene <file> --path <file> [options]" << std::endl
+              << "  --width <px>        Frame width (default 1920)" << std::endl
+              << "  --height <px>       Frame height (default 1080)" << std::endl
+              << "  --fps <rate>        Frames per second of path time (default 30)" << std::endl
+              << "  --frames <count>    Stop after this many frames" << std::endl
+              << "  --output <dir>      Directory for frame_NNNNN.ppm (default frames)" << std::endl
+              << "  --no-write          Render without writing images (throughput only)" << std::endl
+              << "  --trace <frames>    Capture a Chrome trace of the first N frames" << std::endl
+              << "  --trace-output <f>  Trace file (default trace.json)" << std::endl;
+}
+
+static bool ParseArguments(int argc, char** argv, HeadlessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--scene" && hasValue) {
+            options.scenePath = argv[++i];
+        } else if (arg == "--path" && hasValue) {
+            options.cameraPath = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            options.outputDirectory = argv[++i];
+        } else if (arg == "--width" && hasValue) {
+            options.width = std::atoi(argv[++i]);
+        } else if (arg == "--height" && hasValue) {
+            options.height = std::atoi(argv[++i]);
+        } else if (arg == "--fps" && hasValue) {
+            options.fps = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--frames" && hasValue) {
+            options.frameLimit = std::atoi(argv[++i]);
+        } else if (arg == "--no-write") {
+            options.writeFrames = false;
+        } else if (arg == "--trace" && hasValue) {
+            options.traceFrames = std::atoi(argv[++i]);
+        } else if (arg == "--trace-output" && hasValue) {
+            options.tracePath = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    return !options.scenePath.empty() && !options.cameraPath.empty() &&
+           options.width > 0 && options.height > 0 && options.fps > 0.0f;
+}
+
+template <typename Enum>
+static bool ParseEnum(const std::string& name, const std::vector<std::pair<std::string, Enum>>& values, Enum& out) {
+    for (const auto& value : values) {
+        if (value.first == name) {
+            out = value.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool LoadScene(const std::string& filePath, HeadlessScene& result) {
+    std::ifstream file(filePath);
+    if (!file) {
+        std::cerr << "Failed to open scene file " << filePath << std::endl;
+        return false;
+    }
+
+    result.scene = std::make_unique<Scene>();
+    result.sun = Light::CreateDirectionalLight(glm::vec3(-0.5f, -1.0f, -0.5f), glm::vec3(1.0f, 0.95f, 0.8f));
+    result.scene->AddLight(result.sun);
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream stream(line);
+        std::string directive;
+        if (!(stream >> directive)) {
+            continue;
+        }
+
+        bool ok = true;
+        if (directive == "camera") {
+            ok = static_cast<bool>(stream >> result.fov >> result.nearPlane >> result.farPlane);
+        } else if (directive == "ambient") {
+            glm::vec3 ambient;
+            ok = static_cast<bool>(stream >> ambient.r >> ambient.g >> ambient.b);
+            if (ok) result.scene->SetAmbientLight(ambient);
+        } else if (directive == "sun") {
+            glm::vec3 color;
+            float intensity;
+            ok = static_cast<bool>(stream >> color.r >> color.g >> color.b >> intensity);
+            if (ok) {
+                result.sun->SetColor(color);
+                result.sun->SetIntensity(intensity);
+            }
+        } else if (directive == "time") {
+            ok = static_cast<bool>(stream >> result.timeOfDay);
+        } else if (directive == "skybox") {
+            std::string name;
+            Skybox::SkyType type;
+            ok = stream >> name && ParseEnum<Skybox::SkyType>(name, {
+                { "clear_day", Skybox::SkyType::CLEAR_DAY }, { "cloudy_day", Skybox::SkyType::CLOUDY_DAY },
+                { "sunset", Skybox::SkyType::SUNSET }, { "night", Skybox::SkyType::NIGHT },
+                { "stormy", Skybox::SkyType::STORMY } }, type);
+            if (ok) result.scene->SetSkybox(std::make_shared<Skybox>(type));
+        } else if (directive == "landscape") {
+            std::string name;
+            Landscape::TerrainType type;
+            glm::vec2 size;
+            int resolution;
+            float heightScale;
+            ok = stream >> name >> size.x >> size.y >> resolution >> heightScale &&
+                 ParseEnum<Landscape::TerrainType>(name, {
+                { "flat", Landscape::TerrainType::FLAT }, { "hilly", Landscape::TerrainType::HILLY },
+                { "mountainous", Landscape::TerrainType::MOUNTAINOUS }, { "coastal", Landscape::TerrainType::COASTAL },
+                { "urban", Landscape::TerrainType::URBAN } }, type);
+            uint32_t seed = Landscape::DEFAULT_SEED;
+            if (ok && !(stream >> seed)) {
+                seed = Landscape::DEFAULT_SEED;
+            }
+            if (ok) {
+                auto landscape = std::make_shared<Landscape>(type, size, resolution, seed);
+                landscape->SetHeightScale(heightScale);
+                landscape->GenerateGeometry();
+                result.landscapes.push_back(landscape);
+            }
+        } else if (directive == "terrain") {
+            std::string path;
+            int budgetMegabytes = 0;
+            ok = static_cast<bool>(stream >> path);
+            if (ok && stream >> budgetMegabytes && budgetMegabytes <= 0) {
+                ok = false;
+            }
+            if (ok) {
+                auto landscape = std::make_shared<Landscape>();
+                if (budgetMegabytes > 0) {
+                    landscape->SetTileMemoryBudget(static_cast<size_t>(budgetMegabytes) << 20);
+                }
+                ok = landscape->OpenTiles(path);
+                if (ok) {
+                    result.landscapes.push_back(landscape);
+                }
+            }
+        } else if (directive == "pad") {
+            glm::vec3 center;
+            glm::vec2 extent;
+            float blend = 0.0f;
+            ok = stream >> center.x >> center.z >> extent.x >> extent.y >> center.y && !result.landscapes.empty();
+            if (ok && !(stream >> blend)) {
+                blend = 0.0f;
+            }
+            if (ok) {
+                result.landscapes.back()->FlattenRegion(center, extent, blend);
+            }
+        } else if (directive == "building") {
+            std::string name;
+            Building::BuildingType type;
+            glm::vec3 position, size;
+            int floors;
+            ok = stream >> name >> position.x >> position.y >> position.z >> size.x >> size.y >> size.z >> floors &&
+                 ParseEnum<Building::BuildingType>(name, {
+                { "office", Building::BuildingType::OFFICE }, { "residential", Building::BuildingType::RESIDENTIAL },
+                { "industrial", Building::BuildingType::INDUSTRIAL }, { "commercial", Building::BuildingType::COMMERCIAL },
+                { "skyscraper", Building::BuildingType::SKYSCRAPER } }, type);
+            if (ok) {
+                auto building = std::make_shared<Building>(type, position, size);
+                building->SetHeight(size.y);
+                building->SetFloorCount(floors);
+                building->GenerateGeometry();
+                result.scene->AddModel(building->GetModel());
+                result.buildings.push_back(building);
+            }
+        } else if (directive == "panels") {
+            glm::vec3 position;
+            int rows, cols;
+            float spacing, tilt, azimuth;
+            ok = static_cast<bool>(stream >> position.x >> position.y >> position.z >> rows >> cols >> spacing >> tilt >> azimuth);
+            if (ok) {
+                auto panels = std::make_shared<SolarPanel>(SolarPanel::PanelType::MONOCRYSTALLINE, position, glm::vec2(2.0f, 1.0f));
+                panels->SetTilt(tilt);
+                panels->SetAzimuth(azimuth);
+                panels->CreateArray(rows, cols, spacing);
+                result.scene->AddModel(panels->GetModel());
+                result.panels.push_back(panels);
+            }
+        } else {
+            std::cerr << filePath << ":" << lineNumber << ": unknown directive '" << directive << "'" << std::endl;
+            return false;
+        }
+
+        if (!ok) {
+            std::cerr << filePath << ":" << lineNumber << ": malformed '" << directive << "' line" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool LoadCameraPath(const std::string& filePath, float defaultTimeOfDay, std::vector<CameraKeyframe>& keyframes) {
+    std::ifstream file(filePath);
+    if (!file) {
+        std::cerr << "Failed to open camera path " << filePath << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream stream(line);
+        CameraKeyframe key;
+        if (!(stream >> key.time >> key.position.x >> key.position.y >> key.position.z
+                     >> key.target.x >> key.target.y >> key.target.z)) {
+            continue;
+        }
+        if (!(stream >> key.timeOfDay)) {
+            key.timeOfDay = keyframes.empty() ? defaultTimeOfDay : keyframes.back().timeOfDay;
+        }
+        keyframes.push_back(key);
+    }
+
+    if (keyframes.empty()) {
+        std::cerr << "Camera path " << filePath << " has no keyframes" << std::endl;
+        return false;
+    }
+    std::stable_sort(keyframes.begin(), keyframes.end(),
+                     [](const CameraKeyframe& a, const CameraKeyframe& b) { return a.time < b.time; });
+    return true;
+}
+
+static CameraKeyframe SampleCameraPath(const std::vector<CameraKeyframe>& keyframes, float time) {
+    if (time <= keyframes.front().time) return keyframes.front();
+    if (time >= keyframes.back().time) return keyframes.back();
+
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+                                 [](float t, const CameraKeyframe& key) { return t < key.time; });
+    const CameraKeyframe& b = *next;
+    const CameraKeyframe& a = *(next - 1);
+    float t = (time - a.time) / std::max(b.time - a.time, 1e-6f);
+
+    CameraKeyframe result;
+    result.time = time;
+    result.position = glm::mix(a.position, b.position, t);
+    result.target = glm::mix(a.target, b.target, t);
+    result.timeOfDay = a.timeOfDay + (b.timeOfDay - a.timeOfDay) * t;
+    return result;
+}
+
+static void ApplyTimeOfDay(HeadlessScene& site, float timeOfDay) {
+    // Same sun path as the interactive application
+    float sunAngle = timeOfDay * 2.0f * glm::pi<float>();
+    glm::vec3 sunPosition(200.0f * std::cos(sunAngle), 100.0f * std::sin(sunAngle), 200.0f * std::sin(sunAngle));
+    site.sun->SetPosition(sunPosition);
+    site.sun->SetDirection(glm::normalize(-sunPosition));
+
+    for (auto& panels : site.panels) {
+        panels->SetTimeOfDay(timeOfDay);
+    }
+    if (site.scene->GetSkybox()) {
+        site.scene->GetSkybox()->SetTimeOfDay(timeOfDay);
+    }
+}
+
+int main(int argc, char** argv) {
+    HeadlessOptions options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    TraceRecorder::Instance().SetThreadName("Main");
+    if (options.traceFrames > 0) {
+        // Includes context creation and scene loading in the first frame
+        TraceRecorder::Instance().StartCapture(options.traceFrames, options.tracePath);
+    }
+
+    HeadlessContext context;
+    if (!context.Initialize()) {
+        return 1;
+    }
+
+    auto renderer = std::make_unique<Renderer>(options.width, options.height);
+    renderer->Initialize();
+    std::cout << "Headless renderer: " << context.GetDescription() << ", "
+              << glGetString(GL_RENDERER) << ", " << options.width << "x" << options.height << std::endl;
+
+    RenderTarget target;
+    if (!target.Create(options.width, options.height)) {
+        return 1;
+    }
+    renderer->SetRenderTarget(target.GetFramebuffer());
+    renderer->SetViewport(options.width, options.height);
+
+    HeadlessScene site;
+    std::vector<CameraKeyframe> keyframes;
+    if (!LoadScene(options.scenePath, site) || !LoadCameraPath(options.cameraPath, site.timeOfDay, keyframes)) {
+        return 1;
+    }
+    // Frames must be reproducible, so no frame may sample a placeholder
+    TextureStreamer::Instance().Flush();
+    Atmosphere::Instance().Wait();
+    renderer->ReserveFrameData(*site.scene);
+
+    if (options.writeFrames) {
+        std::error_code error;
+        std::filesystem::create_directories(options.outputDirectory, error);
+        if (error) {
+            std::cerr << "Failed to create " << options.outputDirectory << ": " << error.message() << std::endl;
+            return 1;
+        }
+    }
+
+    Camera camera(keyframes.front().position, keyframes.front().target, site.fov);
+    camera.SetNearPlane(site.nearPlane);
+    camera.SetFarPlane(site.farPlane);
+    camera.SetAspectRatio(static_cast<float>(options.width) / options.height);
+
+    float duration = keyframes.back().time - keyframes.front().time;
+    int frameCount = static_cast<int>(std::floor(duration * options.fps)) + 1;
+    if (options.frameLimit >= 0) {
+        frameCount = std::min(frameCount, options.frameLimit);
+    }
+
+    const float frameTime = 1.0f / options.fps;
+    double renderSeconds = 0.0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+        Profiler::Instance().BeginFrame();
+
+        CameraKeyframe key = SampleCameraPath(keyframes, keyframes.front().time + frame * frameTime);
+        camera.SetPosition(key.position);
+        camera.SetTarget(key.target);
+        ApplyTimeOfDay(site, key.timeOfDay);
+
+        {
+            PROFILE_CPU("Scene update");
+            for (auto& panels : site.panels) {
+                panels->Update(frameTime);
+            }
+            site.scene->Update(frameTime);
+        }
+        {
+            // Refine fully every frame so output does not depend on the build budget
+            PROFILE_CPU("Terrain LOD");
+            for (auto& landscape : site.landscapes) {
+                while (!landscape->UpdateChunks(camera.GetPosition(), *site.scene)) {
+                    landscape->WaitForTiles();
+                }
+            }
+        }
+
+        auto renderStart = std::chrono::steady_clock::now();
+        renderer->BeginFrame();
+        renderer->Render(*site.scene, camera);
+        renderer->EndFrame();
+        glFinish();
+        renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+
+        if (options.writeFrames) {
+            std::ostringstream name;
+            name << options.outputDirectory << "/frame_" << std::setw(5) << std::setfill('0') << frame << ".ppm";
+            if (!target.WritePPM(name.str())) {
+                return 1;
+            }
+        }
+
+        Profiler::Instance().EndFrame();
+        TraceRecorder::Instance().FrameBoundary();
+    }
+    TraceRecorder::Instance().StopCapture();
+
+    double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Rendered " << frameCount << " frames in " << totalSeconds << " s: "
+              << (totalSeconds > 0.0 ? frameCount / totalSeconds : 0.0) << " FPS overall, "
+              << (renderSeconds > 0.0 ? frameCount / renderSeconds : 0.0) << " FPS render only" << std::endl;
+    std::cout << Profiler::Instance().FormatReport();
+
+    Profiler::Instance().Shutdown();
+    TextureStreamer::Instance().Shutdown();
+    Atmosphere::Instance().Shutdown();
+    // Static meshes live in the renderer's geometry arena; free them first
+    site = HeadlessScene();
+    renderer.reset();
+    target.Destroy();
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Utils/HeightField.h"
+#include "Utils/HeightFieldFile.h"
+#include "Utils/TerrainPyramid.h"
+
+// Offline terrain tiler: converts a .hfld height field into the tiled
+// pyramid Landscape::OpenTiles streams from. float32 sources are memory
+// mapped, so the height field does not need to fit in memory.
+//
+// Usage: terraintiles [options] <input.hfld> <output.htp>
+
+namespace {
+    struct Options {
+        std::string inputPath;
+        std::string outputPath;
+        float sizeX = 0.0f;
+        float sizeZ = 0.0f;
+        float heightScale = 0.0f;
+        float heightOffset = 0.0f;
+        bool hasHeightOffset = false;
+    };
+
+    void PrintUsage() {
+        std::cout << "Usage: terraintiles [options] <input.hfld> <output.htp>" << std::endl
+                  << "  --size <x> <z>        Terrain size in world units (default: from the input)" << std::endl
+                  << "  --height-scale <s>    World height of a sample value of 1 (default: from the input)" << std::endl
+                  << "  --height-offset <o>   World height of a sample value of 0 (default: from the input)" << std::endl;
+    }
+
+    bool ParseArguments(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--size" && i + 2 < argc) {
+                options.sizeX = static_cast<float>(std::atof(argv[++i]));
+                options.sizeZ = static_cast<float>(std::atof(argv[++i]));
+            } else if (arg == "--height-scale" && i + 1 < argc) {
+                options.heightScale = static_cast<float>(std::atof(argv[++i]));
+            } else if (arg == "--height-offset" && i + 1 < argc) {
+                options.heightOffset = static_cast<float>(std::atof(argv[++i]));
+                options.hasHeightOffset = true;
+            } else if (!arg.empty() && arg[0] == '-') {
+                std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+                return false;
+            } else if (options.inputPath.empty()) {
+                options.inputPath = arg;
+            } else if (options.outputPath.empty()) {
+                options.outputPath = arg;
+            } else {
+                std::cerr << "Unexpected argument: " << arg << std::endl;
+                return false;
+            }
+        }
+        return !options.inputPath.empty() && !options.outputPath.empty();
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    HeightField field;
+    HeightFieldFile::Metadata metadata;
+    std::vector<glm::vec3> normals;
+    if (!HeightFieldFile::Read(options.inputPath, field, metadata, normals)) {
+        std::cerr << "Failed to read " << options.inputPath << std::endl;
+        return 1;
+    }
+    // Tiles carry their own apron for normals
+    normals.clear();
+    normals.shrink_to_fit();
+
+    if (options.sizeX > 0.0f && options.sizeZ > 0.0f) {
+        metadata.size = glm::vec2(options.sizeX, options.sizeZ);
+    }
+    if (options.heightScale != 0.0f) {
+        metadata.heightScale = options.heightScale;
+    }
+    if (options.hasHeightOffset) {
+        metadata.heightOffset = options.heightOffset;
+    }
+    metadata.sourceKey = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!TerrainPyramid::Write(options.outputPath, field, metadata, TerrainPyramid::PATCH_SIZE)) {
+        return 1;
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    TerrainPyramid pyramid;
+    if (!pyramid.Open(options.outputPath)) {
+        return 1;
+    }
+    std::cout << options.outputPath << ": " << field.GetWidth() << "x" << field.GetHeight() << " samples, "
+              << pyramid.GetRootLevel() + 1 << " levels, " << pyramid.GetNodeCount(0) * pyramid.GetNodeCount(0)
+              << " finest tiles, written in " << elapsed.count() << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "Utils/BlockCompressor.h"
+#include "Utils/ImageLoader.h"
+#include "Utils/TextureContainer.h"
+
+// Offline texture compressor: converts PNG/JPEG/TGA/PPM sources into KTX2
+// or DDS containers with a full mip chain, block-compressed for the GPU.
+//
+// Usage: texcompress [options] <input> <output.ktx2|output.dds>
+
+namespace {
+    struct Options {
+        std::string inputPath;
+        std::string outputPath;
+        std::string format = "auto";
+        bool normalMap = false;
+        bool linear = false;
+        bool mipmaps = true;
+    };
+
+    void PrintUsage() {
+        std::cout << "Usage: texcompress [options] <input> <output.ktx2|output.dds>" << std::endl
+                  << "  --format <f>    bc1, bc3, bc4, bc5, bc7 or rgba (default: bc7 for color," << std::endl
+                  << "                  bc4 for single-channel sources, bc5 with --normal)" << std::endl
+                  << "  --normal        Normal map: X/Y in BC5, Z is rebuilt in the shader" << std::endl
+                  << "  --linear        Non-color data (no sRGB decode when sampled)" << std::endl
+                  << "  --no-mips       Store only the full-size level" << std::endl;
+    }
+
+    bool ParseArguments(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--format" && i + 1 < argc) {
+                options.format = argv[++i];
+            } else if (arg == "--normal") {
+                options.normalMap = true;
+            } else if (arg == "--linear") {
+                options.linear = true;
+            } else if (arg == "--no-mips") {
+                options.mipmaps = false;
+            } else if (!arg.empty() && arg[0] == '-') {
+                std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+                return false;
+            } else if (options.inputPath.empty()) {
+                options.inputPath = arg;
+            } else if (options.outputPath.empty()) {
+                options.outputPath = arg;
+            } else {
+                std::cerr << "Unexpected argument: " << arg << std::endl;
+                return false;
+            }
+        }
+        return !options.inputPath.empty() && !options.outputPath.empty();
+    }
+
+    bool HasExtension(const std::string& path, const std::string& extension) {
+        return path.size() > extension.size() &&
+               path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    }
+
+    bool ParseFormat(const Options& options, int channels, BlockFormat& format) {
+        std::string name = options.format;
+        if (name == "auto") {
+            name = options.normalMap ? "bc5" : channels == 1 ? "bc4" : "bc7";
+        }
+        if (name == "bc1") format = BlockFormat::BC1;
+        else if (name == "bc3") format = BlockFormat::BC3;
+        else if (name == "bc4") format = BlockFormat::BC4;
+        else if (name == "bc5") format = BlockFormat::BC5;
+        else if (name == "bc7") format = BlockFormat::BC7;
+        else if (name == "rgba") format = BlockFormat::NONE;
+        else return false;
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+    bool dds = HasExtension(options.outputPath, ".dds");
+    if (!dds && !HasExtension(options.outputPath, ".ktx2")) {
+        std::cerr << "Output must be a .ktx2 or .dds file" << std::endl;
+        return 1;
+    }
+
+    Image source;
+    std::string error;
+    if (!ImageLoader::Load(options.inputPath, source, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    if (source.IsCompressed()) {
+        std::cerr << options.inputPath << " is already block-compressed" << std::endl;
+        return 1;
+    }
+
+    BlockFormat format;
+    if (!ParseFormat(options, source.channels, format)) {
+        std::cerr << "Unknown format: " << options.format << std::endl;
+        return 1;
+    }
+
+    // DDS has no orientation flag and readers expect the top row first;
+    // flipping before encoding keeps BC7 correct too
+    if (dds) {
+        ImageLoader::FlipVertical(source);
+    }
+    source.srgb = !options.linear && !options.normalMap && source.channels == 4;
+    if (options.mipmaps) {
+        ImageLoader::GenerateMipChain(source);
+    }
+
+    Image output;
+    if (format == BlockFormat::NONE) {
+        output = source;
+    } else if (!BlockCompressor::Compress(source, format, output, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    bool written = dds ? TextureContainer::WriteDDS(options.outputPath, output, error)
+                       : TextureContainer::WriteKTX2(options.outputPath, output, error);
+    if (!written) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    std::cout << options.inputPath << ": " << source.width << "x" << source.height << ", "
+              << output.levels.size() << " levels, " << source.pixels.size() / 1024 << " KB -> "
+              << output.pixels.size() / 1024 << " KB" << std::endl;
+    return 0;
+}